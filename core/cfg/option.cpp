@@ -25,6 +25,11 @@ namespace config {
 // Dynarec
 
 Option<bool> DynarecEnabled("Dynarec.Enabled", true);
+Option<bool> CachedInterpreter("Dynarec.CachedInterpreter", false);
+Option<bool> DynarecPinRegisters("Dynarec.PinRegisters", false);
+Option<bool> DynarecAccurateCache("Dynarec.AccurateCache", false);
+Option<int> DynarecCodeCacheSize("Dynarec.CodeCacheSize", 16);
+Option<bool> DynarecFastVectorOps("Dynarec.FastVectorOps", false);
 Option<int> Sh4Clock("Sh4Clock", 200);
 
 // General
@@ -103,10 +108,15 @@ Option<int64_t> PixelBufferSize("rend.PixelBufferSize", 512_MB);
 Option<int> AnisotropicFiltering("rend.AnisotropicFiltering", 1);
 Option<int> TextureFiltering("rend.TextureFiltering", 0); // Default
 Option<bool> ThreadedRendering("rend.ThreadedRendering", true);
+Option<int> RenderQueueDepth("rend.RenderQueueDepth", 2);
+Option<int> RenderQueuePolicy("rend.RenderQueuePolicy", 0);
+Option<bool> CacheTALists("rend.CacheTALists", true);
+Option<bool> DeferredElan("pvr.DeferredElan", false);
 Option<bool> DupeFrames("rend.DupeFrames", false);
 Option<int> PerPixelLayers("rend.PerPixelLayers", 32);
 Option<bool> NativeDepthInterpolation("rend.NativeDepthInterpolation", false);
 Option<bool> EmulateFramebuffer("rend.EmulateFramebuffer", false);
+Option<bool> AsyncFramebufferReadback("rend.AsyncFramebufferReadback", false);
 Option<bool> FixUpscaleBleedingEdge("rend.FixUpscaleBleedingEdge", true);
 Option<bool> CustomGpuDriver("rend.CustomGpuDriver", false);
 #ifdef VIDEO_ROUTING
@@ -125,6 +135,8 @@ Option<bool> GDBWaitForConnection("Debug.GDBWaitForConnection");
 Option<bool> UseReios("UseReios");
 Option<bool> FastGDRomLoad("FastGDRomLoad", false);
 Option<bool> RamMod32MB("Dreamcast.RamMod32MB", false);
+Option<bool, false> HugePages("HugePages", false);
+Option<bool, false> PrefaultMemory("PrefaultMemory", false);
 
 Option<bool> OpenGlChecks("OpenGlChecks", false, "validate");
 
@@ -356,6 +356,11 @@ using OptionString = Option<std::string>;
 // Dynarec
 
 extern Option<bool> DynarecEnabled;
+extern Option<bool> CachedInterpreter;
+extern Option<bool> DynarecPinRegisters;
+extern Option<bool> DynarecAccurateCache;
+extern Option<int> DynarecCodeCacheSize;
+extern Option<bool> DynarecFastVectorOps;
 #ifndef LIBRETRO
 extern Option<int> Sh4Clock;
 #endif
@@ -470,9 +475,14 @@ extern Option<int64_t> PixelBufferSize;
 extern Option<int> AnisotropicFiltering;
 extern Option<int> TextureFiltering; // 0: default, 1: force nearest, 2: force linear
 extern Option<bool> ThreadedRendering;
+extern Option<int> RenderQueueDepth;	// max number of frames queued for the render thread (1-3)
+extern Option<int> RenderQueuePolicy;	// 0: lowest latency, 1: max throughput, 2: adaptive
+extern Option<bool> CacheTALists;
+extern Option<bool> DeferredElan;		// process Naomi 2 ELAN commands on a worker thread
 extern Option<bool> DupeFrames;
 extern Option<bool> NativeDepthInterpolation;
 extern Option<bool> EmulateFramebuffer;
+extern Option<bool> AsyncFramebufferReadback;	// write the emulated framebuffer to vram one frame late
 extern Option<bool> FixUpscaleBleedingEdge;
 extern Option<bool> CustomGpuDriver;
 #ifdef VIDEO_ROUTING
@@ -491,6 +501,8 @@ extern Option<bool> GDBWaitForConnection;
 extern Option<bool> UseReios;
 extern Option<bool> FastGDRomLoad;
 extern Option<bool> RamMod32MB;
+extern Option<bool, false> HugePages;		// back guest memory and code caches with huge pages if possible
+extern Option<bool, false> PrefaultMemory;	// fault guest memory and code caches in when they're mapped
 
 extern Option<bool> OpenGlChecks;
 
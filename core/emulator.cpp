@@ -432,6 +432,13 @@ void Emulator::init()
 	}
 	else
 #endif
+	if (config::CachedInterpreter)
+	{
+		Get_Sh4CachedInterpreter(&sh4_cpu);
+		sh4_cpu.Init();
+		INFO_LOG(INTERPRETER, "Using Cached Interpreter");
+	}
+	else
 	{
 		Get_Sh4Interpreter(&sh4_cpu);
 		sh4_cpu.Init();
@@ -868,6 +875,12 @@ void Emulator::start()
 	}
 	else
 #endif
+	if (config::CachedInterpreter)
+	{
+		Get_Sh4CachedInterpreter(&sh4_cpu);
+		INFO_LOG(INTERPRETER, "Using Cached Interpreter");
+	}
+	else
 	{
 		Get_Sh4Interpreter(&sh4_cpu);
 		INFO_LOG(DYNAREC, "Using Interpreter");
@@ -298,9 +298,7 @@ static int maple_schd(int tag, int cycles, int jitter, void *arg)
 				asic_RaiseInterrupt(holly_MAPLE_OVERRUN);
 				continue;
 			}
-			size_t size = pair.second.size() * sizeof(u32);
-			u32 *p = (u32 *)GetMemPtr(pair.first, size);
-			memcpy(p, pair.second.data(), size);
+			WriteMemBlock_nommu_ptr(pair.first, pair.second.data(), pair.second.size() * sizeof(u32));
 		}
 		SB_MDST = 0;
 		asic_RaiseInterrupt(holly_MAPLE_DMA);
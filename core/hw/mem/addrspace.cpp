@@ -6,6 +6,7 @@
 #include "hw/sh4/sh4_mem.h"
 #include "oslib/oslib.h"
 #include "oslib/virtmem.h"
+#include "cfg/option.h"
 #include <cassert>
 
 namespace addrspace
@@ -106,6 +107,13 @@ T DYNACALL readt(u32 addr)
 {
 	constexpr u32 sz = sizeof(T);
 
+	if constexpr (sz == 8)
+	{
+		// Paired 32-bit accesses merged by the dynarec may only be 4-byte aligned.
+		// The two halves can then be in different pages.
+		if ((addr & 7) != 0)
+			return readt<u32>(addr) | ((u64)readt<u32>(addr + 4) << 32);
+	}
 	u32 page = addr >> 24;	//1 op, shift/extract
 	uintptr_t iirf = (uintptr_t)memInfo_ptr[page]; //2 ops, insert + read [vmem table will be on reg ]
 	void *ptr = (void *)(iirf & ~HANDLER_MAX);     //2 ops, and // 1 op insert
@@ -150,6 +158,15 @@ void DYNACALL writet(u32 addr, T data)
 {
 	constexpr u32 sz = sizeof(T);
 
+	if constexpr (sz == 8)
+	{
+		if ((addr & 7) != 0)
+		{
+			writet<u32>(addr, (u32)data);
+			writet<u32>(addr + 4, (u32)((u64)data >> 32));
+			return;
+		}
+	}
 	u32 page = addr>>24;
 	uintptr_t iirf = (uintptr_t)memInfo_ptr[page];
 	void *ptr = (void *)(iirf & ~HANDLER_MAX);
@@ -204,6 +221,147 @@ void DYNACALL write16(u32 Address,u16 data) { writet<u16>(Address,data); }
 void DYNACALL write32(u32 Address,u32 data) { writet<u32>(Address,data); }
 void DYNACALL write64(u32 Address,u64 data) { writet<u64>(Address,data); }
 
+static u8 *hostPtr(u32 addr)
+{
+	uintptr_t iirf = (uintptr_t)memInfo_ptr[addr >> 24];
+	u8 *ptr = (u8 *)(iirf & ~HANDLER_MAX);
+	if (ptr == nullptr)
+		return nullptr;
+	const u32 shift = iirf & HANDLER_MAX;
+	return ptr + ((addr << shift) >> shift);
+}
+
+Span resolve(u32 addr, u32 size)
+{
+	const uintptr_t iirf = (uintptr_t)memInfo_ptr[addr >> 24];
+	Span span;
+	span.ptr = hostPtr(addr);
+	span.id = span.ptr == nullptr ? (handler)iirf : 0;
+	span.size = 0;
+	while (span.size < size)
+	{
+		const u32 cur = addr + span.size;
+		const uintptr_t curIirf = (uintptr_t)memInfo_ptr[cur >> 24];
+		u32 left = 0x1000000 - (cur & 0xFFFFFF);
+		if (span.ptr != nullptr)
+		{
+			// Memory blocks wrap around at their mask, and following pages are usually mirrors
+			if (span.size != 0 && hostPtr(cur) != span.ptr + span.size)
+				break;
+			const u32 shift = curIirf & HANDLER_MAX;
+			left = std::min<u64>(left, (1ull << (32 - shift)) - ((cur << shift) >> shift));
+		}
+		else if (curIirf != iirf)
+		{
+			break;
+		}
+		span.size += std::min(left, size - span.size);
+	}
+	return span;
+}
+
+static void readHandler(handler id, u32 addr, u8 *data, u32 size)
+{
+	u32 i = 0;
+	for (; i + 4 <= size; i += 4)
+	{
+		const u32 v = RF32[id](addr + i);
+		memcpy(&data[i], &v, 4);
+	}
+	if (i + 2 <= size)
+	{
+		const u16 v = RF16[id](addr + i);
+		memcpy(&data[i], &v, 2);
+		i += 2;
+	}
+	if (i < size)
+		data[i] = RF8[id](addr + i);
+}
+
+static void writeHandler(handler id, u32 addr, const u8 *data, u32 size)
+{
+	u32 i = 0;
+	for (; i + 4 <= size; i += 4)
+	{
+		u32 v;
+		memcpy(&v, &data[i], 4);
+		WF32[id](addr + i, v);
+	}
+	if (i + 2 <= size)
+	{
+		u16 v;
+		memcpy(&v, &data[i], 2);
+		WF16[id](addr + i, v);
+		i += 2;
+	}
+	if (i < size)
+		WF8[id](addr + i, data[i]);
+}
+
+void readBlock(u32 addr, void *data, u32 size)
+{
+	u8 *dst = (u8 *)data;
+	while (size > 0)
+	{
+		const Span span = resolve(addr, size);
+		if (span.ptr != nullptr)
+			memcpy(dst, span.ptr, span.size);
+		else
+			readHandler(span.id, addr, dst, span.size);
+		addr += span.size;
+		dst += span.size;
+		size -= span.size;
+	}
+}
+
+void writeBlock(u32 addr, const void *data, u32 size)
+{
+	const u8 *src = (const u8 *)data;
+	while (size > 0)
+	{
+		const Span span = resolve(addr, size);
+		if (span.ptr != nullptr)
+			memcpy(span.ptr, src, span.size);
+		else
+			writeHandler(span.id, addr, src, span.size);
+		addr += span.size;
+		src += span.size;
+		size -= span.size;
+	}
+}
+
+void copyBlock(u32 dst, u32 src, u32 size)
+{
+	while (size > 0)
+	{
+		Span span = resolve(src, size);
+		if (span.ptr != nullptr)
+		{
+			writeBlock(dst, span.ptr, span.size);
+		}
+		else
+		{
+			const Span dstSpan = resolve(dst, span.size);
+			if (dstSpan.ptr != nullptr)
+			{
+				readHandler(span.id, src, dstSpan.ptr, dstSpan.size);
+			}
+			else
+			{
+				u32 i = 0;
+				for (; i + 4 <= dstSpan.size; i += 4)
+					WF32[dstSpan.id](dst + i, RF32[span.id](src + i));
+				for (; i < dstSpan.size; i++)
+					WF8[dstSpan.id](dst + i, RF8[span.id](src + i));
+			}
+			span.size = dstSpan.size;
+		}
+		dst += span.size;
+		src += span.size;
+		size -= span.size;
+	}
+}
+
 #define MEM_ERROR_RETURN_VALUE 0
 
 //default read handler
@@ -446,6 +604,7 @@ void initMappings()
 			// This is outside of the 512MB addr space. We map 8MB in all cases to help some games read past the end of aica ram
 			{0x20000000, 0x20800000,           MAP_ARAM_START_OFFSET, ARAM_SIZE,  true},  // writable aica ram
 		};
+		virtmem::set_hints(config::HugePages, config::PrefaultMemory);
 		virtmem::create_mappings(&mem_mappings[0], std::size(mem_mappings));
 
 		// Point buffers to actual data pointers
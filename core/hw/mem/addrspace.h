@@ -69,6 +69,21 @@ void release();
 void *readConst(u32 addr, bool& ismem, u32 sz);
 void *writeConst(u32 addr, bool& ismem, u32 sz);
 
+// A contiguous part of the address space: host memory, or a run of pages mapped to the same handler
+struct Span
+{
+	u8 *ptr;		// host memory, or nullptr for a handler run
+	handler id;
+	u32 size;
+};
+// Returns the longest span at the start of [addr, addr + size)
+Span resolve(u32 addr, u32 size);
+
+// Block transfers with one memcpy per host memory span. Handlers are called for each 32-bit word otherwise.
+void readBlock(u32 addr, void *data, u32 size);
+void writeBlock(u32 addr, const void *data, u32 size);
+void copyBlock(u32 dst, u32 src, u32 size);
+
 extern u8* ram_base;
 
 static inline bool virtmemEnabled() {
@@ -321,6 +321,48 @@ u16 AWCartridge::decrypt(u16 cipherText, u32 address, const u8 key)
 	return ((b3<<13)|(b2<<9)|(b1<<5)|b0)^xor_table[key&0xf];
 }
 
+void AWCartridge::init_luts()
+{
+	const u8* pbox = permutation_table[rombd_key >> 6];
+	const sbox_set* ss = &sboxes_table[(rombd_key >> 4) & 3];
+	const u8 text_swap_vec[] = {
+			pbox[15],pbox[14],pbox[13],pbox[12],pbox[11],pbox[10],pbox[9],pbox[8],
+			pbox[7],pbox[6],pbox[5],pbox[4],pbox[3],pbox[2],pbox[1],pbox[0] };
+	const u8 addr_swap_vec[] = { 13,5,2, 14,10,9,4, 15,11,6,1, 12,8,7,3,0 };
+
+	for (u32 b = 0; b < 256; b++)
+	{
+		text_lut[0][b] = bitswap16(b, text_swap_vec);
+		text_lut[1][b] = bitswap16(b << 8, text_swap_vec);
+		addr_lut[0][b] = bitswap16(b, addr_swap_vec);
+		addr_lut[1][b] = bitswap16(b << 8, addr_swap_vec);
+	}
+	const u16 xorKey = xor_table[rombd_key & 0xf];
+	for (u32 aux = 0; aux < 0x10000; aux++)
+		sbox_lut[aux] = ((ss->S3[aux >> 13] << 13)
+				| (ss->S2[(aux >> 9) & 0xf] << 9)
+				| (ss->S1[(aux >> 5) & 0xf] << 5)
+				| ss->S0[aux & 0x1f]) ^ xorKey;
+}
+
+void AWCartridge::decrypt(u16 *dst, u32 wordOffset, u32 count) const
+{
+	const u16 *rom = (const u16 *)RomPtr;
+	const u32 romWords = RomSize / 2;
+	u32 index = wordOffset % romWords;
+	for (u32 i = 0; i < count; i++)
+	{
+		// Only the low 16 bits of the address are used
+		u32 address = wordOffset + i;
+		u16 cipherText = rom[index];
+		u16 aux = text_lut[0][cipherText & 0xff] ^ text_lut[1][cipherText >> 8]
+				^ addr_lut[0][address & 0xff] ^ addr_lut[1][(address >> 8) & 0xff];
+		dst[i] = sbox_lut[aux];
+		if (++index == romWords)
+			index = 0;
+	}
+}
+
 
 void AWCartridge::Init(LoadProgress *progress, std::vector<u8> *digest)
 {
@@ -332,6 +374,7 @@ void AWCartridge::Init(LoadProgress *progress, std::vector<u8> *digest)
 void AWCartridge::SetKey(u32 key)
 {
 	rombd_key = key;
+	init_luts();
 }
 
 void AWCartridge::device_reset()
@@ -377,13 +420,11 @@ void AWCartridge::recalc_dma_offset(int mode)
 
 void *AWCartridge::GetDmaPtr(u32 &size)
 {
-	size = std::min(std::min(size, 32u), dma_limit - dma_offset);
-	u32 offset = dma_offset / 2;
-	for (u32 i = 0; i < size / 2; i++)
-		decrypted_buf[i] = decrypt16(offset + i);
+	size = std::min(std::min(size, (u32)sizeof(decrypted_buf)), dma_limit - dma_offset);
+	decrypt(decrypted_buf, dma_offset / 2, size / 2);
 
 //	printf("AWCART Decrypted data @ %08x:\n", dma_offset);
-//	for (int i = 0; i < 16; i++)
+//	for (int i = 0; i < size / 2; i++)
 //	{
 //		printf("%02x %02x ", decrypted_buf[i] & 0xff, decrypted_buf[i] >> 8);
 //		if ((i + 1) % 8 == 0)
@@ -31,6 +31,11 @@ public:
 	void Serialize(Serializer& ser) const override;
 	void Deserialize(Deserializer& deser) override;
 
+	// Reference implementation, one word at a time
+	static u16 decrypt(u16 cipherText, u32 address, u8 key);
+	// Decrypt count words of ROM starting at wordOffset using the key lookup tables
+	void decrypt(u16 *dst, u32 wordOffset, u32 count) const;
+
 private:
 	void device_reset();
 
@@ -40,7 +45,7 @@ private:
 	u32 mpr_offset, mpr_bank;
 	u32 epr_offset, mpr_file_offset;
 	u16 mpr_record_index, mpr_first_file_index;
-	u16 decrypted_buf[16];
+	u16 decrypted_buf[1024];
 
 	u32 dma_offset, dma_limit;
 
@@ -54,8 +59,21 @@ private:
 	static const u8 permutation_table[4][16];
 	static const sbox_set sboxes_table[4];
 	static const int xor_table[16];
-	static u16 decrypt(u16 cipherText, u32 address, u8 key);
-	u16 decrypt16(u32 address) { return decrypt(((u16 *)RomPtr)[address % (RomSize / 2)], address, rombd_key); }
+
+	// Per-key lookup tables. The text and address bit permutations are linear
+	// so they are split into low and high byte tables.
+	u16 text_lut[2][256];
+	u16 addr_lut[2][256];
+	u16 sbox_lut[0x10000];
+	void init_luts();
+
+	u16 decrypt16(u32 address) const
+	{
+		u16 cipherText = ((const u16 *)RomPtr)[address % (RomSize / 2)];
+		u16 aux = text_lut[0][cipherText & 0xff] ^ text_lut[1][cipherText >> 8]
+				^ addr_lut[0][address & 0xff] ^ addr_lut[1][(address >> 8) & 0xff];
+		return sbox_lut[aux];
+	}
 
 	void recalc_dma_offset(int mode);
 };
@@ -15,6 +15,9 @@
 #include "emulator.h"
 #include "oslib/storage.h"
 
+#include <atomic>
+#include <thread>
+
 /*
 
   GPIO pins(main board: EEPROM, DIMM SPDs, option board: PIC16, JPs)
@@ -392,6 +395,51 @@ u64 GDCartridge::rev64(u64 src)
 	return ret;
 }
 
+// DES is used in ECB mode so the data is split in chunks that are decrypted concurrently
+void GDCartridge::des_decrypt(u8 *data, u32 size, u64 key, LoadProgress *progress)
+{
+	u32 des_subkeys[32];
+	des_generate_subkeys(rev64(key), des_subkeys);
+
+	constexpr u32 ChunkSize = 256_KB;
+	size = (size + 7) & ~7;
+	const u32 chunkCount = (size + ChunkSize - 1) / ChunkSize;
+	std::atomic<u32> nextChunk { 0 };
+	std::atomic<bool> cancelled { false };
+	auto decryptChunks = [&](bool reportProgress)
+	{
+		for (;;)
+		{
+			const u32 chunk = nextChunk++;
+			if (chunk >= chunkCount || cancelled)
+				break;
+			if (reportProgress && progress != nullptr)
+			{
+				if (progress->cancelled)
+				{
+					cancelled = true;
+					break;
+				}
+				progress->label = "Decrypting...";
+				progress->progress = (float)chunk / chunkCount;
+			}
+			const u32 end = std::min((chunk + 1) * ChunkSize, size);
+			for (u32 i = chunk * ChunkSize; i < end; i += 8)
+				*(u64 *)(data + i) = des_encrypt_decrypt<true>(*(u64 *)(data + i), des_subkeys);
+		}
+	};
+	const u32 threadCount = std::min(std::max(std::thread::hardware_concurrency(), 1u), chunkCount);
+	std::vector<std::thread> threads;
+	for (u32 i = 1; i < threadCount; i++)
+		threads.emplace_back(decryptChunks, false);
+	// The calling thread takes its share of the work and reports progress
+	decryptChunks(true);
+	for (auto& thread : threads)
+		thread.join();
+	if (cancelled)
+		throw LoadCancelledException();
+}
+
 void GDCartridge::find_file(const char *name, const u8 *dir_sector, u32 &file_start, u32 &file_size)
 {
 	file_start = 0;
@@ -594,20 +642,7 @@ void GDCartridge::device_start(LoadProgress *progress, std::vector<u8> *digest)
 			read_gdrom(gdrom.get(), file_start, dimm_data, sectors, progress);
 
 			// decrypt loaded data
-			u32 des_subkeys[32];
-			des_generate_subkeys(rev64(key), des_subkeys);
-
-			for (u32 i = 0; i < file_rounded_size; i += 8)
-			{
-				if ((i & 0xfff) == 0 && progress != nullptr)
-				{
-					if (progress->cancelled)
-						throw LoadCancelledException();
-					progress->label = "Decrypting...";
-					progress->progress = (float)(i + 8) / file_rounded_size;
-				}
-				*(u64 *)(dimm_data + i) = des_encrypt_decrypt<true>(*(u64 *)(dimm_data + i), des_subkeys);
-			}
+			des_decrypt(dimm_data, file_rounded_size, key, progress);
 		}
 
 		if (!dimm_data)
@@ -40,6 +40,12 @@ protected:
 	u8 *dimm_data = nullptr;
 	u32 dimm_data_size = 0;
 
+	void des_decrypt(u8 *data, u32 size, u64 key, LoadProgress *progress = nullptr);
+	template<bool decrypt>
+	static u64 des_encrypt_decrypt(u64 src, const u32 *des_subkeys);
+	static void des_generate_subkeys(u64 key, u32 *subkeys);
+	static u64 rev64(u64 src);
+
 private:
 	enum { FILENAME_LENGTH=24 };
 
@@ -65,11 +71,7 @@ private:
 	void device_reset();
 	void find_file(const char *name, const u8 *dir_sector, u32 &file_start, u32 &file_size);
 
-	inline void permutate(u32 &a, u32 &b, u32 m, int shift);
-	void des_generate_subkeys(u64 key, u32 *subkeys);
-	template<bool decrypt>
-	u64 des_encrypt_decrypt(u64 src, const u32 *des_subkeys);
-	u64 rev64(u64 src);
+	static inline void permutate(u32 &a, u32 &b, u32 m, int shift);
 	void read_gdrom(Disc *gdrom, u32 sector, u8* dst, u32 count = 1, LoadProgress *progress = nullptr);
 };
 
@@ -122,8 +122,6 @@ u32 M1Cartridge::get_decrypted_32b()
 	u8 d = base[3];
 	rom_cur_address += 4;
 
-	u32 swapped_key = (key >> 24) | ((key >> 8) & 0xFF00)
-			| ((key << 8) & 0xFF0000) | (key << 24);
 	u32 res = swapped_key ^ (((b ^ d) << 24) | ((a ^ c) << 16) | (b << 8) | a);
 	return res;
 }
@@ -34,6 +34,12 @@ public:
 	}
 
 	void AdvancePtr(u32 size) override;
+	void SetKey(u32 key) override
+	{
+		NaomiCartridge::SetKey(key);
+		swapped_key = (key >> 24) | ((key >> 8) & 0xFF00)
+				| ((key << 8) & 0xFF0000) | (key << 24);
+	}
 	void Serialize(Serializer& ser) const override;
 	void Deserialize(Deserializer& deser) override;
 
@@ -99,6 +105,7 @@ private:
 	void enc_fill();
 
 	u16 actel_id;
+	u32 swapped_key = 0;
 
 	u8 buffer[32768];
 	u8 dict[111], hist[2];
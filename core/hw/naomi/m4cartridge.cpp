@@ -246,19 +246,36 @@ u16 M4Cartridge::decrypt(u16 enc)
 	return dec;
 }
 
-void M4Cartridge::enc_fill()
+// Bulk version of decrypt(u16). size must be even.
+void M4Cartridge::decrypt(const u8 *src, u8 *dst, u32 size)
 {
-	const u8 *base = RomPtr + rom_cur_address;
-	while (buffer_actual_size < sizeof(buffer))
+	// Keep the cipher state in locals so it isn't reloaded after each store
+	u16 curIv = iv;
+	u32 curCounter = counter;
+	const u16 key1 = subkey1;
+	const u16 key2 = subkey2;
+	for (u32 i = 0; i < size; i += 2)
 	{
-		u16 dec = decrypt(base[0] | (base[1] << 8));
-
-		buffer[buffer_actual_size++] = dec;
-		buffer[buffer_actual_size++] = dec >> 8;
-
-		base += 2;
-		rom_cur_address += 2;
+		u16 dec = curIv;
+		curIv = one_round[(src[i] | (src[i + 1] << 8)) ^ curIv ^ key1] ^ key1;
+		dec ^= one_round[curIv ^ key2] ^ key2;
+		dst[i] = dec;
+		dst[i + 1] = dec >> 8;
+		if (++curCounter == 16) {
+			curCounter = 0;
+			curIv = 0;
+		}
 	}
+	iv = curIv;
+	counter = curCounter;
+}
+
+void M4Cartridge::enc_fill()
+{
+	u32 size = sizeof(buffer) - buffer_actual_size;
+	decrypt(RomPtr + rom_cur_address, buffer + buffer_actual_size, size);
+	buffer_actual_size += size;
+	rom_cur_address += size;
 //	printf("Decrypted M4 data:\n");
 //	for (int i = 0; i < buffer_actual_size; i++)
 //	{
@@ -267,8 +284,6 @@ void M4Cartridge::enc_fill()
 //			printf("\n");
 //	}
 //	printf("\n");
-
-
 }
 
 bool M4Cartridge::Write(u32 offset, u32 size, u32 data)
@@ -55,6 +55,7 @@ protected:
 	void DmaOffsetChanged(u32 dma_offset) override;
 	void PioOffsetChanged(u32 pio_offset) override;
 	u16 decrypt(u16 w);
+	void decrypt(const u8 *src, u8 *dst, u32 size);
 	void enc_reset();
 
 private:
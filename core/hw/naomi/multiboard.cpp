@@ -33,7 +33,6 @@ static Multiboard *multiboard;
 #include "naomi_roms.h"
 #include "cfg/option.h"
 #include "hw/sh4/sh4_sched.h"
-#include <chrono>
 
 constexpr int SyncCycles = 500000;
 
@@ -101,11 +100,7 @@ Multiboard::Multiboard()
 	if (sharedMem == nullptr)
 		throw FlycastException("Cannot initialize Naomi multiboard shared memory");
 	if (isMaster())
-	{
 		new (sharedMem) SharedMemory();
-		sharedMem->boardReady[1] = sharedMem->boardReady[2] = sharedMem->boardReady[3] = true;
-		sharedMem->boardSynced[1] = sharedMem->boardSynced[2] = sharedMem->boardSynced[3] = true;
-	}
 	multiboard = this;
 	schedId = sh4_sched_register(0, schedCallback);
 	sh4_sched_request(schedId, SyncCycles);
@@ -121,8 +116,7 @@ void Multiboard::startSlave()
 	else
 		slaves = 1;
 	boardCount = slaves + 1;
-	for (int i = 0; i < boardCount; i++)
-		sharedMem->boardReady[i] = false;
+	sharedMem->barrier.reset(boardCount);
 
 	int x = cfgLoadInt("window", "left", (1920 - 640) / 2);
 	int y = cfgLoadInt("window", "top", (1080 - 480) / 2);
@@ -155,60 +149,24 @@ void Multiboard::syncWait()
 	if (isMaster() && !slaveStarted)
 		return;
 
-	{
-		std::unique_lock<IpcMutex> lock(sharedMem->mutex);
-		sharedMem->boardReady[boardId] = true;
-		sharedMem->boardSynced[boardId] = false;
-		sharedMem->cond.notify_all();
+	const auto start = std::chrono::steady_clock::now();
+	bool synced = sharedMem->barrier.wait(boardId, std::chrono::seconds(5), sharedMem->exit);
+	if (isSlave() && sharedMem->exit) {
+		NOTICE_LOG(NAOMI, "Slave exiting");
+		throw FlycastException("Slave exit");
 	}
-	do {
-		if (isSlave() && sharedMem->exit) {
-			NOTICE_LOG(NAOMI, "Slave exiting");
-			throw FlycastException("Slave exit");
-		}
-		{
-			std::unique_lock<IpcMutex> lock(sharedMem->mutex);
-			bool allReady = true;
-			for (const auto& ready : sharedMem->boardReady)
-				if (!ready) {
-					allReady = false;
-					break;
-				}
-			if (allReady) {
-				sharedMem->boardSynced[boardId] = true;
-				sharedMem->cond.notify_all();
-				break;
-			}
-			if (sharedMem->cond.wait_for(lock, std::chrono::seconds(5)) ==  std::cv_status::timeout) {
-				ERROR_LOG(NAOMI, "Time out waiting for multiboard vsync. Slave %d", isSlave());
-				return;
-			}
-		}
-	} while (true);
-	if (isMaster())
+	if (!synced) {
+		ERROR_LOG(NAOMI, "Time out waiting for multiboard vsync. Slave %d", isSlave());
+		return;
+	}
+	u64 waitTime = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count();
+	syncStats.totalWait += waitTime;
+	syncStats.maxWait = std::max(syncStats.maxWait, waitTime);
+	// roughly every second
+	if (++syncStats.syncs == SH4_MAIN_CLOCK / SyncCycles)
 	{
-		do {
-			{
-				std::unique_lock<IpcMutex> lock(sharedMem->mutex);
-
-				bool allSynced = true;
-				for (const auto& synced : sharedMem->boardSynced)
-					if (!synced) {
-						allSynced = false;
-						break;
-					}
-				if (allSynced)
-				{
-					for (int i = 0; i < boardCount; i++)
-						sharedMem->boardReady[i] = false;
-					break;
-				}
-				if (sharedMem->cond.wait_for(lock, std::chrono::seconds(5)) ==  std::cv_status::timeout) {
-					ERROR_LOG(NAOMI, "Time out waiting for multiboard vsync");
-					break;
-				}
-			}
-		} while (true);
+		DEBUG_LOG(NAOMI, "Multiboard sync latency: avg %d us max %d us", (int)(syncStats.totalWait / syncStats.syncs), (int)syncStats.maxWait);
+		syncStats = {};
 	}
 }
 
@@ -221,7 +179,7 @@ Multiboard::~Multiboard()
 	if (sharedMem != nullptr)
 	{
 		sharedMem->exit = true;
-		sharedMem->cond.notify_all();
+		sharedMem->barrier.wakeUp();
 		if (isMaster())
 			sharedMem->~SharedMemory();
 	}
@@ -23,6 +23,11 @@
 #include "hw/holly/sb.h"
 #include "hw/sh4/sh4_mem.h"
 #include <atomic>
+#include <chrono>
+#include <thread>
+#if defined(__i386__) || defined(__x86_64__) || defined(_M_IX86) || defined(_M_X64)
+#include <emmintrin.h>
+#endif
 
 
 #ifdef _WIN32
@@ -244,6 +249,129 @@ public:
 };
 #endif // _!WIN32
 
+//
+// Synchronization point between the master and slave boards, to be placed in shared memory.
+// Boards spin for a short while before parking on the condition variable, so that
+// a sync point doesn't cost a context switch when all boards arrive at about the same time.
+//
+class IpcBarrier
+{
+public:
+	static constexpr int MaxBoards = 4;
+
+	IpcBarrier()
+	{
+		for (auto& r : ready)
+			r = true;
+	}
+
+	// Called by the master before starting the slaves
+	void reset(int boardCount)
+	{
+		for (int i = 0; i < MaxBoards; i++)
+			ready[i] = i >= boardCount;
+		this->boardCount = boardCount;
+	}
+
+	// Returns false on timeout or if exit is set
+	bool wait(int boardId, std::chrono::milliseconds timeout, const std::atomic<bool>& exit)
+	{
+		if (boardId == 0)
+		{
+			ready[0] = true;
+			if (!waitUntil([this]() { return allReady(); }, timeout, exit))
+				return false;
+			for (int i = 0; i < boardCount; i++)
+				ready[i] = false;
+			generation++;
+			wakeUp();
+		}
+		else
+		{
+			// The master can't release the barrier before this board is ready,
+			// so the generation must be read first.
+			const u32 gen = generation;
+			ready[boardId] = true;
+			wakeUp();
+			if (!waitUntil([this, gen]() { return generation != gen; }, timeout, exit))
+				return false;
+		}
+		return true;
+	}
+
+	void wakeUp()
+	{
+		if (waiters > 0)
+		{
+			std::lock_guard<IpcMutex> _(mutex);
+			cond.notify_all();
+		}
+	}
+
+private:
+	static constexpr int SpinCount = 4000;
+
+	static void cpuRelax()
+	{
+#if defined(__i386__) || defined(__x86_64__) || defined(_M_IX86) || defined(_M_X64)
+		_mm_pause();
+#elif defined(__aarch64__) || defined(__arm__)
+		__asm__ __volatile__("yield");
+#else
+		std::this_thread::yield();
+#endif
+	}
+
+	bool allReady() const
+	{
+		for (const auto& r : ready)
+			if (!r)
+				return false;
+		return true;
+	}
+
+	template<typename Predicate>
+	bool waitUntil(Predicate pred, std::chrono::milliseconds timeout, const std::atomic<bool>& exit)
+	{
+		for (int i = 0; i < SpinCount; i++)
+		{
+			if (pred())
+				return true;
+			if (exit)
+				return false;
+			cpuRelax();
+		}
+		// Waiters must be incremented before checking the predicate with the lock held,
+		// so that wakeUp() either sees it or the predicate is already true.
+		waiters++;
+		bool rc = true;
+		{
+			std::unique_lock<IpcMutex> lock(mutex);
+			const auto deadline = std::chrono::steady_clock::now() + timeout;
+			while (!pred())
+			{
+				auto now = std::chrono::steady_clock::now();
+				if (exit || now >= deadline
+						|| cond.wait_for(lock, std::chrono::duration_cast<std::chrono::milliseconds>(deadline - now))
+							== std::cv_status::timeout)
+				{
+					rc = pred();
+					break;
+				}
+			}
+		}
+		waiters--;
+		return rc;
+	}
+
+	std::atomic<bool> ready[MaxBoards];
+	std::atomic<u32> generation { 0 };
+	std::atomic<u32> waiters { 0 };
+	int boardCount = 1;
+	IpcMutex mutex;
+	IpcConditionVariable cond;
+};
+
 class Multiboard
 {
 public:
@@ -538,10 +666,7 @@ private:
 	struct SharedMemory
 	{
 		std::atomic<u16> status;
-		IpcMutex mutex;
-		IpcConditionVariable cond;
-		std::atomic<bool> boardReady[4];
-		std::atomic<bool> boardSynced[4];
+		IpcBarrier barrier;
 		std::atomic<bool> exit;
 		u16 data[MEM_SIZE];
 	};
@@ -558,6 +683,12 @@ private:
 	int boardCount = 0;
 	bool slaveStarted = false;
 	int schedId;
+
+	struct {
+		u32 syncs = 0;
+		u64 totalWait = 0;	// microseconds
+		u64 maxWait = 0;
+	} syncStats;
 };
 
 #else // !NAOMI_MULTIBOARD
@@ -83,7 +83,7 @@ void NaomiM3Comm::connectNetwork()
 	}
 }
 
-bool NaomiM3Comm::receiveNetwork()
+bool NaomiM3Comm::receiveNetwork(std::chrono::milliseconds timeout)
 {
 	const u32 slot_size = swap16(*(u16*)&m68k_ram[0x204]);
 	const u32 packet_size = slot_size * slot_count;
@@ -91,7 +91,7 @@ bool NaomiM3Comm::receiveNetwork()
 	std::unique_ptr<u8[]> buf = std::make_unique<u8[]>(packet_size);
 
 	u16 packetNumber;
-	if (!naomiNetwork.receive(buf.get(), packet_size, &packetNumber))
+	if (!naomiNetwork.receive(buf.get(), packet_size, &packetNumber, timeout))
 		return false;
 
 	*(u16*)&comm_ram[6] = swap16(packetNumber);
@@ -266,14 +266,8 @@ void NaomiM3Comm::vblank()
 	if ((comm_ctrl & COMM_CTRL_RESET) == 0 || comm_status1 == 0)
 		return;
 
-	using the_clock = std::chrono::high_resolution_clock;
-	the_clock::time_point start = the_clock::now();
 	try {
-		bool received = false;
-		do {
-			received = receiveNetwork();
-		} while (!received && the_clock::now() - start < std::chrono::milliseconds(100));
-		if (!received)
+		if (!receiveNetwork(std::chrono::milliseconds(100)))
 			INFO_LOG(NETWORK, "No data received");
 		sendNetwork();
 	} catch (const FlycastException& e) {
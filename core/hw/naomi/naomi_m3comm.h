@@ -20,6 +20,7 @@
  */
 #pragma once
 #include "types.h"
+#include <chrono>
 
 class NaomiM3Comm
 {
@@ -33,7 +34,7 @@ public:
 
 private:
 	void connectNetwork();
-	bool receiveNetwork();
+	bool receiveNetwork(std::chrono::milliseconds timeout);
 	void sendNetwork();
 	void connectedState();
 
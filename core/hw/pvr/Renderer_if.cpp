@@ -1,5 +1,6 @@
 #include "Renderer_if.h"
 #include "spg.h"
+#include "elan.h"
 #include "rend/TexCache.h"
 #include "rend/transform_matrix.h"
 #include "cfg/option.h"
@@ -22,7 +23,6 @@ u32 FrameCount=1;
 
 Renderer* renderer;
 
-static cResetEvent renderEnd;
 u32 fb_w_cur = 1;
 static cResetEvent vramRollback;
 
@@ -64,13 +64,14 @@ public:
 			// FIXME need some synchronization to avoid blinking in densha de go
 			// or use !threaded rendering for emufb?
 			// or read framebuffer vram on emu thread
+			// Render messages aren't deduplicated since they are bounded by the TA context render queue
 			bool dupe;
 			do {
 				dupe = false;
 				{
 					const lock_guard lock(mutex);
 					for (const auto& m : queue)
-						if (m.type == type) {
+						if (m.type == type && type != Render) {
 							dupe = true;
 							break;
 						}
@@ -200,15 +201,15 @@ private:
 
 		if (renderToScreen)
 			// If rendering to texture or in full framebuffer emulation, continue locking until the frame is rendered
-			renderEnd.Set();
-		rend_allow_rollback();
+			ReleaseRenderVram();
+		ProcessedRender();
 		{
 			FC_PROFILE_SCOPE_NAMED("Renderer::Render");
 			renderer->Render();
 		}
 
 		if (!renderToScreen)
-			renderEnd.Set();
+			ReleaseRenderVram();
 		else if (config::DelayFrameSwapping && fb_w_cur == FB_R_SOF1)
 			present();
 
@@ -342,7 +343,7 @@ void rend_term_renderer()
 
 void rend_reset()
 {
-	FinishRender(DequeueRender());
+	ClearRenderQueue();
 	render_called = false;
 	pend_rend = false;
 	FrameCount = 1;
@@ -355,6 +356,8 @@ void rend_reset()
 
 void rend_start_render()
 {
+	if (settings.platform.isNaomi2())
+		elan::sync();
 	render_called = true;
 	pend_rend = false;
 
@@ -440,8 +443,9 @@ int rend_end_render(int tag, int cycles, int jitter, void *arg)
 		asic_RaiseInterrupt(holly_RENDER_DONE_isp);
 		asic_RaiseInterrupt(holly_RENDER_DONE_vd);
 	}
+	// The game may modify textures and palettes in vram once the render is done
 	if (pend_rend && config::ThreadedRendering)
-		renderEnd.Wait();
+		WaitRenderVram();
 
 	return 0;
 }
@@ -479,7 +483,6 @@ void rend_cancel_emu_wait()
 	if (config::ThreadedRendering)
 	{
 		FinishRender(NULL);
-		renderEnd.Set();
 		rend_allow_rollback();
 		pvrQueue.cancelEnqueue();
 		// Needed for android where this function may be called
@@ -60,11 +60,17 @@
 #include "hw/sh4/sh4_sched.h"
 #include "serialize.h"
 #include "elan_struct.h"
+#include "elan_batch.h"
 #include "network/ggpo.h"
 #include "cfg/option.h"
+#include "stdclass.h"
 #include <glm/glm.hpp>
 #include <glm/gtc/matrix_transform.hpp>
 #include <glm/gtc/type_ptr.hpp>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
 
 namespace elan {
 
@@ -85,6 +91,60 @@ static u32 elanCmd[32 / 4];
 
 static int schedId = -1;
 
+// Deferred command processing: the SH4 thread only walks the command buffers to raise
+// interrupts and start DMAs. The geometry is processed by a worker thread using a copy
+// of the ELAN RAM ranges referenced by each command.
+namespace deferred
+{
+struct Job
+{
+	u32 cmd[32 / 4];
+	// ELAN RAM ranges (offset, size) referenced by the command, their contents are in data
+	std::vector<std::pair<u32, u32>> ranges;
+	std::vector<u8> data;
+};
+
+// TA parser and T&L state as seen by the SH4 command walk
+struct WalkState
+{
+	// List type. -2 if it must be read from the TA parser, UnknownList if it depends on whether
+	// the ICH polygons walked have been culled
+	int listType = -2;
+	// Size of the vertex parameters, 0 if unknown
+	u32 vertexSize = 0;
+	// ELAN RAM offsets of the GMP, light model and lights read when drawing polygons
+	u32 gmp;
+	u32 lightModel;
+	u32 lights[MAX_LIGHTS];
+};
+constexpr int UnknownList = -3;
+
+static bool active;
+// Jobs have been queued since the last wait
+static bool pending;
+static Job *recordingJob;
+// Set while the SH4 thread walks a command, so the TA parser must not be used
+static bool walking;
+static WalkState walkState;
+// Set by the command walk when the command raises interrupts or starts DMAs
+static bool sideEffects;
+// Set by the command walk when the command must be processed synchronously
+static bool needSync;
+static std::deque<Job> jobs;
+static std::vector<Job> freeJobs;
+static std::vector<u8> shadowRAM;
+static bool stopping;
+static std::mutex mutex;
+static std::condition_variable jobQueued;
+static std::condition_variable jobsDone;
+static DeferredStats stats;
+}
+
+// ELAN RAM as seen by the T&L code
+static inline u8 *geometryRAM() {
+	return deferred::active ? deferred::shadowRAM.data() : RAM;
+}
+
 static u32 DYNACALL read_elanreg(u32 paddr)
 {
 	u32 addr = paddr & 0x01ffffff;
@@ -268,6 +328,7 @@ static glm::vec4 gmpDiffuseColor0;
 static glm::vec4 gmpSpecularColor0;
 static glm::vec4 gmpDiffuseColor1;
 static glm::vec4 gmpSpecularColor1;
+static VertexBatch vertexBatch;
 
 struct State
 {
@@ -316,7 +377,7 @@ struct State
 			envMapVOffset = 0.f;
 			return;
 		}
-		InstanceMatrix *mat = (InstanceMatrix *)&RAM[instance];
+		InstanceMatrix *mat = (InstanceMatrix *)&geometryRAM()[instance];
 		DEBUG_LOG(PVR, "Matrix %f %f %f %f\n       %f %f %f %f\n       %f %f %f %f\nLight: %f %f %f\n       %f %f %f\n       %f %f %f",
 				-mat->tm00, -mat->tm10, -mat->tm20, -mat->tm30,
 				mat->tm01, mat->tm11, mat->tm21, mat->tm31,
@@ -350,7 +411,7 @@ struct State
 
 	void setProjectionMatrix(void *p)
 	{
-		ProjMatrix *pm = (ProjMatrix *)&RAM[elanRamAddress(p)];
+		ProjMatrix *pm = (ProjMatrix *)&geometryRAM()[elanRamAddress(p)];
 		projMatrix[0] = pm->fx;
 		projMatrix[1] = pm->tx;
 		projMatrix[2] = pm->fy;
@@ -407,7 +468,7 @@ struct State
 		}
 		else
 		{
-			curGmp = (GMP *)&RAM[gmp];
+			curGmp = (GMP *)&geometryRAM()[gmp];
 			DEBUG_LOG(PVR, "GMP paramSelect %x", curGmp->paramSelect.full);
 			if (curGmp->paramSelect.d0)
 				gmpDiffuseColor0 = unpackColor(curGmp->diffuse0);
@@ -441,7 +502,7 @@ struct State
 			curLightModel = nullptr;
 		else
 		{
-			curLightModel = (LightModel *)&RAM[lightModel];
+			curLightModel = (LightModel *)&geometryRAM()[lightModel];
 			DEBUG_LOG(PVR, "Light model mask: diffuse %04x specular %04x, ambient base %08x offset %08x", curLightModel->diffuseMask0, curLightModel->specularMask0,
 					curLightModel->ambientBase0, curLightModel->ambientOffset0);
 		}
@@ -461,7 +522,7 @@ struct State
 			elan::curLights[lightId] = nullptr;
 			return;
 		}
-		PointLight *plight = (PointLight *)&RAM[lights[lightId]];
+		PointLight *plight = (PointLight *)&geometryRAM()[lights[lightId]];
 		if (plight->pcw.parallelLight)
 		{
 			ParallelLight *light = (ParallelLight *)plight;
@@ -494,10 +555,11 @@ struct State
 
 	static u32 elanRamAddress(void *p)
 	{
-		if ((u8 *)p < RAM || (u8 *)p >= RAM + ERAM_SIZE)
+		u8 *ram = geometryRAM();
+		if ((u8 *)p < ram || (u8 *)p >= ram + ERAM_SIZE)
 			return Null;
 		else
-			return (u32)((u8 *)p - RAM);
+			return (u32)((u8 *)p - ram);
 	}
 
 	void serialize(Serializer& ser)
@@ -545,7 +607,7 @@ struct State
 
 static State state;
 
-static void setCoords(Vertex& vtx, float x, float y, float z)
+static void setCoords(N2Vertex& vtx, float x, float y, float z)
 {
 	vtx.x = x;
 	vtx.y = y;
@@ -553,7 +615,7 @@ static void setCoords(Vertex& vtx, float x, float y, float z)
 }
 
 template <typename Ts>
-static void setUV(const Ts& vs, Vertex& vd)
+static void setUV(const Ts& vs, N2Vertex& vd)
 {
 	if (envMapping)
 	{
@@ -571,7 +633,7 @@ static void setUV(const Ts& vs, Vertex& vd)
 	}
 }
 
-static void SetEnvMapUV(Vertex& vtx)
+static void SetEnvMapUV(N2Vertex& vtx)
 {
 	if (envMapping)
 	{
@@ -589,7 +651,7 @@ static glm::vec3 getNormal(const T& vtx)
 }
 
 template<typename T>
-static void setNormal(Vertex& vd, const T& vs)
+static void setNormal(N2Vertex& vd, const T& vs)
 {
 	glm::vec3 normal = getNormal(vs);
 	vd.nx = normal.x;
@@ -611,91 +673,96 @@ static void setModelColors(glm::vec4& baseCol0, glm::vec4& offsetCol0, glm::vec4
 		offsetCol1 = gmpSpecularColor1;
 }
 
+// Packed vertex colors that are constant for a whole list
+struct ListColors
+{
+	u32 base0;
+	u32 offset0;
+	u32 base1;
+	u32 offset1;
+	// The model base colors replace the vertex colors
+	bool modelBase0;
+	bool modelBase1;
+
+	void update()
+	{
+		glm::vec4 baseCol0(1);
+		glm::vec4 offsetCol0(0);
+		glm::vec4 baseCol1(1);
+		glm::vec4 offsetCol1(0);
+		setModelColors(baseCol0, offsetCol0, baseCol1, offsetCol1);
+		base0 = packColor(baseCol0);
+		offset0 = packColor(offsetCol0);
+		base1 = packColor(baseCol1);
+		offset1 = packColor(offsetCol1);
+		modelBase0 = curGmp != nullptr && curGmp->paramSelect.d0;
+		modelBase1 = curGmp != nullptr && curGmp->paramSelect.d1;
+	}
+
+	void setColors(N2Vertex& vd) const
+	{
+		*(u32 *)vd.col = base0;
+		*(u32 *)vd.spc = offset0;
+		*(u32 *)vd.col1 = base1;
+		*(u32 *)vd.spc1 = offset1;
+	}
+
+	void setColors(N2Vertex& vd, const PackedRGB& rgb) const
+	{
+		*(u32 *)vd.col = modelBase0 ? base0 : packColor(unpackColor(rgb.argb0));
+		*(u32 *)vd.spc = offset0;
+		*(u32 *)vd.col1 = modelBase1 ? base1 : packColor(unpackColor(rgb.argb1));
+		*(u32 *)vd.spc1 = offset1;
+	}
+};
+
 template <typename T>
-static void convertVertex(const T& vs, Vertex& vd);
+static void convertVertex(const T& vs, N2Vertex& vd, const ListColors& colors);
 
 template<>
-void convertVertex(const N2_VERTEX& vs, Vertex& vd)
+void convertVertex(const N2_VERTEX& vs, N2Vertex& vd, const ListColors& colors)
 {
 	setCoords(vd, vs.x, vs.y, vs.z);
 	setNormal(vd, vs);
 	SetEnvMapUV(vd);
-	glm::vec4 baseCol0(1);
-	glm::vec4 offsetCol0(0);
-	glm::vec4 baseCol1(1);
-	glm::vec4 offsetCol1(0);
-	setModelColors(baseCol0, offsetCol0, baseCol1, offsetCol1);
-
-	*(u32 *)vd.col = packColor(baseCol0);
-	*(u32 *)vd.spc = packColor(offsetCol0);
-	*(u32 *)vd.col1 = packColor(baseCol1);
-	*(u32 *)vd.spc1 = packColor(offsetCol1);
+	colors.setColors(vd);
 }
 
 template<>
-void convertVertex(const N2_VERTEX_VR& vs, Vertex& vd)
+void convertVertex(const N2_VERTEX_VR& vs, N2Vertex& vd, const ListColors& colors)
 {
 	setCoords(vd, vs.x, vs.y, vs.z);
 	setNormal(vd, vs);
 	SetEnvMapUV(vd);
-	glm::vec4 baseCol0 = unpackColor(vs.rgb.argb0);
-	glm::vec4 offsetCol0(0);
-	glm::vec4 baseCol1 = unpackColor(vs.rgb.argb1);
-	glm::vec4 offsetCol1(0);
-	setModelColors(baseCol0, offsetCol0, baseCol1, offsetCol1);
-	*(u32 *)vd.col = packColor(baseCol0);
-	*(u32 *)vd.spc = packColor(offsetCol0);
-	*(u32 *)vd.col1 = packColor(baseCol1);
-	*(u32 *)vd.spc1 = packColor(offsetCol1);
+	colors.setColors(vd, vs.rgb);
 }
 
 template<>
-void convertVertex(const N2_VERTEX_VU& vs, Vertex& vd)
+void convertVertex(const N2_VERTEX_VU& vs, N2Vertex& vd, const ListColors& colors)
 {
 	setCoords(vd, vs.x, vs.y, vs.z);
 	setNormal(vd, vs);
 	setUV(vs, vd);
-	glm::vec4 baseCol0(1);
-	glm::vec4 offsetCol0(0);
-	glm::vec4 baseCol1(1);
-	glm::vec4 offsetCol1(0);
-	setModelColors(baseCol0, offsetCol0, baseCol1, offsetCol1);
-	*(u32 *)vd.col = packColor(baseCol0);
-	*(u32 *)vd.spc = packColor(offsetCol0);
-	*(u32 *)vd.col1 = packColor(baseCol1);
-	*(u32 *)vd.spc1 = packColor(offsetCol1);
+	colors.setColors(vd);
 }
 
 template<>
-void convertVertex(const N2_VERTEX_VUR& vs, Vertex& vd)
+void convertVertex(const N2_VERTEX_VUR& vs, N2Vertex& vd, const ListColors& colors)
 {
 	setCoords(vd, vs.x, vs.y, vs.z);
 	setNormal(vd, vs);
 	setUV(vs, vd);
-	glm::vec4 baseCol0 = unpackColor(vs.rgb.argb0);
-	glm::vec4 offsetCol0(0);
-	glm::vec4 baseCol1 = unpackColor(vs.rgb.argb1);
-	glm::vec4 offsetCol1(0);
-	setModelColors(baseCol0, offsetCol0, baseCol1, offsetCol1);
-	*(u32 *)vd.col = packColor(baseCol0);
-	*(u32 *)vd.spc = packColor(offsetCol0);
-	*(u32 *)vd.col1 = packColor(baseCol1);
-	*(u32 *)vd.spc1 = packColor(offsetCol1);
+	colors.setColors(vd, vs.rgb);
 }
 
 template<>
-void convertVertex(const N2_VERTEX_VUB& vs, Vertex& vd)
+void convertVertex(const N2_VERTEX_VUB& vs, N2Vertex& vd, const ListColors& colors)
 {
 	setCoords(vd, vs.x, vs.y, vs.z);
 	setNormal(vd, vs);
 	setUV(vs, vd);
-	glm::vec4 baseCol0(1);
-	glm::vec4 offsetCol0(0);
-	glm::vec4 baseCol1(1);
-	glm::vec4 offsetCol1(0);
-	setModelColors(baseCol0, offsetCol0, baseCol1, offsetCol1);
-	*(u32 *)vd.col = packColor(baseCol0);
-	*(u32 *)vd.col1 = packColor(baseCol1);
+	*(u32 *)vd.col = colors.base0;
+	*(u32 *)vd.col1 = colors.base1;
 	// Stuff the bump map normals and parameters in the specular colors
 	vd.spc[0] = vs.bump.tangent.x;
 	vd.spc[1] = vs.bump.tangent.y;
@@ -717,17 +784,9 @@ void convertVertex(const N2_VERTEX_VUB& vs, Vertex& vd)
 //			);
 }
 
-template <typename T>
-static void boundingBox(const T* vertices, u32 count, glm::vec3& min, glm::vec3& max)
+static void boundingBox(glm::vec3& min, glm::vec3& max)
 {
-	min = { 1e38f, 1e38f, 1e38f };
-	max = { -1e38f, -1e38f, -1e38f };
-	for (u32 i = 0; i < count; i++)
-	{
-		glm::vec3 pos{ vertices[i].x, vertices[i].y, vertices[i].z };
-		min = glm::min(min, pos);
-		max = glm::max(max, pos);
-	}
+	vertexBatch.boundingBox(min, max);
 	glm::vec4 center((min + max) / 2.f, 1);
 	glm::vec4 extents(max - glm::vec3(center), 0);
 	// transform
@@ -742,12 +801,14 @@ static void boundingBox(const T* vertices, u32 count, glm::vec3& min, glm::vec3&
 	max = glm::vec3(center) + newExtent;
 }
 
+// Also gathers the vertex positions and computes their distance to the near plane if needed
 template <typename T>
 static bool isBetweenNearAndFar(const T* vertices, u32 count, bool& needNearClipping)
 {
+	vertexBatch.gather(vertices, count);
 	glm::vec3 min;
 	glm::vec3 max;
-	boundingBox(vertices, count, min, max);
+	boundingBox(min, max);
 	if (min.z > -nearPlane || max.z < -farPlane)
 		return false;
 
@@ -757,6 +818,8 @@ static bool isBetweenNearAndFar(const T* vertices, u32 count, bool& needNearClip
 		return false;
 
 	needNearClipping = max.z > -nearPlane;
+	if (needNearClipping)
+		vertexBatch.computeNearDistances(curMatrix, nearPlane);
 
 	return true;
 }
@@ -766,12 +829,11 @@ class TriangleStripClipper
 public:
 	TriangleStripClipper(bool enabled) : enabled(enabled) {}
 
-	void add(const Vertex& vtx)
+	// dist: distance of the vertex to the near plane
+	void add(const N2Vertex& vtx, float dist)
 	{
 		if (enabled)
 		{
-			float z = vtx.x * curMatrix[0][2] + vtx.y * curMatrix[1][2] + vtx.z * curMatrix[2][2] + curMatrix[3][2];
-			float dist = -z - nearPlane;
 			clip(vtx, dist);
 			count++;
 		}
@@ -782,7 +844,7 @@ public:
 	}
 
 private:
-	void sendVertex(const Vertex& r)
+	void sendVertex(const N2Vertex& r)
 	{
 		if (dupeNext)
 			ta_add_vertex(r);
@@ -792,7 +854,7 @@ private:
 
 	// Three-Dimensional Homogeneous Clipping of Triangle Strips
 	// Patrick-Gilles Maillot. Graphics Gems II - 1991
-	void clip(const Vertex& r, float rDist)
+	void clip(const N2Vertex& r, float rDist)
 	{
 		clipCode >>= 1;
 		clipCode |= (int)(rDist < 0) << 2;
@@ -834,7 +896,7 @@ private:
 				break;
 			case 3: // P and Q outside, R inside
 				{
-					Vertex tmp = interpolate(r, rDist, p, pDist);
+					N2Vertex tmp = interpolate(r, rDist, p, pDist);
 					sendVertex(tmp);
 					sendVertex(tmp);
 					sendVertex(tmp); // One more to preserve strip swap order
@@ -852,7 +914,7 @@ private:
 				break;
 			case 6: // P inside, Q and R outside
 				{
-					Vertex tmp = interpolate(r, rDist, p, pDist);
+					N2Vertex tmp = interpolate(r, rDist, p, pDist);
 					sendVertex(tmp);
 					sendVertex(tmp);
 					sendVertex(tmp); // One more to preserve strip swap order
@@ -869,9 +931,9 @@ private:
 		qDist = rDist;
 	}
 
-	Vertex interpolate(const Vertex& v1, float f1, const Vertex& v2, float f2)
+	N2Vertex interpolate(const N2Vertex& v1, float f1, const N2Vertex& v2, float f2)
 	{
-		Vertex v;
+		N2Vertex v;
 		float a2 = std::abs(f1) / (std::abs(f1) + std::abs(f2));
 		float a1 = 1 - a2;
 		v.x = v1.x * a1 + v2.x * a2;
@@ -900,9 +962,9 @@ private:
 	bool enabled;
 	int count = 0;
 	int clipCode = 0;
-	Vertex p;
+	N2Vertex p;
 	float pDist = 0;
-	Vertex q;
+	N2Vertex q;
 	float qDist = 0;
 	bool dupeNext = false;
 };
@@ -910,33 +972,41 @@ private:
 template <typename T>
 static void sendVertices(const ICHList *list, const T* vtx, bool needClipping)
 {
-	Vertex taVtx;
+	N2Vertex taVtx;
 	verify(list->vertexSize() > 0);
-
-	Vertex fanCenterVtx{};
-	Vertex fanLastVtx{};
+	ListColors colors;
+	colors.update();
+
+	N2Vertex fanCenterVtx{};
+	N2Vertex fanLastVtx{};
+	float dist = 0.f;
+	float fanCenterDist = 0.f;
+	float fanLastDist = 0.f;
 	bool stripStart = true;
 	int outStripIndex = 0;
 	TriangleStripClipper clipper(needClipping);
 
 	for (u32 i = 0; i < list->vtxCount; i++)
 	{
-		convertVertex(*vtx, taVtx);
+		convertVertex(*vtx, taVtx, colors);
+		if (needClipping)
+			dist = vertexBatch.nearDistance(i);
 
 		if (stripStart)
 		{
 			// Center vertex if triangle fan
 			//verify(vtx->header.isFirstOrSecond()); This fails for some strips: strip=1 fan=0 (soul surfer)
 			fanCenterVtx = taVtx;
+			fanCenterDist = dist;
 			if (outStripIndex > 0)
 			{
 				// use degenerate triangles to link strips
-				clipper.add(fanLastVtx);
-				clipper.add(taVtx);
+				clipper.add(fanLastVtx, fanLastDist);
+				clipper.add(taVtx, dist);
 				outStripIndex += 2;
 				if (outStripIndex & 1)
 				{
-					clipper.add(taVtx);
+					clipper.add(taVtx, dist);
 					outStripIndex++;
 				}
 			}
@@ -945,22 +1015,23 @@ static void sendVertices(const ICHList *list, const T* vtx, bool needClipping)
 		else if (vtx->header.isFan())
 		{
 			// use degenerate triangles to link strips
-			clipper.add(fanLastVtx);
-			clipper.add(fanCenterVtx);
+			clipper.add(fanLastVtx, fanLastDist);
+			clipper.add(fanCenterVtx, fanCenterDist);
 			outStripIndex += 2;
 			if (outStripIndex & 1)
 			{
-				clipper.add(fanCenterVtx);
+				clipper.add(fanCenterVtx, fanCenterDist);
 				outStripIndex++;
 			}
 			// Triangle fan
-			clipper.add(fanCenterVtx);
-			clipper.add(fanLastVtx);
+			clipper.add(fanCenterVtx, fanCenterDist);
+			clipper.add(fanLastVtx, fanLastDist);
 			outStripIndex += 2;
 		}
-		clipper.add(taVtx);
+		clipper.add(taVtx, dist);
 		outStripIndex++;
 		fanLastVtx = taVtx;
+		fanLastDist = dist;
 		if (vtx->header.endOfStrip)
 			stripStart = true;
 
@@ -973,16 +1044,11 @@ class ModifierVolumeClipper
 public:
 	ModifierVolumeClipper(bool enabled) : enabled(enabled) {}
 
-	void add(ModTriangle& tri)
+	// dist: distance of each vertex to the near plane
+	void add(ModTriangle& tri, glm::vec3 dist)
 	{
 		if (enabled)
 		{
-			glm::vec3 dist{
-				tri.x0 * curMatrix[0][2] + tri.y0 * curMatrix[1][2] + tri.z0 * curMatrix[2][2] + curMatrix[3][2],
-				tri.x1 * curMatrix[0][2] + tri.y1 * curMatrix[1][2] + tri.z1 * curMatrix[2][2] + curMatrix[3][2],
-				tri.x2 * curMatrix[0][2] + tri.y2 * curMatrix[1][2] + tri.z2 * curMatrix[2][2] + curMatrix[3][2]
-			};
-			dist = -dist - nearPlane;
 			ModTriangle newTri;
 			int n = sutherlandHodgmanClip(dist, tri, newTri);
 			switch (n)
@@ -1151,7 +1217,15 @@ static void sendMVPolygon(ICHList *list, const T *vtx, bool needClipping)
 			tri.y2 = v.y;
 			tri.z2 = v.z;
 
-			clipper.add(tri);
+			glm::vec3 dist{};
+			if (needClipping)
+			{
+				float dist0 = vertexBatch.nearDistance(i - 2);
+				float dist1 = vertexBatch.nearDistance(i - 1);
+				dist = triIdx & 1 ? glm::vec3(dist1, dist0, vertexBatch.nearDistance(i))
+						: glm::vec3(dist0, dist1, vertexBatch.nearDistance(i));
+			}
+			clipper.add(tri, dist);
 		}
 		if (vtx->header.endOfStrip)
 			stripStart = i + 1;
@@ -1462,16 +1536,53 @@ static void sendPolygon(ICHList *list)
 	envMapping = false;
 }
 
+template<bool Sync = true>
 [[noreturn]] static void raiseError()
 {
 	// no idea if this is correct but it stops initdv2/v3jb sending garbage
-	reg74 |= 0x12;
+	if (Sync)
+		reg74 |= 0x12;
 	throw TAParserException();
 }
 
-template<bool Active = true>
+// Record an ELAN RAM range referenced by the command being walked
+static void recordRange(u32 offset, int size)
+{
+	deferred::Job *job = deferred::recordingJob;
+	if (job == nullptr || size <= 0 || offset >= ERAM_SIZE)
+		return;
+	const u32 usize = std::min((u32)size, ERAM_SIZE - offset);
+	job->ranges.emplace_back(offset, usize);
+	job->data.insert(job->data.end(), &RAM[offset], &RAM[offset + usize]);
+}
+
+// Update the copy of an ELAN RAM range when a command is processed by the SH4 thread
+// while deferred processing is enabled
+static void updateRange(u32 offset, int size)
+{
+	if (!deferred::active || size <= 0 || offset >= ERAM_SIZE)
+		return;
+	const u32 usize = std::min((u32)size, ERAM_SIZE - offset);
+	memcpy(&deferred::shadowRAM[offset], &RAM[offset], usize);
+}
+
+// ELAN RAM offset of a command being walked
+static u32 walkRamAddress(const u8 *p)
+{
+	if (p < RAM || p >= RAM + ERAM_SIZE)
+		return State::Null;
+	else
+		return (u32)(p - RAM);
+}
+
+// Active: process the geometry
+// Sync: perform the side effects visible to the SH4 (interrupts, DMAs and errors)
+template<bool Active = true, bool Sync = true>
 static void executeCommand(u8 *data, int size)
 {
+	// the T&L code uses the copy of the ELAN RAM when deferred processing is enabled
+	u8 * const ram = Active ? geometryRAM() : RAM;
+
 //	verify(size >= 0);
 //	verify(size < (int)ERAM_SIZE);
 //	if (0x2b00 == (u32)(data - RAM))
@@ -1533,6 +1644,15 @@ static void executeCommand(u8 *data, int size)
 						//		INFO_LOG(PVR, "    %08x: %08x", (u32)(&data[i] - RAM), *(u32 *)&data[i]);
 						//}
 					}
+					else if (deferred::walking)
+					{
+						if (instance->id1 & 0x10)
+							deferred::walkState.lightModel = walkRamAddress(data);
+						else if (instance->pcw.parallelLight)
+							deferred::walkState.lights[((ParallelLight *)data)->lightId] = walkRamAddress(data);
+						else
+							deferred::walkState.lights[((PointLight *)data)->lightId] = walkRamAddress(data);
+					}
 					size -= sizeof(LightModel);
 				}
 				break;
@@ -1549,11 +1669,18 @@ static void executeCommand(u8 *data, int size)
 						modelTSP = model->tsp;
 						DEBUG_LOG(PVR, "Model offset %x size %x pcw %08x tsp %08x", model->offset, model->size, model->pcw.full, model->tsp.full);
 					}
-					executeCommand<Active>(&RAM[model->offset & 0x1ffffff8], model->size);
-					cullingReversed = false;
-					openModifierVolume = false;
-					shadowedVolume = false;
-					modelTSP.full = 0;
+					if (!Active)
+						recordRange(model->offset & 0x1ffffff8, model->size);
+					else if (Sync)
+						updateRange(model->offset & 0x1ffffff8, model->size);
+					executeCommand<Active, Sync>(&ram[model->offset & 0x1ffffff8], model->size);
+					if (Active)
+					{
+						cullingReversed = false;
+						openModifierVolume = false;
+						shadowedVolume = false;
+						modelTSP.full = 0;
+					}
 					size -= sizeof(Model);
 				}
 				break;
@@ -1587,15 +1714,27 @@ static void executeCommand(u8 *data, int size)
 							WARN_LOG(PVR, "Unknown interrupt mask %x", wait->mask);
 							// initdv2j: happens at end of race, garbage data after end of model due to wrong size?
 							//die("unexpected");
-							raiseError();
+							raiseError<Sync>();
 							break;
 						}
 						if (inter != (HollyInterruptID)-1)
 						{
-							asic_RaiseInterruptBothCLX(inter);
-							TA_ITP_CURRENT += 32;
+							if (Sync)
+							{
+								asic_RaiseInterruptBothCLX(inter);
+								TA_ITP_CURRENT += 32;
+							}
+							else if (!Active)
+								deferred::sideEffects = true;
 							if (Active)
 								state.reset();
+							else if (deferred::walking)
+							{
+								deferred::walkState.gmp = State::Null;
+								deferred::walkState.lightModel = State::Null;
+								for (u32& light : deferred::walkState.lights)
+									light = State::Null;
+							}
 						}
 					}
 					size -= sizeof(RegisterWait);
@@ -1611,7 +1750,15 @@ static void executeCommand(u8 *data, int size)
 						if (link->size > VRAM_SIZE)
 						{
 							WARN_LOG(PVR, "Texture DMA from %x to %x (%x invalid)", DMAC_SAR(2), link->vramAddress & 0x1ffffff8, link->size);
-							raiseError();
+							raiseError<Sync>();
+						}
+						if (!Sync)
+						{
+							// done by the SH4 thread
+							if (!Active)
+								deferred::sideEffects = true;
+							size -= sizeof(Link);
+							break;
 						}
 						DEBUG_LOG(PVR, "Texture DMA from %x to %x (%x) %s", DMAC_SAR(2), link->vramAddress & 0x1ffffff8, link->size,
 								data >= (u8 *)elanCmd && data < (u8 *)elanCmd + sizeof(elanCmd) ? "CMD" : "ERAM");
@@ -1626,7 +1773,15 @@ static void executeCommand(u8 *data, int size)
 						if (link->size > VRAM_SIZE)
 						{
 							WARN_LOG(PVR, "Texture DMA from eram %x -> %x (%x invalid)", link->offset & ELAN_RAM_MASK, link->vramAddress & VRAM_MASK, link->size);
-							raiseError();
+							raiseError<Sync>();
+						}
+						if (!Sync)
+						{
+							// done by the SH4 thread
+							if (!Active)
+								deferred::sideEffects = true;
+							size -= sizeof(Link);
+							break;
 						}
 						DEBUG_LOG(PVR, "Texture DMA from eram %x -> %x (%x) %s", link->offset & ELAN_RAM_MASK, link->vramAddress & VRAM_MASK, link->size,
 								data >= (u8 *)elanCmd && data < (u8 *)elanCmd + sizeof(elanCmd) ? "CMD" : "ERAM");
@@ -1636,7 +1791,11 @@ static void executeCommand(u8 *data, int size)
 					else
 					{
 						DEBUG_LOG(PVR, "Link to %8x (%x)", link->offset, link->size);
-						executeCommand<Active>(&RAM[link->offset & ELAN_RAM_MASK], link->size);
+						if (!Active)
+							recordRange(link->offset & ELAN_RAM_MASK, link->size);
+						else if (Sync)
+							updateRange(link->offset & ELAN_RAM_MASK, link->size);
+						executeCommand<Active, Sync>(&ram[link->offset & ELAN_RAM_MASK], link->size);
 					}
 					size -= sizeof(Link);
 				}
@@ -1645,6 +1804,8 @@ static void executeCommand(u8 *data, int size)
 			case PCW::gmp:
 				if (Active)
 					state.setGMP(data);
+				else if (deferred::walking)
+					deferred::walkState.gmp = walkRamAddress(data);
 				size -= sizeof(GMP);
 				break;
 
@@ -1656,13 +1817,16 @@ static void executeCommand(u8 *data, int size)
 						DEBUG_LOG(PVR, "ICH flags %x, %d verts", ich->flags, ich->vtxCount);
 						sendPolygon(ich);
 					}
+					else if (deferred::walking && deferred::walkState.listType == -1)
+						// the polygon starts a list unless it's culled
+						deferred::walkState.listType = deferred::UnknownList;
 					size -= sizeof(ICHList) + ich->vertexSize() * ich->vtxCount;
 				}
 				break;
 
 			default:
 				WARN_LOG(PVR, "Unhandled Elan command %x", cmd->pcw.n2Command);
-				raiseError();
+				raiseError<Sync>();
 				break;
 			}
 		}
@@ -1675,13 +1839,14 @@ static void executeCommand(u8 *data, int size)
 				try {
 					size -= ta_add_ta_data((u32 *)data, size);
 				} catch (const TAParserException& e) {
-					raiseError();
+					raiseError<Sync>();
 				}
 			}
 			else
 			{
-				u32 vertexSize = 32;
-				int listType = ta_get_list_type();
+				// the TA parser may be in use by the worker thread
+				u32 vertexSize = deferred::walking ? deferred::walkState.vertexSize : 32;
+				int listType = deferred::walking ? deferred::walkState.listType : ta_get_list_type();
 				int i = 0;
 				while (i < size)
 				{
@@ -1702,8 +1867,21 @@ static void executeCommand(u8 *data, int size)
 						{
 							static const u32 * const PolyTypeLut = TaTypeLut::instance().table;
 
+							if (listType == deferred::UnknownList)
+							{
+								deferred::needSync = true;
+								raiseError<false>();
+							}
 							if (listType == -1)
+							{
+								if (pcw.listType > ListType_Punch_Through)
+								{
+									// invalid list type, ignored by the TA parser
+									i += 32;
+									break;
+								}
 								listType = pcw.listType;
+							}
 							if (listType & 1)
 							{
 								// modifier volumes
@@ -1713,6 +1891,11 @@ static void executeCommand(u8 *data, int size)
 							else
 							{
 								u32 polyId = PolyTypeLut[pcw.objectControl];
+								if (polyId == TaTypeLut::INVALID_TYPE)
+								{
+									i += 32;
+									break;
+								}
 								u32 polySize = polyId >> 30;
 								u32 vertexType = (u8)polyId;
 								if (vertexType == 5 || vertexType == 6 || (vertexType >= 11 && vertexType <= 14))
@@ -1724,27 +1907,293 @@ static void executeCommand(u8 *data, int size)
 						}
 						break;
 					case ParamType_Sprite:
+						if (listType == deferred::UnknownList)
+						{
+							deferred::needSync = true;
+							raiseError<false>();
+						}
 						if (listType == -1)
+						{
+							if (pcw.listType > ListType_Punch_Through)
+							{
+								i += 32;
+								break;
+							}
 							listType = pcw.listType;
+						}
 						vertexSize = 64;
 						i += 32;
 						break;
 					case ParamType_Vertex_Parameter:
+						if (vertexSize == 0)
+						{
+							deferred::needSync = true;
+							raiseError<false>();
+						}
 						i += vertexSize;
 						break;
 					default:
 						WARN_LOG(PVR, "Invalid param type %d", pcw.paraType);
-						raiseError();
+						raiseError<Sync>();
 						break;
 					}
 				}
 				size -= i;
+				if (deferred::walking)
+				{
+					deferred::walkState.listType = listType;
+					deferred::walkState.vertexSize = vertexSize;
+				}
 			}
 		}
 		data += oldSize - size;
 	}
 }
 
+namespace deferred
+{
+
+static void *workerThread(void *)
+{
+	std::unique_lock<std::mutex> lock(mutex);
+	for (;;)
+	{
+		jobQueued.wait(lock, []() { return !jobs.empty() || stopping; });
+		if (jobs.empty())
+			break;
+		Job& job = jobs.front();
+		lock.unlock();
+
+		const auto start = std::chrono::steady_clock::now();
+		const u8 *data = job.data.data();
+		for (const auto& range : job.ranges)
+		{
+			memcpy(&shadowRAM[range.first], data, range.second);
+			data += range.second;
+		}
+		try {
+			executeCommand<true, false>((u8 *)job.cmd, sizeof(job.cmd));
+		} catch (const TAParserException& e) {
+			// the error has been raised by the SH4 command walk
+		}
+		const u64 busyTime = std::chrono::duration_cast<std::chrono::microseconds>(
+				std::chrono::steady_clock::now() - start).count();
+
+		lock.lock();
+		stats.busyTime += busyTime;
+		stats.commands++;
+		freeJobs.push_back(std::move(job));
+		jobs.pop_front();
+		if (jobs.empty())
+			jobsDone.notify_all();
+	}
+	return nullptr;
+}
+
+static cThread thread(workerThread, nullptr, "ElanWorker");
+
+static void wait()
+{
+	if (pending)
+	{
+		std::unique_lock<std::mutex> lock(mutex);
+		if (!jobs.empty())
+		{
+			const auto start = std::chrono::steady_clock::now();
+			jobsDone.wait(lock, []() { return jobs.empty(); });
+			stats.waitTime += std::chrono::duration_cast<std::chrono::microseconds>(
+					std::chrono::steady_clock::now() - start).count();
+		}
+		pending = false;
+	}
+	// the TA parser state may be changed by the caller
+	walkState.listType = -2;
+	walkState.vertexSize = 0;
+}
+
+// Only called when the worker thread is idle
+static void readWalkState()
+{
+	walkState.listType = -2;
+	walkState.vertexSize = 0;
+	walkState.gmp = state.gmp;
+	walkState.lightModel = state.lightModel;
+	memcpy(walkState.lights, state.lights, sizeof(walkState.lights));
+}
+
+// Moves the T&L state pointers from one copy of the ELAN RAM to the other
+template<typename T>
+static void rebase(T *&p, const u8 *from, u8 *to)
+{
+	if (p != nullptr)
+		p = (T *)(to + ((const u8 *)p - from));
+}
+
+static void rebaseState(const u8 *from, u8 *to)
+{
+	rebase(curGmp, from, to);
+	rebase(curLightModel, from, to);
+	for (ElanBase *&light : curLights)
+		rebase(light, from, to);
+}
+
+static void disable()
+{
+	if (!active)
+		return;
+	wait();
+	rebaseState(shadowRAM.data(), RAM);
+	active = false;
+	DEBUG_LOG(PVR, "Deferred ELAN processing disabled");
+}
+
+static void stop()
+{
+	disable();
+	if (thread.thread.joinable())
+	{
+		{
+			std::lock_guard<std::mutex> _(mutex);
+			stopping = true;
+		}
+		jobQueued.notify_one();
+		thread.WaitToEnd();
+		stopping = false;
+	}
+	shadowRAM.clear();
+	shadowRAM.shrink_to_fit();
+	freeJobs.clear();
+}
+
+// Deferred processing isn't deterministic enough for rollback netplay
+static bool enabled()
+{
+	const bool enable = config::DeferredElan && !ggpo::active();
+	if (enable == active)
+		return active;
+	if (!enable) {
+		disable();
+		return false;
+	}
+	shadowRAM.resize(ERAM_SIZE);
+	memcpy(shadowRAM.data(), RAM, ERAM_SIZE);
+	if (!thread.thread.joinable())
+		thread.Start();
+	rebaseState(RAM, shadowRAM.data());
+	readWalkState();
+	active = true;
+	DEBUG_LOG(PVR, "Deferred ELAN processing enabled");
+
+	return true;
+}
+
+// Record the ranges of the GMP, light model and lights read when drawing polygons
+static void recordState(void (*record)(u32 offset, int size))
+{
+	if (walkState.gmp != State::Null)
+		record(walkState.gmp, sizeof(GMP));
+	if (walkState.lightModel != State::Null)
+		record(walkState.lightModel, sizeof(LightModel));
+	for (u32 light : walkState.lights)
+		if (light != State::Null)
+			record(light, std::max(sizeof(PointLight), sizeof(ParallelLight)));
+}
+
+// Process the command on the SH4 thread when its outcome can't be predicted by the walk
+static void executeSync()
+{
+	wait();
+	readWalkState();
+	recordState(updateRange);
+	bool error = false;
+	try {
+		executeCommand<true>((u8 *)elanCmd, sizeof(elanCmd));
+	} catch (const TAParserException& e) {
+		error = true;
+	}
+	readWalkState();
+	if (error)
+		throw TAParserException();
+}
+
+static void execute()
+{
+	Job job;
+	{
+		std::lock_guard<std::mutex> _(mutex);
+		if (!freeJobs.empty())
+		{
+			job = std::move(freeJobs.back());
+			freeJobs.pop_back();
+		}
+	}
+	memcpy(job.cmd, elanCmd, sizeof(job.cmd));
+	job.ranges.clear();
+	job.data.clear();
+	// Only read when the worker thread is idle
+	if (walkState.listType == -2)
+		walkState.listType = ta_get_list_type();
+
+	// The walk has no side effects so that it can be abandoned
+	const WalkState startState = walkState;
+	recordingJob = &job;
+	walking = true;
+	sideEffects = false;
+	needSync = false;
+	recordState(recordRange);
+	bool error = false;
+	try {
+		executeCommand<false, false>((u8 *)job.cmd, sizeof(job.cmd));
+	} catch (const TAParserException& e) {
+		// the worker thread will stop at the same point
+		error = true;
+	}
+	recordingJob = nullptr;
+	if (needSync)
+	{
+		walking = false;
+		{
+			std::lock_guard<std::mutex> _(mutex);
+			freeJobs.push_back(std::move(job));
+		}
+		executeSync();
+		return;
+	}
+	{
+		std::lock_guard<std::mutex> _(mutex);
+		jobs.push_back(std::move(job));
+	}
+	pending = true;
+	jobQueued.notify_one();
+
+	if (sideEffects || error)
+	{
+		// Walk the command again to raise the interrupts, start the DMAs and raise the error
+		walkState = startState;
+		try {
+			executeCommand<false, true>((u8 *)elanCmd, sizeof(elanCmd));
+		} catch (const TAParserException& e) {
+			walking = false;
+			throw;
+		}
+	}
+	walking = false;
+}
+
+}
+
+void sync()
+{
+	if (deferred::active)
+		deferred::wait();
+}
+
+DeferredStats getDeferredStats()
+{
+	std::lock_guard<std::mutex> _(deferred::mutex);
+	return deferred::stats;
+}
+
 static void DYNACALL write_elancmd(u32 addr, u32 data)
 {
 //	DEBUG_LOG(PVR, "ELAN cmd %08x = %x", addr, data);
@@ -1754,10 +2203,12 @@ static void DYNACALL write_elancmd(u32 addr, u32 data)
 	if (addr == 7)
 	{
 		try {
-			if (!ggpo::rollbacking())
-				executeCommand<true>((u8 *)elanCmd, sizeof(elanCmd));
-			else
+			if (ggpo::rollbacking())
 				executeCommand<false>((u8 *)elanCmd, sizeof(elanCmd));
+			else if (deferred::enabled())
+				deferred::execute();
+			else
+				executeCommand<true>((u8 *)elanCmd, sizeof(elanCmd));
 			if (!sh4_sched_is_scheduled(schedId))
 				reg74 |= 2;
 		} catch (const TAParserException& e) {
@@ -1792,6 +2243,7 @@ void init()
 
 void reset(bool hard)
 {
+	deferred::disable();
 	if (hard)
 	{
 		memset(RAM, 0, ERAM_SIZE);
@@ -1802,6 +2254,7 @@ void reset(bool hard)
 
 void term()
 {
+	deferred::stop();
 	if (schedId != -1) {
 		sh4_sched_unregister(schedId);
 		schedId = -1;
@@ -1842,6 +2295,8 @@ void deserialize(Deserializer& deser)
 {
 	if (!settings.platform.isNaomi2())
 		return;
+	// re-enabled with a fresh copy of the ELAN RAM on the next command
+	deferred::disable();
 	deser >> reg10;
 	deser >> reg74;
 	deser >> elanCmd;
@@ -31,6 +31,17 @@ void vmem_map(u32 base);
 void serialize(Serializer& ser);
 void deserialize(Deserializer& deser);
 
+// Wait until all deferred ELAN commands have been processed
+void sync();
+
+struct DeferredStats
+{
+	u64 busyTime;	// total time spent by the worker thread processing commands, in microseconds
+	u64 waitTime;	// total time the emulator waited for the worker thread, in microseconds
+	u32 commands;	// total number of commands processed by the worker thread
+};
+DeferredStats getDeferredStats();
+
 extern u8 *RAM;
 extern u32 ERAM_SIZE;
 constexpr u32 ERAM_SIZE_MAX = 32_MB;
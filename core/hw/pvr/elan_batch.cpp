@@ -0,0 +1,167 @@
+/*
+	This file is part of Flycast.
+
+    Flycast is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 2 of the License, or
+    (at your option) any later version.
+
+    Flycast is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Flycast.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#include "elan_batch.h"
+
+#if HOST_CPU == CPU_X64 || (HOST_CPU == CPU_X86 && defined(__SSE2__))
+#include <emmintrin.h>
+#elif HOST_CPU == CPU_ARM64 || (HOST_CPU == CPU_ARM && defined(__ARM_NEON__))
+#include <arm_neon.h>
+#endif
+
+namespace elan {
+
+#if HOST_CPU == CPU_X64 || (HOST_CPU == CPU_X86 && defined(__SSE2__))
+
+static float hmin(__m128 v)
+{
+	// Lanes are never NaN here
+	v = _mm_min_ps(v, _mm_shuffle_ps(v, v, _MM_SHUFFLE(1, 0, 3, 2)));
+	v = _mm_min_ps(v, _mm_shuffle_ps(v, v, _MM_SHUFFLE(2, 3, 0, 1)));
+	return _mm_cvtss_f32(v);
+}
+
+static float hmax(__m128 v)
+{
+	v = _mm_max_ps(v, _mm_shuffle_ps(v, v, _MM_SHUFFLE(1, 0, 3, 2)));
+	v = _mm_max_ps(v, _mm_shuffle_ps(v, v, _MM_SHUFFLE(2, 3, 0, 1)));
+	return _mm_cvtss_f32(v);
+}
+
+void VertexBatch::boundingBox(glm::vec3& min, glm::vec3& max) const
+{
+	__m128 minX = _mm_set1_ps(1e38f);
+	__m128 minY = minX;
+	__m128 minZ = minX;
+	__m128 maxX = _mm_set1_ps(-1e38f);
+	__m128 maxY = maxX;
+	__m128 maxZ = maxX;
+	// minps/maxps return the second operand if either one is NaN
+	for (u32 i = 0; i < count; i += 4)
+	{
+		__m128 vx = _mm_loadu_ps(&x[i]);
+		__m128 vy = _mm_loadu_ps(&y[i]);
+		__m128 vz = _mm_loadu_ps(&z[i]);
+		minX = _mm_min_ps(vx, minX);
+		minY = _mm_min_ps(vy, minY);
+		minZ = _mm_min_ps(vz, minZ);
+		maxX = _mm_max_ps(vx, maxX);
+		maxY = _mm_max_ps(vy, maxY);
+		maxZ = _mm_max_ps(vz, maxZ);
+	}
+	min = { hmin(minX), hmin(minY), hmin(minZ) };
+	max = { hmax(maxX), hmax(maxY), hmax(maxZ) };
+}
+
+void VertexBatch::computeNearDistances(const glm::mat4& modelView, float nearPlane)
+{
+	const __m128 m0 = _mm_set1_ps(modelView[0][2]);
+	const __m128 m1 = _mm_set1_ps(modelView[1][2]);
+	const __m128 m2 = _mm_set1_ps(modelView[2][2]);
+	const __m128 m3 = _mm_set1_ps(modelView[3][2]);
+	const __m128 vnear = _mm_set1_ps(nearPlane);
+	const __m128 sign = _mm_set1_ps(-0.f);
+	for (u32 i = 0; i < count; i += 4)
+	{
+		__m128 vz = _mm_add_ps(_mm_add_ps(_mm_add_ps(
+				_mm_mul_ps(_mm_loadu_ps(&x[i]), m0),
+				_mm_mul_ps(_mm_loadu_ps(&y[i]), m1)),
+				_mm_mul_ps(_mm_loadu_ps(&z[i]), m2)),
+				m3);
+		_mm_storeu_ps(&dist[i], _mm_sub_ps(_mm_xor_ps(vz, sign), vnear));
+	}
+}
+
+#elif HOST_CPU == CPU_ARM64 || (HOST_CPU == CPU_ARM && defined(__ARM_NEON__))
+
+static float hmin(float32x4_t v)
+{
+	float32x2_t h = vpmin_f32(vget_low_f32(v), vget_high_f32(v));
+	return vget_lane_f32(vpmin_f32(h, h), 0);
+}
+
+static float hmax(float32x4_t v)
+{
+	float32x2_t h = vpmax_f32(vget_low_f32(v), vget_high_f32(v));
+	return vget_lane_f32(vpmax_f32(h, h), 0);
+}
+
+void VertexBatch::boundingBox(glm::vec3& min, glm::vec3& max) const
+{
+	float32x4_t minX = vdupq_n_f32(1e38f);
+	float32x4_t minY = minX;
+	float32x4_t minZ = minX;
+	float32x4_t maxX = vdupq_n_f32(-1e38f);
+	float32x4_t maxY = maxX;
+	float32x4_t maxZ = maxX;
+	// vminq/vmaxq propagate NaN so compare and select instead
+	for (u32 i = 0; i < count; i += 4)
+	{
+		float32x4_t vx = vld1q_f32(&x[i]);
+		float32x4_t vy = vld1q_f32(&y[i]);
+		float32x4_t vz = vld1q_f32(&z[i]);
+		minX = vbslq_f32(vcltq_f32(vx, minX), vx, minX);
+		minY = vbslq_f32(vcltq_f32(vy, minY), vy, minY);
+		minZ = vbslq_f32(vcltq_f32(vz, minZ), vz, minZ);
+		maxX = vbslq_f32(vcgtq_f32(vx, maxX), vx, maxX);
+		maxY = vbslq_f32(vcgtq_f32(vy, maxY), vy, maxY);
+		maxZ = vbslq_f32(vcgtq_f32(vz, maxZ), vz, maxZ);
+	}
+	min = { hmin(minX), hmin(minY), hmin(minZ) };
+	max = { hmax(maxX), hmax(maxY), hmax(maxZ) };
+}
+
+void VertexBatch::computeNearDistances(const glm::mat4& modelView, float nearPlane)
+{
+	const float32x4_t vnear = vdupq_n_f32(nearPlane);
+	for (u32 i = 0; i < count; i += 4)
+	{
+		// separate multiplies and adds to get the same results as the scalar code
+		float32x4_t vz = vaddq_f32(vaddq_f32(vaddq_f32(
+				vmulq_n_f32(vld1q_f32(&x[i]), modelView[0][2]),
+				vmulq_n_f32(vld1q_f32(&y[i]), modelView[1][2])),
+				vmulq_n_f32(vld1q_f32(&z[i]), modelView[2][2])),
+				vdupq_n_f32(modelView[3][2]));
+		vst1q_f32(&dist[i], vsubq_f32(vnegq_f32(vz), vnear));
+	}
+}
+
+#else
+
+void VertexBatch::boundingBox(glm::vec3& min, glm::vec3& max) const
+{
+	min = { 1e38f, 1e38f, 1e38f };
+	max = { -1e38f, -1e38f, -1e38f };
+	for (u32 i = 0; i < count; i++)
+	{
+		glm::vec3 pos{ x[i], y[i], z[i] };
+		min = glm::min(min, pos);
+		max = glm::max(max, pos);
+	}
+}
+
+void VertexBatch::computeNearDistances(const glm::mat4& modelView, float nearPlane)
+{
+	for (u32 i = 0; i < count; i++)
+	{
+		float vz = x[i] * modelView[0][2] + y[i] * modelView[1][2] + z[i] * modelView[2][2] + modelView[3][2];
+		dist[i] = -vz - nearPlane;
+	}
+}
+
+#endif
+
+}
@@ -0,0 +1,83 @@
+/*
+	This file is part of Flycast.
+
+    Flycast is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 2 of the License, or
+    (at your option) any later version.
+
+    Flycast is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Flycast.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#pragma once
+#include "types.h"
+#include <glm/glm.hpp>
+#include <vector>
+
+namespace elan {
+
+//
+// Positions of the vertices of an ICH list gathered in SoA form,
+// so that they can be culled and clipped 4 vertices at a time.
+//
+class VertexBatch
+{
+public:
+	template<typename T>
+	void gather(const T *vertices, u32 count)
+	{
+		this->count = count;
+		if (count == 0)
+			return;
+		// Pad to a multiple of 4 with the last vertex
+		const u32 size = (count + 3) & ~3;
+		if (x.size() < size)
+		{
+			x.resize(size);
+			y.resize(size);
+			z.resize(size);
+			dist.resize(size);
+		}
+		for (u32 i = 0; i < count; i++)
+		{
+			x[i] = vertices[i].x;
+			y[i] = vertices[i].y;
+			z[i] = vertices[i].z;
+		}
+		for (u32 i = count; i < size; i++)
+		{
+			x[i] = x[count - 1];
+			y[i] = y[count - 1];
+			z[i] = z[count - 1];
+		}
+	}
+
+	// Model space bounding box. NaN coordinates are ignored.
+	void boundingBox(glm::vec3& min, glm::vec3& max) const;
+
+	// Compute the view space distance of each vertex to the near plane.
+	// The distance is negative if the vertex is in front of the near plane.
+	void computeNearDistances(const glm::mat4& modelView, float nearPlane);
+
+	float nearDistance(u32 index) const {
+		return dist[index];
+	}
+
+	u32 size() const {
+		return count;
+	}
+
+private:
+	std::vector<float> x;
+	std::vector<float> y;
+	std::vector<float> z;
+	std::vector<float> dist;
+	u32 count = 0;
+};
+
+}
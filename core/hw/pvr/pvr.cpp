@@ -39,6 +39,8 @@ namespace pvr
 
 void reset(bool hard)
 {
+	// the ELAN worker thread may be using the current TA context
+	elan::sync();
 	KillTex = true;
 	Regs_Reset(hard);
 	spg_Reset(hard);
@@ -62,6 +64,7 @@ void init()
 
 void term()
 {
+	elan::sync();
 	tactx_Term();
 	spg_Term();
 	elan::term();
@@ -69,6 +72,7 @@ void term()
 
 void serialize(Serializer& ser)
 {
+	elan::sync();
 	YUV_serialize(ser);
 
 	ser << pvr_regs;
@@ -89,6 +93,7 @@ void serialize(Serializer& ser)
 
 void deserialize(Deserializer& deser)
 {
+	elan::sync();
 	YUV_deserialize(deser);
 
 	deser >> pvr_regs;
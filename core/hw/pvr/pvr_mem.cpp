@@ -10,6 +10,14 @@
 #include "hw/holly/sb.h"
 #include "hw/holly/holly_intc.h"
 #include "serialize.h"
+#include "rend/TexCache.h"
+#include "profiler/fc_profiler.h"
+
+#if HOST_CPU == CPU_X64 || (HOST_CPU == CPU_X86 && defined(__SSE2__))
+#include <emmintrin.h>
+#elif HOST_CPU == CPU_ARM64 || (HOST_CPU == CPU_ARM && defined(__ARM_NEON__))
+#include <arm_neon.h>
+#endif
 
 static u32 pvr_map32(u32 offset32);
 
@@ -47,52 +55,62 @@ void YUV_init()
 	YUV_index = 0;
 }
 
-static void YUV_Block8x8(const u8* inuv, const u8* iny, u8* out)
+// Converts one row of 16 pixels of a macro block.
+// u and v point to 8 chroma samples, y0 and y1 to the 8 luma samples of the left and right 8x8 blocks.
+// Output is UYVY.
+static inline void YUV_Row16Scalar(const u8 *u, const u8 *v, const u8 *y0, const u8 *y1, u8 *out)
 {
-	u8* line_out_0=out+0;
-	u8* line_out_1=out+YUV_x_size*2;
-
-	for (int y=0;y<8;y+=2)
+	for (int x = 0; x < 4; x++)
 	{
-		for (int x=0;x<8;x+=2)
-		{
-			u8 u=inuv[0];
-			u8 v=inuv[64];
-
-			line_out_0[0]=u;
-			line_out_0[1]=iny[0];
-			line_out_0[2]=v;
-			line_out_0[3]=iny[1];
-
-			line_out_1[0]=u;
-			line_out_1[1]=iny[8+0];
-			line_out_1[2]=v;
-			line_out_1[3]=iny[8+1];
+		out[x * 4 + 0] = u[x];
+		out[x * 4 + 1] = y0[x * 2];
+		out[x * 4 + 2] = v[x];
+		out[x * 4 + 3] = y0[x * 2 + 1];
+
+		out[x * 4 + 16] = u[x + 4];
+		out[x * 4 + 17] = y1[x * 2];
+		out[x * 4 + 18] = v[x + 4];
+		out[x * 4 + 19] = y1[x * 2 + 1];
+	}
+}
 
-			inuv+=1;
-			iny+=2;
+static inline void YUV_Row16(const u8 *u, const u8 *v, const u8 *y0, const u8 *y1, u8 *out)
+{
+#if HOST_CPU == CPU_X64 || (HOST_CPU == CPU_X86 && defined(__SSE2__))
+	__m128i uv = _mm_unpacklo_epi8(_mm_loadl_epi64((const __m128i *)u), _mm_loadl_epi64((const __m128i *)v));
+	__m128i y = _mm_unpacklo_epi64(_mm_loadl_epi64((const __m128i *)y0), _mm_loadl_epi64((const __m128i *)y1));
+	_mm_storeu_si128((__m128i *)out, _mm_unpacklo_epi8(uv, y));
+	_mm_storeu_si128((__m128i *)(out + 16), _mm_unpackhi_epi8(uv, y));
+#elif HOST_CPU == CPU_ARM64 || (HOST_CPU == CPU_ARM && defined(__ARM_NEON__))
+	uint8x8x2_t uv = vzip_u8(vld1_u8(u), vld1_u8(v));
+	uint8x8x2_t left = { { uv.val[0], vld1_u8(y0) } };
+	uint8x8x2_t right = { { uv.val[1], vld1_u8(y1) } };
+	vst2_u8(out, left);
+	vst2_u8(out + 16, right);
+#else
+	YUV_Row16Scalar(u, v, y0, y1, out);
+#endif
+}
 
-			line_out_0+=4;
-			line_out_1+=4;
-		}
-		iny+=8;
-		inuv+=4;
+// Input: U (8x8), V (8x8) then Y as four 8x8 blocks (top left, top right, bottom left, bottom right)
+template<void (*Row16)(const u8 *, const u8 *, const u8 *, const u8 *, u8 *)>
+static void YUV_Block384(const u8 *in, u8 *out, u32 stride)
+{
+	const u8 *inu = in;
+	const u8 *inv = in + 64;
+	const u8 *iny = in + 128;
 
-		line_out_0+=YUV_x_size*4-8*2;
-		line_out_1+=YUV_x_size*4-8*2;
+	for (int y = 0; y < 16; y++)
+	{
+		const u8 *yrow = iny + (y & 8) * 16 + (y & 7) * 8;
+		Row16(inu + (y / 2) * 8, inv + (y / 2) * 8, yrow, yrow + 64, out);
+		out += stride;
 	}
 }
 
-static void YUV_Block384(const u8 *in, u8 *out)
+void YUV_Block384Scalar(const u8 *in, u8 *out, u32 stride)
 {
-	const u8 *inuv = in;
-	const u8 *iny = in + 128;
-	u8* p_out = out;
-
-	YUV_Block8x8(inuv+ 0,iny+  0,p_out);                    //(0,0)
-	YUV_Block8x8(inuv+ 4,iny+64,p_out+8*2);                 //(8,0)
-	YUV_Block8x8(inuv+32,iny+128,p_out+YUV_x_size*8*2);     //(0,8)
-	YUV_Block8x8(inuv+36,iny+192,p_out+YUV_x_size*8*2+8*2); //(8,8)
+	YUV_Block384<YUV_Row16Scalar>(in, out, stride);
 }
 
 static void YUV_ConvertMacroBlock(const u8 *datap)
@@ -100,7 +118,7 @@ static void YUV_ConvertMacroBlock(const u8 *datap)
 	//do shit
 	TA_YUV_TEX_CNT++;
 
-	YUV_Block384(datap, &vram[YUV_dest]);
+	YUV_Block384<YUV_Row16>(datap, &vram[YUV_dest], YUV_x_size * 2);
 
 	YUV_dest+=32;
 
@@ -238,6 +256,108 @@ template void pvr_write32p<u8>(u32 addr, u8 data);
 template void pvr_write32p<u16>(u32 addr, u16 data);
 template void pvr_write32p<u32>(u32 addr, u32 data);
 
+#define VRAM_BANK_BIT 0x400000
+
+// Number of 32-bit words at addr that are contiguous in the same bank
+static u32 bankRun(u32 addr, u32 size)
+{
+	return std::min(size / 4, (VRAM_BANK_BIT - (addr & (VRAM_BANK_BIT - 1))) / 4);
+}
+
+void pvr_read32_block(u32 addr, u8 *data, u32 size)
+{
+	if (addr & 2)
+	{
+		*(u16 *)data = pvr_read32p<u16>(addr);
+		addr += 2;
+		data += 2;
+		size -= 2;
+	}
+	while (size >= 4)
+	{
+		// 32-bit words of a bank are 8 bytes apart in the 64-bit area
+		const u32 words = bankRun(addr, size);
+		const u32 *src = (const u32 *)&vram[pvr_map32(addr)];
+		for (u32 i = 0; i < words; i++, data += 4)
+			memcpy(data, &src[i * 2], 4);
+		addr += words * 4;
+		size -= words * 4;
+	}
+	if (size != 0)
+		*(u16 *)data = pvr_read32p<u16>(addr);
+}
+
+void pvr_write32_block(u32 addr, const u8 *data, u32 size)
+{
+	const u32 vaddr = addr & VRAM_MASK;
+	if (vaddr < fb_watch_addr_end && vaddr + size > fb_watch_addr_start)
+		fb_dirty = true;
+	if (addr & 2)
+	{
+		pvr_write32p(addr, *(const u16 *)data);
+		addr += 2;
+		data += 2;
+		size -= 2;
+	}
+	while (size >= 4)
+	{
+		const u32 words = bankRun(addr, size);
+		VramLockedWriteRange(pvr_map32(addr), words * 8);
+		u32 *dst = (u32 *)&vram[pvr_map32(addr)];
+		for (u32 i = 0; i < words; i++, data += 4)
+			memcpy(&dst[i * 2], data, 4);
+		addr += words * 4;
+		size -= words * 4;
+	}
+	if (size != 0)
+		pvr_write32p(addr, *(const u16 *)data);
+}
+
+// Number of bytes above which vram is written with non-temporal stores.
+// Textures are only read again when the renderer uploads them.
+constexpr u32 VRAM_STREAM_COPY_MIN = 64 * 1024;
+
+static void vram_copy(u8 *dst, const u8 *src, u32 size)
+{
+#if HOST_CPU == CPU_X64 || (HOST_CPU == CPU_X86 && defined(__SSE2__))
+	if (size >= VRAM_STREAM_COPY_MIN && ((uintptr_t)dst & 15) == 0)
+	{
+		const u32 count = size / 16;
+		__m128i *d = (__m128i *)dst;
+		const __m128i *s = (const __m128i *)src;
+		for (u32 i = 0; i < count; i++)
+			_mm_stream_si128(&d[i], _mm_loadu_si128(&s[i]));
+		_mm_sfence();
+		dst += count * 16;
+		src += count * 16;
+		size -= count * 16;
+	}
+#endif
+	memcpy(dst, src, size);
+}
+
+void pvr_write_block(u32 addr, const u8 *data, u32 size)
+{
+	FC_PROFILE_BYTES("VRAM DMA", size);
+	if (addr & 0x01000000)
+	{
+		// 32-bit path
+		pvr_write32_block(addr, data, size);
+		return;
+	}
+	// 64-bit path
+	while (size > 0)
+	{
+		const u32 offset = addr & VRAM_MASK;
+		const u32 chunk = std::min(size, VRAM_SIZE - offset);
+		VramLockedWriteRange(offset, chunk);
+		vram_copy(&vram[offset], data, chunk);
+		addr += chunk;
+		data += chunk;
+		size -= chunk;
+	}
+}
+
 void DYNACALL TAWrite(u32 address, const SQBuffer *data, u32 count)
 {
 	if ((address & 0x800000) == 0)
@@ -283,8 +403,6 @@ void DYNACALL TAWriteSQ(u32 address, const SQBuffer *sqb)
 
 //Misc interface
 
-#define VRAM_BANK_BIT 0x400000
-
 static u32 pvr_map32(u32 offset32)
 {
 	//64b wide bus is achieved by interleaving the banks every 32 bits
@@ -14,6 +14,8 @@ void DYNACALL TAWrite(u32 address, const SQBuffer *data, u32 count);
 void DYNACALL TAWriteSQ(u32 address, const SQBuffer *sqb);
 
 void YUV_init();
+// Converts a 384-byte macro block to UYVY with the portable code used when SIMD isn't available
+void YUV_Block384Scalar(const u8 *in, u8 *out, u32 stride);
 void YUV_serialize(Serializer& ser);
 void YUV_deserialize(Deserializer& deser);
 void YUV_reset();
@@ -21,6 +23,12 @@ void YUV_reset();
 // 32-bit vram path handlers
 template<typename T> T DYNACALL pvr_read32p(u32 addr);
 template<typename T> void DYNACALL pvr_write32p(u32 addr, T data);
+// Copy a range of the 32-bit vram area. addr and size must be 16-bit aligned.
+void pvr_read32_block(u32 addr, u8 *data, u32 size);
+void pvr_write32_block(u32 addr, const u8 *data, u32 size);
+// DMA from host memory to vram. addr is in area 1: 64-bit path, or 32-bit path if bit 24 is set.
+// Textures are invalidated once for the whole range, and large transfers bypass the host cache.
+void pvr_write_block(u32 addr, const u8 *data, u32 size);
 // Area 4 handlers
 template<typename T, bool upper> T DYNACALL pvr_read_area4(u32 addr);
 template<typename T, bool upper> void DYNACALL pvr_write_area4(u32 addr, T data);
@@ -5,6 +5,7 @@
 
 #include "pvr_sb_regs.h"
 #include "ta.h"
+#include "pvr_mem.h"
 #include "hw/holly/holly_intc.h"
 #include "hw/holly/sb.h"
 #include "hw/sh4/modules/dmac.h"
@@ -35,11 +36,19 @@ static void do_pvr_dma()
 	DEBUG_LOG(PVR, "PVR-DMA %x %s %x len %x", src, SB_PDDIR ? "<-" : "->", dst, len);
 
 	if (SB_PDDIR)
+	{
 		//PVR -> System
 		WriteMemBlock_nommu_dma(src, dst, len);
+	}
 	else
+	{
 		//System -> PVR
-		WriteMemBlock_nommu_dma(dst,src,len);
+		const u8 *psrc = GetMemPtr(src, len);
+		if (psrc != nullptr && ((dst >> 26) & 7) == 1)
+			pvr_write_block(dst, psrc, len);
+		else
+			WriteMemBlock_nommu_dma(dst,src,len);
+	}
 
 	DMAC_SAR(0) = src + len;
 	DMAC_CHCR(0).TE = 1;
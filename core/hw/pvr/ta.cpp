@@ -2,6 +2,7 @@
 #include "ta_ctx.h"
 #include "hw/holly/holly_intc.h"
 #include "pvr_mem.h"
+#include "elan.h"
 
 /*
 	Threaded TA Implementation
@@ -11,6 +12,10 @@
 	Render/TA thread -> ta data -> draw lists -> draw
 */
 
+#if HOST_CPU == CPU_X64 || (HOST_CPU == CPU_X86 && defined(__SSE2__))
+#include <emmintrin.h>
+#endif
+
 #if HOST_CPU == CPU_X86
 #include <xmmintrin.h>
 struct simd256_t
@@ -505,6 +510,8 @@ static void markObjectListBlocks(int renderPass)
 
 void ta_vtx_ListInit(bool continuation)
 {
+	if (settings.platform.isNaomi2())
+		elan::sync();
 	if (!continuation)
 		taRenderPass = 0;
 	else
@@ -568,28 +575,76 @@ static void DYNACALL ta_thd_data32_i(const simd256_t *data)
 
 void DYNACALL ta_vtx_data32(const SQBuffer *data)
 {
+	// ELAN commands written before must be processed first
+	if (settings.platform.isNaomi2())
+		elan::sync();
 	ta_thd_data32_i((const simd256_t *)data);
 }
 
-void ta_vtx_data(const SQBuffer *data, u32 size)
+// Number of blocks above which TA data is copied with non-temporal stores.
+// It won't be read again until the frame is rendered, usually by another thread.
+constexpr u32 TA_STREAM_COPY_MIN = 256;
+
+static void ta_copy_data(u8 *dst, const SQBuffer *src, u32 count)
 {
-	while (size >= 4)
+#if HOST_CPU == CPU_X64 || (HOST_CPU == CPU_X86 && defined(__SSE2__))
+	if (count >= TA_STREAM_COPY_MIN && ((uintptr_t)dst & 15) == 0)
 	{
-		ta_thd_data32_i((simd256_t *)data);
-		data++;
-		ta_thd_data32_i((simd256_t *)data);
-		data++;
-		ta_thd_data32_i((simd256_t *)data);
-		data++;
-		ta_thd_data32_i((simd256_t *)data);
-		data++;
-		size -= 4;
+		__m128i *d = (__m128i *)dst;
+		const __m128i *s = (const __m128i *)src;
+		for (u32 i = 0; i < count * 2; i += 2)
+		{
+			__m128i lo = _mm_loadu_si128(&s[i]);
+			__m128i hi = _mm_loadu_si128(&s[i + 1]);
+			_mm_stream_si128(&d[i], lo);
+			_mm_stream_si128(&d[i + 1], hi);
+		}
+		_mm_sfence();
+		return;
 	}
+#endif
+	memcpy(dst, src, count * sizeof(SQBuffer));
+}
 
+// Bulk TA data transfer (DMA): the whole batch is copied at once, then the state machine
+// runs over it and only calls ta_handle_cmd on list and polygon transitions.
+void ta_vtx_data(const SQBuffer *data, u32 size)
+{
+	if (settings.platform.isNaomi2())
+		elan::sync();
 	while (size > 0)
 	{
-		ta_thd_data32_i((simd256_t *)data);
-		data++;
-		size--;
+		const ptrdiff_t used = ta_tad.thd_data - ta_tad.thd_root;
+		// No context, first block of the list or buffer overflow
+		if (ta_ctx == nullptr || used == 0 || used >= (ptrdiff_t)TA_DATA_SIZE)
+		{
+			ta_thd_data32_i((const simd256_t *)data);
+			data++;
+			size--;
+			continue;
+		}
+		const u32 count = std::min<u32>(size, (TA_DATA_SIZE - used) / sizeof(SQBuffer));
+		u8 * const dst = ta_tad.thd_data;
+		ta_copy_data(dst, data, count);
+
+		u32 state = ta_cur_state;
+		for (u32 i = 0; i < count; i++)
+		{
+			const PCW pcw = *(const PCW *)&data[i];
+			const u32 trans = ta_fsm[(state << 8) | (pcw.ParaType << 5) | ((pcw.obj_ctrl >> 2) & 31)];
+			if (likely(!(trans & 0xF0)))
+			{
+				state = trans;
+				continue;
+			}
+			// ta_handle_cmd reads the last block written
+			ta_tad.thd_data = dst + (i + 1) * sizeof(SQBuffer);
+			ta_handle_cmd(trans);
+			state = ta_cur_state;
+		}
+		ta_cur_state = (u8)state;
+		ta_tad.thd_data = dst + count * sizeof(SQBuffer);
+		data += count;
+		size -= count;
 	}
 }
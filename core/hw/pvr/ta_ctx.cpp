@@ -5,8 +5,15 @@
 #include "serialize.h"
 #include "stdclass.h"
 
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
 #include <mutex>
 #include <vector>
+#ifdef __linux__
+#include <sys/mman.h>
+#endif
 
 extern u32 fskip;
 static int RenderCount;
@@ -43,85 +50,317 @@ void SetCurrentTARC(u32 addr)
 	}
 }
 
-static TA_context* rqueue;
-static cResetEvent frame_finished;
+// Contexts waiting to be processed by the render thread, oldest first
+static std::deque<TA_context*> rqueue;
+// Context being processed or rendered by the render thread
+static TA_context *renderingCtx;
+// Queued frames that the render thread hasn't finished reading from vram yet
+static u32 vramPendingFrames;
+static std::mutex rqueueMutex;
+static std::condition_variable frameFinished;
+static bool waitCancelled;
+static RenderQueueStats rqueueStats;
+// Average time spent by the render thread on a frame, in microseconds
+static float avgRenderTime;
+static std::chrono::steady_clock::time_point renderStartTime;
+static bool adaptiveDeepQueue;
+
+// Maximum number of frames that can be queued or rendering at the same time
+static u32 renderQueueDepth()
+{
+	const u32 maxDepth = std::clamp((int)config::RenderQueueDepth, 1, MAX_RENDER_QUEUE_DEPTH);
+	switch (config::RenderQueuePolicy)
+	{
+	case 1:		// maximum throughput
+		return maxDepth;
+	case 2:		// adaptive
+	{
+		// Only run ahead of the renderer when it can't keep up with the emulated frame rate
+		const float framePeriod = SPG_CONTROL.isPAL() ? 20000.f : 16667.f;
+		if (avgRenderTime > framePeriod * 0.9f)
+			adaptiveDeepQueue = true;
+		else if (avgRenderTime < framePeriod * 0.6f)
+			adaptiveDeepQueue = false;
+		return adaptiveDeepQueue ? maxDepth : 1;
+	}
+	case 0:		// lowest latency
+	default:
+		return 1;
+	}
+}
+
+static u32 framesInFlight() {
+	return (u32)rqueue.size() + (renderingCtx != nullptr ? 1 : 0);
+}
 
 bool QueueRender(TA_context* ctx)
 {
 	verify(ctx != 0);
 	
+	std::unique_lock<std::mutex> lock(rqueueMutex);
+	const u32 depth = renderQueueDepth();
 	bool skipFrame = !rend_is_enabled();
 	if (!skipFrame)
 	{
 		RenderCount++;
 		if (RenderCount % (config::SkipFrame + 1) != 0)
 			skipFrame = true;
-		else if (config::ThreadedRendering && rqueue != nullptr
+		else if (config::ThreadedRendering && framesInFlight() >= depth
 				&& (config::AutoSkipFrame == 0 || (config::AutoSkipFrame == 1 && SH4FastEnough)))
-			// The previous render hasn't completed yet so we wait.
+		{
+			// The render queue is full so we wait until a frame is rendered.
 			// If autoskipframe is enabled (normal level), we only do so if the CPU is running
 			// fast enough over the last frames
-			frame_finished.Wait();
+			const auto start = std::chrono::steady_clock::now();
+			frameFinished.wait(lock, [depth]() {
+				return framesInFlight() < depth || waitCancelled;
+			});
+			rqueueStats.waitTime += std::chrono::duration_cast<std::chrono::microseconds>(
+					std::chrono::steady_clock::now() - start).count();
+			waitCancelled = false;
+		}
 	}
 
-	if (skipFrame || rqueue)
+	if (skipFrame || framesInFlight() >= depth)
 	{
+		lock.unlock();
 		tactx_Recycle(ctx);
 		if (rend_is_enabled())
+		{
 			fskip++;
+			rqueueStats.droppedFrames++;
+		}
 		return false;
 	}
 	// disable net rollbacks until the render thread has processed the frame
 	rend_disable_rollback();
-	frame_finished.Reset();
-	verify(rqueue == nullptr);
-	rqueue = ctx;
-
+	waitCancelled = false;
+	rqueue.push_back(ctx);
+	vramPendingFrames++;
+	rqueueStats.depth = framesInFlight();
+	rqueueStats.maxDepth = depth;
 
 	return true;
 }
 
 TA_context* DequeueRender()
 {
-	if (rqueue != nullptr)
-		FrameCount++;
+	std::lock_guard<std::mutex> _(rqueueMutex);
+	if (rqueue.empty())
+		return nullptr;
+	verify(renderingCtx == nullptr);
+	renderingCtx = rqueue.front();
+	rqueue.pop_front();
+	renderStartTime = std::chrono::steady_clock::now();
+	FrameCount++;
+
+	return renderingCtx;
+}
+
+void WaitRenderVram()
+{
+	std::unique_lock<std::mutex> lock(rqueueMutex);
+	frameFinished.wait(lock, []() {
+		return vramPendingFrames == 0 || waitCancelled;
+	});
+}
+
+void ReleaseRenderVram()
+{
+	{
+		std::lock_guard<std::mutex> _(rqueueMutex);
+		if (vramPendingFrames > 0)
+			vramPendingFrames--;
+	}
+	frameFinished.notify_one();
+}
 
-	return rqueue;
+void ProcessedRender()
+{
+	std::lock_guard<std::mutex> _(rqueueMutex);
+	// net rollbacks are allowed once all queued frames have been processed
+	if (rqueue.empty())
+		rend_allow_rollback();
 }
 
 void FinishRender(TA_context* ctx)
 {
-	if (ctx != nullptr)
 	{
-		verify(rqueue == ctx);
-		rqueue = nullptr;
-		tactx_Recycle(ctx);
+		std::lock_guard<std::mutex> _(rqueueMutex);
+		if (ctx != nullptr)
+		{
+			verify(renderingCtx == ctx);
+			renderingCtx = nullptr;
+			const float renderTime = (float)std::chrono::duration_cast<std::chrono::microseconds>(
+					std::chrono::steady_clock::now() - renderStartTime).count();
+			avgRenderTime = avgRenderTime == 0.f ? renderTime : avgRenderTime * 0.9f + renderTime * 0.1f;
+		}
+		else
+		{
+			// wake up the emu thread
+			waitCancelled = true;
+		}
+		rqueueStats.depth = framesInFlight();
 	}
-	frame_finished.Set();
+	if (ctx != nullptr)
+		tactx_Recycle(ctx);
+	frameFinished.notify_one();
 }
 
-static std::mutex mtx_pool;
+void ClearRenderQueue()
+{
+	std::lock_guard<std::mutex> _(rqueueMutex);
+	if (renderingCtx != nullptr)
+		tactx_Recycle(renderingCtx);
+	renderingCtx = nullptr;
+	for (TA_context *ctx : rqueue)
+		tactx_Recycle(ctx);
+	rqueue.clear();
+	vramPendingFrames = 0;
+	rqueueStats.depth = 0;
+	avgRenderTime = 0.f;
+	adaptiveDeepQueue = false;
+}
 
-static std::vector<TA_context*> ctx_pool;
-static std::vector<TA_context*> ctx_list;
+RenderQueueStats getRenderQueueStats()
+{
+	std::lock_guard<std::mutex> _(rqueueMutex);
+	return rqueueStats;
+}
 
-TA_context *tactx_Alloc()
+// Largest size reached by the context buffers, for screen and render-to-texture frames.
+// Contexts reserve that much for the type of their last frame when allocated or recycled
+// so that they don't have to grow while a frame is built. New contexts use the screen marks.
+enum ContextBuffer {
+	BUF_VERTS,
+	BUF_VERTS_TWO_VOLUMES,
+	BUF_VERTS_NORMAL,
+	BUF_IDX,
+	BUF_MODTRIG,
+	BUF_PARAM_OP,
+	BUF_PARAM_PT,
+	BUF_PARAM_TR,
+	BUF_PARAM_MVO,
+	BUF_PARAM_MVO_TR,
+	BUF_MATRICES,
+	BUF_LIGHT_MODELS,
+	BUF_COUNT
+};
+static std::atomic<u32> highWaterMarks[2][BUF_COUNT];
+
+static std::atomic<u32> contextCount;
+static std::atomic<u64> contextMemory;
+static std::atomic<u32> contextGrowths;
+
+template<typename T>
+static void reserveBuffer(std::vector<T>& v, std::atomic<u32> *marks, ContextBuffer buffer, u32 minSize = 0)
+{
+	const u32 size = v.size();
+	u32 mark = marks[buffer].load(std::memory_order_relaxed);
+	while (size > mark && !marks[buffer].compare_exchange_weak(mark, size, std::memory_order_relaxed))
+		;
+	v.reserve(std::max({ minSize, size, mark }));
+}
+
+template<typename T>
+static size_t capacityBytes(const std::vector<T>& v) {
+	return v.capacity() * sizeof(T);
+}
+
+// TA data buffers are big and written sequentially. Use transparent huge pages if available.
+static u8 *allocTAData()
 {
-	TA_context *ctx = nullptr;
+#if defined(__linux__) && defined(MADV_HUGEPAGE)
+	u8 *data = (u8 *)allocAligned(2_MB, TA_DATA_SIZE);
+	if (data != nullptr)
+		madvise(data, TA_DATA_SIZE, MADV_HUGEPAGE);
+	return data;
+#else
+	return (u8 *)allocAligned(32, TA_DATA_SIZE);
+#endif
+}
+
+void TA_context::Alloc()
+{
+	tad.Reset(allocTAData());
+	contextCount++;
+	Reset();
+}
 
-	mtx_pool.lock();
-	if (!ctx_pool.empty())
+void TA_context::reserveBuffers()
+{
+	std::atomic<u32> *marks = highWaterMarks[rend.isRTT];
+	reserveBuffer(rend.verts, marks, BUF_VERTS, 32768);
+	reserveBuffer(rend.vertsTwoVolumes, marks, BUF_VERTS_TWO_VOLUMES);
+	reserveBuffer(rend.vertsNormal, marks, BUF_VERTS_NORMAL);
+	reserveBuffer(rend.idx, marks, BUF_IDX, 32768);
+	reserveBuffer(rend.modtrig, marks, BUF_MODTRIG, 16384);
+	reserveBuffer(rend.global_param_op, marks, BUF_PARAM_OP, 4096);
+	reserveBuffer(rend.global_param_pt, marks, BUF_PARAM_PT, 4096);
+	reserveBuffer(rend.global_param_tr, marks, BUF_PARAM_TR, 4096);
+	reserveBuffer(rend.global_param_mvo, marks, BUF_PARAM_MVO, 4096);
+	reserveBuffer(rend.global_param_mvo_tr, marks, BUF_PARAM_MVO_TR, 4096);
+	if (settings.platform.isNaomi2())
 	{
-		ctx = ctx_pool.back();
-		ctx_pool.pop_back();
+		reserveBuffer(rend.matrices, marks, BUF_MATRICES, 2000);
+		reserveBuffer(rend.lightModels, marks, BUF_LIGHT_MODELS, 150);
 	}
-	mtx_pool.unlock();
+}
 
-	if (ctx == nullptr)
+void TA_context::Reset()
+{
+	verify(tad.End() - tad.thd_root <= (ptrdiff_t)TA_DATA_SIZE);
+	tad.Clear();
+	nextContext = nullptr;
+
+	const size_t memory = memoryUsage();
+	if (reservedMemory != 0 && memory > reservedMemory)
+		contextGrowths++;
+	reserveBuffers();
+	rend.Clear();
+	const size_t newMemory = memoryUsage();
+	contextMemory += newMemory - reservedMemory;
+	reservedMemory = newMemory;
+}
+
+TA_context::~TA_context()
+{
+	verify(tad.End() - tad.thd_root <= (ptrdiff_t)TA_DATA_SIZE);
+	if (tad.thd_root != nullptr)
+	{
+		contextMemory -= reservedMemory;
+		contextCount--;
+	}
+	freeAligned(tad.thd_root);
+}
+
+size_t TA_context::memoryUsage() const
+{
+	return TA_DATA_SIZE + capacityBytes(rend.verts) + capacityBytes(rend.vertsTwoVolumes)
+			+ capacityBytes(rend.vertsNormal) + capacityBytes(rend.idx) + capacityBytes(rend.modtrig)
+			+ capacityBytes(rend.global_param_op) + capacityBytes(rend.global_param_pt)
+			+ capacityBytes(rend.global_param_tr) + capacityBytes(rend.global_param_mvo)
+			+ capacityBytes(rend.global_param_mvo_tr) + capacityBytes(rend.render_passes)
+			+ capacityBytes(rend.sortedTriangles) + capacityBytes(rend.matrices)
+			+ capacityBytes(rend.lightModels);
+}
+
+// Contexts ready to be reused. Free slots are null.
+// Used by both the emulator and render threads.
+static std::atomic<TA_context *> ctx_pool[4];
+static std::vector<TA_context*> ctx_list;
+
+TA_context *tactx_Alloc()
+{
+	for (auto& slot : ctx_pool)
 	{
-		ctx = new TA_context();
-		ctx->Alloc();
+		TA_context *ctx = slot.exchange(nullptr);
+		if (ctx != nullptr)
+			return ctx;
 	}
+	TA_context *ctx = new TA_context();
+	ctx->Alloc();
+
 	return ctx;
 }
 
@@ -129,17 +368,27 @@ static void tactx_Recycle(TA_context* ctx)
 {
 	if (ctx->nextContext != nullptr)
 		tactx_Recycle(ctx->nextContext);
-	mtx_pool.lock();
-	if (ctx_pool.size() > 3)
-	{
-		delete ctx;
-	}
-	else
+	ctx->Reset();
+	for (auto& slot : ctx_pool)
 	{
-		ctx->Reset();
-		ctx_pool.push_back(ctx);
+		TA_context *empty = nullptr;
+		if (slot.compare_exchange_strong(empty, ctx))
+			return;
 	}
-	mtx_pool.unlock();
+	delete ctx;
+}
+
+TAContextStats getTAContextStats()
+{
+	TAContextStats stats{};
+	stats.contexts = contextCount;
+	for (const auto& slot : ctx_pool)
+		if (slot.load() != nullptr)
+			stats.pooled++;
+	stats.memory = contextMemory;
+	stats.growths = contextGrowths;
+
+	return stats;
 }
 
 static TA_context *tactx_Find(u32 addr, bool allocnew)
@@ -205,11 +454,8 @@ void tactx_Term()
 		delete ctx;
 	ctx_list.clear();
 
-	mtx_pool.lock();
-	for (TA_context *ctx : ctx_pool)
-		delete ctx;
-	ctx_pool.clear();
-	mtx_pool.unlock();
+	for (auto& slot : ctx_pool)
+		delete slot.exchange(nullptr);
 }
 
 const u32 NULL_CONTEXT = ~0u;
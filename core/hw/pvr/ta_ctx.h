@@ -11,6 +11,7 @@ class BaseTextureCacheData;
 struct N2LightModel;
 
 //Vertex storage types
+// Attributes used by all vertices
 struct Vertex
 {
 	float x,y,z;
@@ -19,17 +20,28 @@ struct Vertex
 	u8 spc[4];
 
 	float u,v;
+};
 
-	// Two volumes format
+// Two volumes format
+struct VertexTwoVolumes
+{
 	u8 col1[4];
 	u8 spc1[4];
 
 	float u1,v1;
+};
 
-	// Naomi2 normal
+// Naomi2 normal
+struct VertexNormal
+{
 	float nx,ny,nz;
 };
 
+// Vertex with all attributes, as produced by the Naomi2 Elan
+struct N2Vertex : Vertex, VertexTwoVolumes, VertexNormal
+{
+};
+
 struct PolyParam
 {
 	u32 first;		//entry index , holds vertex/pos data
@@ -229,7 +241,7 @@ struct rend_context
 {
 	f32 fZ_max;
 
-	bool isRTT;
+	bool isRTT = false;
 	bool clearFramebuffer;
 	
 	TA_GLOB_TILE_CLIP_type ta_GLOB_TILE_CLIP;
@@ -246,6 +258,9 @@ struct rend_context
 	RGBAColor fog_clamp_max;
 
 	std::vector<Vertex> verts;
+	// Optional vertex attribute streams. Each one is either empty or the same size as verts
+	std::vector<VertexTwoVolumes> vertsTwoVolumes;
+	std::vector<VertexNormal> vertsNormal;
 	std::vector<u32> idx;
 	std::vector<ModTriangle> modtrig;
 	std::vector<ModifierVolumeParam> global_param_mvo;
@@ -262,6 +277,8 @@ struct rend_context
 
 	void Clear()
 	{
+		vertsTwoVolumes.clear();
+		vertsNormal.clear();
 		idx.clear();
 		global_param_op.clear();
 		global_param_pt.clear();
@@ -285,6 +302,32 @@ struct rend_context
 
 	void newRenderPass();
 
+	// Two volumes attributes of the last vertex. The stream is allocated on first use.
+	VertexTwoVolumes& lastTwoVolumes()
+	{
+		vertsTwoVolumes.resize(verts.size());
+		return vertsTwoVolumes.back();
+	}
+	// Normal of the last vertex. The stream is allocated on first use.
+	VertexNormal& lastNormal()
+	{
+		vertsNormal.resize(verts.size());
+		return vertsNormal.back();
+	}
+	// Extend the streams used by this frame to all the vertices
+	void alignVertexStreams()
+	{
+		if (!vertsTwoVolumes.empty())
+			vertsTwoVolumes.resize(verts.size());
+		if (!vertsNormal.empty())
+			vertsNormal.resize(verts.size());
+	}
+	size_t vertexDataSize() const
+	{
+		return verts.size() * sizeof(Vertex) + vertsTwoVolumes.size() * sizeof(VertexTwoVolumes)
+				+ vertsNormal.size() * sizeof(VertexNormal);
+	}
+
 	// For RTT TODO merge with framebufferWidth/Height
 	u32 getFramebufferWidth() const
 	{
@@ -350,40 +393,17 @@ struct TA_context
 		return tad.End();
 	}
 
-	void Alloc()
-	{
-		tad.Reset((u8*)allocAligned(32, TA_DATA_SIZE));
-
-		rend.verts.reserve(32768);
-		rend.idx.reserve(32768);
-		rend.global_param_op.reserve(4096);
-		rend.global_param_pt.reserve(4096);
-		rend.global_param_tr.reserve(4096);
-		rend.global_param_mvo.reserve(4096);
-		rend.global_param_mvo_tr.reserve(4096);
-		rend.modtrig.reserve(16384);
-
-		if (settings.platform.isNaomi2())
-		{
-			rend.matrices.reserve(2000);
-			rend.lightModels.reserve(150);
-		}
-		Reset();
-	}
+	void Alloc();
+	void Reset();
+	~TA_context();
 
-	void Reset()
-	{
-		verify(tad.End() - tad.thd_root <= (ptrdiff_t)TA_DATA_SIZE);
-		tad.Clear();
-		nextContext = nullptr;
-		rend.Clear();
-	}
+	// Memory reserved by the context, in bytes
+	size_t memoryUsage() const;
 
-	~TA_context()
-	{
-		verify(tad.End() - tad.thd_root <= (ptrdiff_t)TA_DATA_SIZE);
-		freeAligned(tad.thd_root);
-	}
+private:
+	void reserveBuffers();
+
+	size_t reservedMemory = 0;
 };
 
 extern TA_context* ta_ctx;
@@ -404,7 +424,33 @@ TA_context *tactx_Alloc();
 void SetCurrentTARC(u32 addr);
 bool QueueRender(TA_context* ctx);
 TA_context* DequeueRender();
+// Waits until the queued frames no longer need to read the emulated vram
+void WaitRenderVram();
+// Called by the render thread when it no longer needs the emulated vram for the current frame
+void ReleaseRenderVram();
+void ProcessedRender();
 void FinishRender(TA_context* ctx);
+void ClearRenderQueue();
+
+constexpr int MAX_RENDER_QUEUE_DEPTH = 3;
+
+struct RenderQueueStats
+{
+	u32 depth;			// frames currently queued or rendering
+	u32 maxDepth;		// current queue depth limit
+	u64 waitTime;		// total time the emulator waited for the renderer, in microseconds
+	u32 droppedFrames;	// total number of frames dropped because the queue was full
+};
+RenderQueueStats getRenderQueueStats();
+
+struct TAContextStats
+{
+	u32 contexts;		// contexts currently allocated
+	u32 pooled;			// contexts ready to be reused
+	u64 memory;			// memory reserved by all contexts when they were last reset, in bytes
+	u32 growths;		// total number of frames that had to grow their context buffers
+};
+TAContextStats getTAContextStats();
 
 //must be moved to proper header
 void FillBGP(TA_context* ctx);
@@ -413,7 +459,7 @@ void DeserializeTAContext(Deserializer& deser);
 
 void ta_add_poly(const PolyParam& pp);
 void ta_add_poly(int listType, const ModifierVolumeParam& mvp);
-void ta_add_vertex(const Vertex& vtx);
+void ta_add_vertex(const N2Vertex& vtx);
 void ta_add_triangle(const ModTriangle& tri);
 int ta_add_matrix(const float *matrix);
 int ta_add_light(const N2LightModel& light);
@@ -426,7 +472,7 @@ void ta_set_list_type(u32 listType);
 void ta_parse_reset();
 void getRegionTileAddrAndSize(u32& address, u32& size);
 
-void sortTriangles(rend_context& ctx, RenderPass& pass, const RenderPass& previousPass);
+void sortTriangles(rend_context& ctx);
 void sortPolyParams(std::vector<PolyParam>& polys, int first, int end, rend_context& ctx);
 void fix_texture_bleeding(const std::vector<PolyParam>& polys, int first, int end, rend_context& ctx);
 void makeIndex(std::vector<PolyParam>& polys, int first, int end, bool merge, rend_context& ctx);
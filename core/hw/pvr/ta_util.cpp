@@ -19,6 +19,7 @@
 #include "ta_ctx.h"
 #include "pvr_mem.h"
 #include <algorithm>
+#include <future>
 #include <glm/glm.hpp>
 #include <glm/gtc/type_ptr.hpp>
 
@@ -52,33 +53,59 @@ static float minZ(const Vertex *v, const u32 *mod)
 	return std::min(std::min(v[mod[0]].z, v[mod[1]].z), v[mod[2]].z);
 }
 
-static bool operator<(const IndexTrig& left, const IndexTrig& right)
-{
-	return left.z < right.z;
-}
-
 static float getProjectedZ(const Vertex *v, const float *mat)
 {
 	// -1 / z
 	return -1 / (mat[2] * v->x + mat[1 * 4 + 2] * v->y + mat[2 * 4 + 2] * v->z + mat[3 * 4 + 2]);
 }
 
-void sortTriangles(rend_context& ctx, RenderPass& pass, const RenderPass& previousPass)
+// Maps a float to an unsigned int with the same ordering
+static u32 floatSortKey(float f)
 {
-	int first = previousPass.tr_count;
-	int count = pass.tr_count - first;
-	if (count == 0)
-		return;
+	f += 0.f;	// -0 and +0 must have the same key
+	u32 bits;
+	memcpy(&bits, &f, sizeof(bits));
+	return (bits & 0x80000000) != 0 ? ~bits : bits | 0x80000000;
+}
 
-	const PolyParam * const pp_base = &ctx.global_param_tr[first];
-	const PolyParam * const pp_end = pp_base + count;
+class TriangleSorter
+{
+public:
+	// Build the list of triangles of a render pass and sort them by increasing z.
+	// Only reads the context so that several passes can be sorted concurrently.
+	void sort(const rend_context& ctx, const RenderPass& pass, const RenderPass& previousPass)
+	{
+		triangles.clear();
+		int first = previousPass.tr_count;
+		count = pass.tr_count - first;
+		if (count == 0)
+			return;
+		ppBase = first;
+		makeTriangleList(ctx, &ctx.global_param_tr[first]);
+		radixSort();
+	}
 
-	//make lists of all triangles, with their pid and vid
-	static std::vector<IndexTrig> triangleList;
+	// Add the sorted triangles to the index and the sorted triangle list of the context
+	void assemble(rend_context& ctx);
+
+private:
+	void makeTriangleList(const rend_context& ctx, const PolyParam *pp_base);
+	void radixSort();
 
+	std::vector<IndexTrig> triangles;
+	std::vector<IndexTrig> sortedTriangles;
+	std::vector<u64> keys;
+	std::vector<u64> tmpKeys;
+	int ppBase = 0;
+	int count = 0;
+};
+
+void TriangleSorter::makeTriangleList(const rend_context& ctx, const PolyParam *pp_base)
+{
+	//make lists of all triangles, with their pid and vid
+	const PolyParam * const pp_end = pp_base + count;
 	int vtx_count = ctx.verts.size() - pp_base->first;
-	triangleList.reserve(vtx_count);
-	triangleList.clear();
+	triangles.reserve(vtx_count);
 
 	for (const PolyParam *pp = pp_base; pp != pp_end; pp++)
 	{
@@ -108,18 +135,18 @@ void sortTriangles(rend_context& ctx, RenderPass& pass, const RenderPass& previo
 				v2 = nullptr;
 			if (v0 != nullptr && v1 != nullptr && v2 != nullptr)
 			{
-				triangleList.emplace_back((u32)(pp - pp_base),
+				triangles.emplace_back((u32)(pp - pp_base),
 						(u32)(v0 - &ctx.verts[0]), (u32)(v1 - &ctx.verts[0]), (u32)(v2 - &ctx.verts[0]));
 				if (pp->isNaomi2())
 				{
 					float z2 = getProjectedZ(v2, ctx.matrices[pp->mvMatrix].mat);
-					triangleList.back().z = std::min(z0, std::min(z1, z2));
+					triangles.back().z = std::min(z0, std::min(z1, z2));
 					z0 = z1;
 					z1 = z2;
 				}
 				else
 				{
-					triangleList.back().z = minZ(&ctx.verts[0], triangleList.back().vid);
+					triangles.back().z = minZ(&ctx.verts[0], triangles.back().vid);
 				}
 			}
 			if (i & 1)
@@ -128,19 +155,67 @@ void sortTriangles(rend_context& ctx, RenderPass& pass, const RenderPass& previo
 				v0 = v2;
 		}
 	}
+}
 
-	//sort them
-	std::stable_sort(triangleList.begin(), triangleList.end());
+//
+// Stable LSD radix sort on the z value, 8 bits at a time.
+// Keys pack the z sort key in the upper 32 bits and the triangle index in the lower 32 bits
+// so that only 8-byte keys are moved around.
+//
+void TriangleSorter::radixSort()
+{
+	const size_t size = triangles.size();
+	keys.resize(size);
+	tmpKeys.resize(size);
+	u32 histogram[4][256] {};
+	for (size_t i = 0; i < size; i++)
+	{
+		u32 key = floatSortKey(triangles[i].z);
+		keys[i] = ((u64)key << 32) | i;
+		histogram[0][key & 0xff]++;
+		histogram[1][(key >> 8) & 0xff]++;
+		histogram[2][(key >> 16) & 0xff]++;
+		histogram[3][key >> 24]++;
+	}
+	for (int pass = 0; pass < 4; pass++)
+	{
+		const u32 shift = 32 + pass * 8;
+		u32 *counts = histogram[pass];
+		// Nothing to do if all keys have the same digit
+		if (counts[(keys[0] >> shift) & 0xff] == size)
+			continue;
+		u32 offset = 0;
+		for (int i = 0; i < 256; i++)
+		{
+			u32 c = counts[i];
+			counts[i] = offset;
+			offset += c;
+		}
+		for (u64 key : keys)
+			tmpKeys[counts[(key >> shift) & 0xff]++] = key;
+		std::swap(keys, tmpKeys);
+	}
+	sortedTriangles.resize(size);
+	for (size_t i = 0; i < size; i++)
+		sortedTriangles[i] = triangles[(u32)keys[i]];
+	std::swap(triangles, sortedTriangles);
+}
+
+void TriangleSorter::assemble(rend_context& ctx)
+{
+	if (count == 0)
+		return;
+	const PolyParam * const pp_base = &ctx.global_param_tr[ppBase];
 
 	//Merge pids/draw cmds if two different pids are actually equal
-	for (size_t k = 1; k < triangleList.size(); k++)
-		if (triangleList[k].pid != triangleList[k - 1].pid)
+	for (size_t k = 1; k < triangles.size(); k++)
+		if (triangles[k].pid != triangles[k - 1].pid)
 		{
-			const PolyParam& curPoly = pp_base[triangleList[k].pid];
-			const PolyParam& prevPoly = pp_base[triangleList[k - 1].pid];
+			const PolyParam& curPoly = pp_base[triangles[k].pid];
+			const PolyParam& prevPoly = pp_base[triangles[k - 1].pid];
 			if (curPoly.equivalentIgnoreCullingDirection(prevPoly)
 					&& (curPoly.isp.CullMode < 2 || curPoly.isp.CullMode == prevPoly.isp.CullMode))
-				triangleList[k].pid = triangleList[k - 1].pid;
+				triangles[k].pid = triangles[k - 1].pid;
 		}
 
 	//re-assemble them into drawing commands
@@ -148,10 +223,10 @@ void sortTriangles(rend_context& ctx, RenderPass& pass, const RenderPass& previo
 	int idx = -1;
 	int idxSize = ctx.idx.size();
 
-	for (size_t i = 0; i < triangleList.size(); i++)
+	for (size_t i = 0; i < triangles.size(); i++)
 	{
-		int pid = triangleList[i].pid;
-		u32* midx = triangleList[i].vid;
+		int pid = triangles[i].pid;
+		u32* midx = triangles[i].vid;
 
 		ctx.idx.emplace_back(midx[0]);
 		ctx.idx.emplace_back(midx[1]);
@@ -159,7 +234,7 @@ void sortTriangles(rend_context& ctx, RenderPass& pass, const RenderPass& previo
 
 		if (idx != pid)
 		{
-			SortedTriangle cur = { (u32)(&pp_base[pid] - &ctx.global_param_tr[0]), (u32)(idxSize + i * 3), 0 };
+			SortedTriangle cur = { (u32)(ppBase + pid), (u32)(idxSize + i * 3), 0 };
 
 			if (idx != -1)
 			{
@@ -172,23 +247,75 @@ void sortTriangles(rend_context& ctx, RenderPass& pass, const RenderPass& previo
 		}
 	}
 
-	if (!triangleList.empty())
+	if (!triangles.empty())
 	{
 		SortedTriangle& last = ctx.sortedTriangles.back();
-		last.count = idxSize + triangleList.size() * 3 - last.first;
+		last.count = idxSize + triangles.size() * 3 - last.first;
 	}
 	else
 	{
 		// Add a dummy one to signal we're using sorted triangles
-		ctx.sortedTriangles.push_back({ (u32)(&pp_base[0] - &ctx.global_param_tr[0]), 0, 0});
+		ctx.sortedTriangles.push_back({ (u32)ppBase, 0, 0});
 	}
-	pass.sorted_tr_count = ctx.sortedTriangles.size();
 
 #if PRINT_SORT_STATS
-	printf("Reassembled into %d from %d\n", (int)ctx.sortedTriangles.size(), pp_end - pp_base);
+	printf("Reassembled into %d from %d\n", (int)ctx.sortedTriangles.size(), count);
 #endif
 }
 
+void sortTriangles(rend_context& ctx)
+{
+	static std::vector<TriangleSorter> sorters;
+	if (sorters.size() < ctx.render_passes.size())
+		sorters.resize(ctx.render_passes.size());
+
+	// The passes are independent so they are sorted in parallel.
+	// The first pass and small ones that aren't worth a thread are sorted by the calling thread.
+	constexpr u32 MinAsyncPolys = 256;
+	auto isAsync = [](bool firstPass, const RenderPass& pass, const RenderPass& previousPass) {
+		return !firstPass && pass.tr_count - previousPass.tr_count >= MinAsyncPolys;
+	};
+	std::vector<std::future<void>> futures;
+	RenderPass previousPass{};
+	bool firstPass = true;
+	for (size_t i = 0; i < ctx.render_passes.size(); i++)
+	{
+		const RenderPass& pass = ctx.render_passes[i];
+		if (pass.autosort)
+		{
+			if (isAsync(firstPass, pass, previousPass))
+				futures.push_back(std::async(std::launch::async, [&ctx, &pass, previousPass, &sorter = sorters[i]]() {
+					sorter.sort(ctx, pass, previousPass);
+				}));
+			firstPass = false;
+		}
+		previousPass = pass;
+	}
+	previousPass = {};
+	firstPass = true;
+	for (size_t i = 0; i < ctx.render_passes.size(); i++)
+	{
+		const RenderPass& pass = ctx.render_passes[i];
+		if (pass.autosort)
+		{
+			if (!isAsync(firstPass, pass, previousPass))
+				sorters[i].sort(ctx, pass, previousPass);
+			firstPass = false;
+		}
+		previousPass = pass;
+	}
+	for (auto& future : futures)
+		future.get();
+
+	for (size_t i = 0; i < ctx.render_passes.size(); i++)
+	{
+		RenderPass& pass = ctx.render_passes[i];
+		if (pass.autosort)
+			sorters[i].assemble(ctx);
+		pass.sorted_tr_count = ctx.sortedTriangles.size();
+	}
+}
+
 static bool operator<(const PolyParam& left, const PolyParam& right)
 {
 	return left.zvZ < right.zvZ;
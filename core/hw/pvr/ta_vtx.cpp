@@ -11,7 +11,17 @@
 #include "cfg/option.h"
 
 #include <algorithm>
+#include <chrono>
+#include <unordered_map>
+#include <unordered_set>
 #include <utility>
+#include <xxhash.h>
+
+#if HOST_CPU == CPU_X64 || (HOST_CPU == CPU_X86 && defined(__SSE2__))
+#include <emmintrin.h>
+#elif HOST_CPU == CPU_ARM64 || (HOST_CPU == CPU_ARM && defined(__ARM_NEON__))
+#include <arm_neon.h>
+#endif
 
 #define TACALL DYNACALL
 #ifdef NDEBUG
@@ -36,6 +46,124 @@ static f32 f16(u16 v)
 	return *(f32*)&z;
 }
 
+//
+// Vertex color conversions
+// Colors are returned as 4 bytes in the order used by the renderer (Red, Green, Blue, Alpha indices)
+//
+
+// Packed ARGB color
+template<int Red, int Green, int Blue, int Alpha>
+static u32 packedColor(u32 argb)
+{
+	if constexpr (Red == 2 && Green == 1 && Blue == 0 && Alpha == 3)
+		return argb;
+	else if constexpr (Red == 0 && Green == 1 && Blue == 2 && Alpha == 3)
+		return (argb & 0xff00ff00) | ((argb >> 16) & 0xff) | ((argb & 0xff) << 16);
+	else
+		return (argb & 0xff) << (Blue * 8) | ((argb >> 8) & 0xff) << (Green * 8)
+				| ((argb >> 16) & 0xff) << (Red * 8) | (argb >> 24) << (Alpha * 8);
+}
+
+// Two consecutive packed ARGB colors
+template<int Red, int Green, int Blue, int Alpha>
+static u64 packedColors(u64 argb)
+{
+	if constexpr (Red == 2 && Green == 1 && Blue == 0 && Alpha == 3)
+		return argb;
+	else if constexpr (Red == 0 && Green == 1 && Blue == 2 && Alpha == 3)
+		return (argb & 0xff00ff00ff00ff00ull) | ((argb >> 16) & 0x000000ff000000ffull) | ((argb & 0x000000ff000000ffull) << 16);
+	else
+		return packedColor<Red, Green, Blue, Alpha>((u32)argb) | (u64)packedColor<Red, Green, Blue, Alpha>((u32)(argb >> 32)) << 32;
+}
+
+// Reorder a color converted from floats (A, R, G, B bytes)
+template<int Red, int Green, int Blue, int Alpha>
+static u32 argbBytesToColor(u32 c)
+{
+	return (c & 0xff) << (Alpha * 8) | ((c >> 8) & 0xff) << (Red * 8)
+			| ((c >> 16) & 0xff) << (Green * 8) | (c >> 24) << (Blue * 8);
+}
+
+// Convert 4 or 8 floats in ARGB order to bytes, with the same results as float_to_satu8.
+// Only the upper 16 bits of each float are used, and NaN converts to 255.
+template<int Count>
+static u64 floatsToBytes(const f32 *src)
+{
+	static_assert(Count == 4 || Count == 8);
+#if HOST_CPU == CPU_X64 || (HOST_CPU == CPU_X86 && defined(__SSE2__))
+	const __m128 mask = _mm_castsi128_ps(_mm_set1_epi32(0xffff0000));
+	const __m128 zero = _mm_setzero_ps();
+	const __m128 one = _mm_set1_ps(1.f);
+	const __m128 scale = _mm_set1_ps(255.f);
+	// max keeps NaN (second operand), min turns it into 1 (second operand)
+	__m128 c0 = _mm_min_ps(_mm_max_ps(zero, _mm_and_ps(_mm_loadu_ps(src), mask)), one);
+	__m128i i0 = _mm_cvttps_epi32(_mm_mul_ps(c0, scale));
+	__m128i i1;
+	if constexpr (Count == 8)
+	{
+		__m128 c1 = _mm_min_ps(_mm_max_ps(zero, _mm_and_ps(_mm_loadu_ps(src + 4), mask)), one);
+		i1 = _mm_cvttps_epi32(_mm_mul_ps(c1, scale));
+	}
+	else {
+		i1 = i0;
+	}
+	__m128i bytes = _mm_packus_epi16(_mm_packs_epi32(i0, i1), i0);
+	u64 v;
+	_mm_storel_epi64((__m128i *)&v, bytes);
+	return v;
+#elif HOST_CPU == CPU_ARM64 || (HOST_CPU == CPU_ARM && defined(__ARM_NEON__))
+	const uint32x4_t mask = vdupq_n_u32(0xffff0000);
+	const float32x4_t zero = vdupq_n_f32(0.f);
+	const float32x4_t one = vdupq_n_f32(1.f);
+	const float32x4_t scale = vdupq_n_f32(255.f);
+	auto convert = [&](const f32 *p) {
+		float32x4_t c = vreinterpretq_f32_u32(vandq_u32(vreinterpretq_u32_f32(vld1q_f32(p)), mask));
+		// NaN converts to 1
+		float32x4_t clamped = vbslq_f32(vceqq_f32(c, c), vminq_f32(vmaxq_f32(c, zero), one), one);
+		return vmovn_u32(vcvtq_u32_f32(vmulq_f32(clamped, scale)));
+	};
+	uint16x4_t h0 = convert(src);
+	uint16x4_t h1;
+	if constexpr (Count == 8)
+		h1 = convert(src + 4);
+	else
+		h1 = h0;
+	return vget_lane_u64(vreinterpret_u64_u8(vmovn_u16(vcombine_u16(h0, h1))), 0);
+#else
+	u64 v = 0;
+	for (int i = 0; i < Count; i++)
+		v |= (u64)float_to_satu8(src[i]) << (i * 8);
+	return v;
+#endif
+}
+
+// Float ARGB color
+template<int Red, int Green, int Blue, int Alpha>
+static u32 floatColor(const f32 *argb)
+{
+	return argbBytesToColor<Red, Green, Blue, Alpha>((u32)floatsToBytes<4>(argb));
+}
+
+// Two consecutive float ARGB colors
+template<int Red, int Green, int Blue, int Alpha>
+static u64 floatColors(const f32 *argb)
+{
+	u64 v = floatsToBytes<8>(argb);
+	return argbBytesToColor<Red, Green, Blue, Alpha>((u32)v)
+			| (u64)argbBytesToColor<Red, Green, Blue, Alpha>((u32)(v >> 32)) << 32;
+}
+
+// Face color modulated by an intensity. Alpha isn't modulated.
+// The three color components are multiplied at once since each product fits in 16 bits.
+static u32 intensityColor(const u8 *faceColor, u32 intensity)
+{
+	u32 face;
+	memcpy(&face, faceColor, sizeof(face));
+	u32 rb = (((face & 0x00ff00ff) * intensity) >> 8) & 0x00ff00ff;
+	u32 g = ((face & 0x0000ff00) * intensity >> 8) & 0x0000ff00;
+	return rb | g | (face & 0xff000000);
+}
+
 class BaseTAParser
 {
 	static Ta_Dma *DYNACALL NullVertexData(Ta_Dma *data, Ta_Dma *data_end)
@@ -101,6 +229,47 @@ public:
 		tileclip_val = tileclip;
 	}
 
+	// Parser state that carries over from one list to the next
+	struct State
+	{
+		u32 tileclip;
+		u8 faceBaseColor[4];
+		u8 faceOffsColor[4];
+		u8 faceBaseColor1[4];
+		u8 faceOffsColor1[4];
+		u32 sFaceBaseColor;
+		u32 sFaceOffsColor;
+	};
+
+	static State getState()
+	{
+		State state;
+		state.tileclip = tileclip_val;
+		memcpy(state.faceBaseColor, FaceBaseColor, sizeof(FaceBaseColor));
+		memcpy(state.faceOffsColor, FaceOffsColor, sizeof(FaceOffsColor));
+		memcpy(state.faceBaseColor1, FaceBaseColor1, sizeof(FaceBaseColor1));
+		memcpy(state.faceOffsColor1, FaceOffsColor1, sizeof(FaceOffsColor1));
+		state.sFaceBaseColor = SFaceBaseColor;
+		state.sFaceOffsColor = SFaceOffsColor;
+		return state;
+	}
+
+	static void setState(const State& state)
+	{
+		tileclip_val = state.tileclip;
+		memcpy(FaceBaseColor, state.faceBaseColor, sizeof(FaceBaseColor));
+		memcpy(FaceOffsColor, state.faceOffsColor, sizeof(FaceOffsColor));
+		memcpy(FaceBaseColor1, state.faceBaseColor1, sizeof(FaceBaseColor1));
+		memcpy(FaceOffsColor1, state.faceOffsColor1, sizeof(FaceOffsColor1));
+		SFaceBaseColor = state.sFaceBaseColor;
+		SFaceOffsColor = state.sFaceOffsColor;
+	}
+
+	// Not inside a list
+	static bool isIdle() {
+		return CurrentList == ListType_None;
+	}
+
 protected:
 	typedef Ta_Dma* DYNACALL TaListFP(Ta_Dma* data, Ta_Dma* data_end);
 	typedef void TACALL TaPolyParamFP(void* ptr);
@@ -161,6 +330,8 @@ public:
 	static PolyParam* CurrentPP;
 	static TaListFP* TaCmd;
 	inline static bool fetchTextures = true;
+	// Return to the caller after each end of list
+	inline static bool stopAtEndOfList = false;
 };
 
 const u32 *BaseTAParser::ta_type_lut = TaTypeLut::instance().table;
@@ -394,6 +565,8 @@ strip_end:
 			case ParamType_End_Of_List:
 				endList();
 				data += SZ32;
+				if (stopAtEndOfList)
+					return data;
 				break;
 
 				//32B
@@ -652,11 +825,9 @@ private:
 	static Vertex* vert_cvt_base_(T* vtx)
 	{
 		f32 invW = vtx->xyz[2];
-		vd_rc.verts.emplace_back();
-		Vertex* cv = &vd_rc.verts.back();
-		cv->x = vtx->xyz[0];
-		cv->y = vtx->xyz[1];
-		cv->z = invW;
+		Vertex* cv = &vd_rc.verts.emplace_back();
+		static_assert(offsetof(Vertex, z) == offsetof(Vertex, x) + 8);
+		memcpy(&cv->x, vtx->xyz, sizeof(vtx->xyz));
 		update_fz(invW);
 		return cv;
 	}
@@ -667,80 +838,105 @@ private:
 	#define vert_res_base \
 		Vertex* cv = &vd_rc.verts.back();
 
+		//Two volumes attributes of the last vertex
+	#define vert_two_volumes_base \
+		VertexTwoVolumes* cv1 = &vd_rc.lastTwoVolumes();
+
 		//uv 16/32
 	#define vert_uv_32(u_name,v_name) \
 		cv->u = (vtx->u_name);\
 		cv->v = (vtx->v_name);
 
+		//v is in the lower 16 bits, u in the upper 16 bits
+	#define vert_uv_16_(to_u,to_v,v_name) \
+		{ \
+		u32 uv; \
+		memcpy(&uv, &vtx->v_name, sizeof(uv)); \
+		u32 u = uv & 0xffff0000; \
+		uv <<= 16; \
+		memcpy(&to_u, &u, sizeof(u)); \
+		memcpy(&to_v, &uv, sizeof(uv)); \
+		}
+
 	#define vert_uv_16(u_name,v_name) \
-		cv->u = f16(vtx->u_name);\
-		cv->v = f16(vtx->v_name);
+		vert_uv_16_(cv->u,cv->v,v_name)
 
 	#define vert_uv1_32(u_name,v_name) \
-		cv->u1 = (vtx->u_name);\
-		cv->v1 = (vtx->v_name);
+		cv1->u1 = (vtx->u_name);\
+		cv1->v1 = (vtx->v_name);
 
 	#define vert_uv1_16(u_name,v_name) \
-		cv->u1 = f16(vtx->u_name);\
-		cv->v1 = f16(vtx->v_name);
+		vert_uv_16_(cv1->u1,cv1->v1,v_name)
 
 		//Color conversions
 	#define vert_packed_color_(to,src) \
 		{ \
-		u32 t=src; \
-		to[Blue] = (u8)(t);t>>=8;\
-		to[Green] = (u8)(t);t>>=8;\
-		to[Red] = (u8)(t);t>>=8;\
-		to[Alpha] = (u8)(t);      \
+		u32 t = packedColor<Red, Green, Blue, Alpha>(src); \
+		memcpy(to, &t, sizeof(t)); \
 		}
 
-	#define vert_float_color_(to,a,r,g,b) \
-		to[Red] = float_to_satu8(r); \
-		to[Green] = float_to_satu8(g); \
-		to[Blue] = float_to_satu8(b); \
-		to[Alpha] = float_to_satu8(a);
+		//Base and offset colors at once
+	#define vert_packed_colors_(to,src) \
+		{ \
+		u64 t; \
+		memcpy(&t, &src, sizeof(t)); \
+		t = packedColors<Red, Green, Blue, Alpha>(t); \
+		memcpy(to, &t, sizeof(t)); \
+		}
 
 		//Macros to make thins easier ;)
 	#define vert_packed_color(to,src) \
 		vert_packed_color_(cv->to,vtx->src);
 
+	#define vert_packed_color1(to,src) \
+		vert_packed_color_(cv1->to,vtx->src);
+
+	#define vert_packed_colors(base_src) \
+		vert_packed_colors_(cv->col,vtx->base_src);
+
+	#define vert_packed_colors1(base_src) \
+		vert_packed_colors_(cv1->col1,vtx->base_src);
+
 	#define vert_float_color(to,src) \
-		vert_float_color_(cv->to,vtx->src##A,vtx->src##R,vtx->src##G,vtx->src##B)
+		{ \
+		u32 t = floatColor<Red, Green, Blue, Alpha>(&vtx->src##A); \
+		memcpy(cv->to, &t, sizeof(t)); \
+		}
+
+	#define vert_float_colors(base_src) \
+		{ \
+		u64 t = floatColors<Red, Green, Blue, Alpha>(&vtx->base_src##A); \
+		memcpy(cv->col, &t, sizeof(t)); \
+		}
 
 		//Intensity handling
 
 		//Notes:
 		//Alpha doesn't get intensity
 		//Intensity is clamped before the mul, as well as on face color to work the same as the hardware. [Fixes red dog]
+	#define vert_face_color_(to,face,intensity) \
+		{ \
+		u32 t = intensityColor(face, float_to_satu8(vtx->intensity)); \
+		memcpy(to, &t, sizeof(t)); \
+		}
 
 	#define vert_face_base_color(baseint) \
-		{ u32 satint = float_to_satu8(vtx->baseint); \
-		cv->col[Red] = FaceBaseColor[Red] * satint / 256;  \
-		cv->col[Green] = FaceBaseColor[Green] * satint / 256;  \
-		cv->col[Blue] = FaceBaseColor[Blue] * satint / 256;  \
-		cv->col[Alpha] = FaceBaseColor[Alpha]; }
+		vert_face_color_(cv->col,FaceBaseColor,baseint)
 
 	#define vert_face_offs_color(offsint) \
-		{ u32 satint = float_to_satu8(vtx->offsint); \
-		cv->spc[Red] = FaceOffsColor[Red] * satint / 256;  \
-		cv->spc[Green] = FaceOffsColor[Green] * satint / 256;  \
-		cv->spc[Blue] = FaceOffsColor[Blue] * satint / 256;  \
-		cv->spc[Alpha] = FaceOffsColor[Alpha]; }
+		vert_face_color_(cv->spc,FaceOffsColor,offsint)
 
 	#define vert_face_base_color1(baseint) \
-		{ u32 satint = float_to_satu8(vtx->baseint); \
-		cv->col1[Red] = FaceBaseColor1[Red] * satint / 256;  \
-		cv->col1[Green] = FaceBaseColor1[Green] * satint / 256;  \
-		cv->col1[Blue] = FaceBaseColor1[Blue] * satint / 256;  \
-		cv->col1[Alpha] = FaceBaseColor1[Alpha]; }
+		vert_face_color_(cv1->col1,FaceBaseColor1,baseint)
 
 	#define vert_face_offs_color1(offsint) \
-		{ u32 satint = float_to_satu8(vtx->offsint); \
-		cv->spc1[Red] = FaceOffsColor1[Red] * satint / 256;  \
-		cv->spc1[Green] = FaceOffsColor1[Green] * satint / 256;  \
-		cv->spc1[Blue] = FaceOffsColor1[Blue] * satint / 256;  \
-		cv->spc1[Alpha] = FaceOffsColor1[Alpha]; }
+		vert_face_color_(cv1->spc1,FaceOffsColor1,offsint)
 
+	// Base and offset colors, and base1 and offset1 colors are written together
+	static_assert(offsetof(Vertex, spc) == offsetof(Vertex, col) + 4);
+	static_assert(offsetof(VertexTwoVolumes, spc1) == offsetof(VertexTwoVolumes, col1) + 4);
+	// Alpha isn't modulated by intensity
+	static_assert(Alpha == 3);
 
 	//(Non-Textured, Packed Color)
 	static void AppendPolyVertex0(TA_Vertex0* vtx)
@@ -771,8 +967,7 @@ private:
 	{
 		vert_cvt_base;
 
-		vert_packed_color(col,BaseCol);
-		vert_packed_color(spc,OffsCol);
+		vert_packed_colors(BaseCol);
 
 		vert_uv_32(u,v);
 	}
@@ -782,8 +977,7 @@ private:
 	{
 		vert_cvt_base;
 
-		vert_packed_color(col,BaseCol);
-		vert_packed_color(spc,OffsCol);
+		vert_packed_colors(BaseCol);
 
 		vert_uv_16(u,v);
 	}
@@ -802,8 +996,7 @@ private:
 	{
 		vert_res_base;
 
-		vert_float_color(col,Base);
-		vert_float_color(spc,Offs);
+		vert_float_colors(Base);
 	}
 
 	//(Textured, Floating Color, 16bit UV)
@@ -820,8 +1013,7 @@ private:
 	{
 		vert_res_base;
 
-		vert_float_color(col,Base);
-		vert_float_color(spc,Offs);
+		vert_float_colors(Base);
 	}
 
 	//(Textured, Intensity)
@@ -853,7 +1045,8 @@ private:
 		vert_cvt_base;
 
 		vert_packed_color(col,BaseCol0);
-		vert_packed_color(col1, BaseCol1);
+		vert_two_volumes_base;
+		vert_packed_color1(col1, BaseCol1);
 	}
 
 	//(Non-Textured, Intensity,	with Two Volumes)
@@ -862,6 +1055,7 @@ private:
 		vert_cvt_base;
 
 		vert_face_base_color(BaseInt0);
+		vert_two_volumes_base;
 		vert_face_base_color1(BaseInt1);
 	}
 
@@ -870,18 +1064,16 @@ private:
 	{
 		vert_cvt_base;
 
-		vert_packed_color(col,BaseCol0);
-		vert_packed_color(spc,OffsCol0);
+		vert_packed_colors(BaseCol0);
 
 		vert_uv_32(u0,v0);
 	}
 
 	static void AppendPolyVertex11B(TA_Vertex11B* vtx)
 	{
-		vert_res_base;
+		vert_two_volumes_base;
 
-		vert_packed_color(col1, BaseCol1);
-		vert_packed_color(spc1, OffsCol1);
+		vert_packed_colors1(BaseCol1);
 
 		vert_uv1_32(u1, v1);
 	}
@@ -891,18 +1083,16 @@ private:
 	{
 		vert_cvt_base;
 
-		vert_packed_color(col,BaseCol0);
-		vert_packed_color(spc,OffsCol0);
+		vert_packed_colors(BaseCol0);
 
 		vert_uv_16(u0,v0);
 	}
 
 	static void AppendPolyVertex12B(TA_Vertex12B* vtx)
 	{
-		vert_res_base;
+		vert_two_volumes_base;
 
-		vert_packed_color(col1, BaseCol1);
-		vert_packed_color(spc1, OffsCol1);
+		vert_packed_colors1(BaseCol1);
 
 		vert_uv1_16(u1, v1);
 	}
@@ -920,7 +1110,7 @@ private:
 
 	static void AppendPolyVertex13B(TA_Vertex13B* vtx)
 	{
-		vert_res_base;
+		vert_two_volumes_base;
 
 		vert_face_base_color1(BaseInt1);
 		vert_face_offs_color1(OffsInt1);
@@ -941,7 +1131,7 @@ private:
 
 	static void AppendPolyVertex14B(TA_Vertex14B* vtx)
 	{
-		vert_res_base;
+		vert_two_volumes_base;
 
 		vert_face_base_color1(BaseInt1);
 		vert_face_offs_color1(OffsInt1);
@@ -1150,14 +1340,314 @@ private:
 	}
 };
 
+//
+// Cache of the parser output of TA lists that are sent unchanged over several frames
+// (HUDs, backgrounds, menus...)
+// Each list, from an idle parser state to the next end of list, is identified by the hash
+// of its TA data and of the parser state. Lists are added to the cache the second time
+// they are seen.
+//
+class TAListCache
+{
+public:
+	void parse(Ta_Dma *data, Ta_Dma *data_end, rend_context& rc);
+	void endFrame();
+
+private:
+	using Clock = std::chrono::steady_clock;
+
+	struct Entry
+	{
+		std::vector<u8> taData;
+		BaseTAParser::State exitState;
+		std::vector<PolyParam> globalParams[3];	// op, pt, tr
+		std::vector<ModifierVolumeParam> modVolParams[2];	// op, tr
+		std::vector<Vertex> verts;
+		std::vector<VertexTwoVolumes> vertsTwoVolumes;
+		std::vector<ModTriangle> modtrig;
+		float zMax;
+		Clock::duration parseTime;
+		u32 lastUsed;
+		u64 headHash;
+
+		size_t size() const {
+			size_t size = taData.size() + verts.size() * sizeof(Vertex) + vertsTwoVolumes.size() * sizeof(VertexTwoVolumes)
+					+ modtrig.size() * sizeof(ModTriangle);
+			for (const auto& params : globalParams)
+				size += params.size() * sizeof(PolyParam);
+			for (const auto& params : modVolParams)
+				size += params.size() * sizeof(ModifierVolumeParam);
+			return size;
+		}
+	};
+	// Sizes of the context output before parsing a list
+	struct Sizes
+	{
+		size_t globalParams[3];
+		size_t modVolParams[2];
+		size_t verts;
+		size_t modtrig;
+	};
+
+	static std::vector<PolyParam> *globalParams(rend_context& rc, int i) {
+		return i == 0 ? &rc.global_param_op : i == 1 ? &rc.global_param_pt : &rc.global_param_tr;
+	}
+	static std::vector<ModifierVolumeParam> *modVolParams(rend_context& rc, int i) {
+		return i == 0 ? &rc.global_param_mvo : &rc.global_param_mvo_tr;
+	}
+	static u64 stateHash(const BaseTAParser::State& state) {
+		// Color order depends on the renderer
+		return XXH64(&state, sizeof(state), isDirectX(config::RendererType));
+	}
+	static Sizes getSizes(rend_context& rc);
+	bool splice(Ta_Dma *& data, Ta_Dma *data_end, rend_context& rc);
+	void add(const Ta_Dma *data, const Ta_Dma *end, u64 stateHash, const Sizes& sizes, float zMax,
+			Clock::duration parseTime, rend_context& rc);
+
+	static constexpr size_t MaxCacheSize = 32_MB;
+	static constexpr u32 MaxLengthsPerHead = 4;
+	static constexpr u32 MaxUnusedFrames = 60;
+
+	std::unordered_map<u64, Entry> entries;
+	// Lengths of the cached lists, indexed by the hash of their first parameter
+	std::unordered_map<u64, std::vector<u32>> lengths;
+	// Lists seen once
+	std::unordered_set<u64> seen;
+	size_t cacheSize = 0;
+	u32 frame = 0;
+
+	// Stats
+	u32 hits = 0;
+	u32 misses = 0;
+	Clock::duration savedTime {};
+};
+
+static TAListCache taListCache;
+
+TAListCache::Sizes TAListCache::getSizes(rend_context& rc)
+{
+	Sizes sizes;
+	for (int i = 0; i < 3; i++)
+		sizes.globalParams[i] = globalParams(rc, i)->size();
+	for (int i = 0; i < 2; i++)
+		sizes.modVolParams[i] = modVolParams(rc, i)->size();
+	sizes.verts = rc.verts.size();
+	sizes.modtrig = rc.modtrig.size();
+	return sizes;
+}
+
+void TAListCache::parse(Ta_Dma *data, Ta_Dma *data_end, rend_context& rc)
+{
+	BaseTAParser::stopAtEndOfList = true;
+	while (data < data_end)
+	{
+		const bool idle = BaseTAParser::isIdle();
+		if (idle && splice(data, data_end, rc))
+			continue;
+
+		Ta_Dma *listStart = data;
+		u64 listStateHash = stateHash(BaseTAParser::getState());
+		Sizes sizes = getSizes(rc);
+		// Record the max z of this list only
+		float zMax = rc.fZ_max;
+		rc.fZ_max = 0.f;
+		Clock::time_point start = Clock::now();
+		try {
+			data = BaseTAParser::TaCmd(data, data_end);
+		} catch (const TAParserException& e) {
+			rc.fZ_max = std::max(rc.fZ_max, zMax);
+			break;
+		}
+		Clock::duration parseTime = Clock::now() - start;
+		std::swap(zMax, rc.fZ_max);
+		rc.fZ_max = std::max(rc.fZ_max, zMax);
+		if (idle && BaseTAParser::isIdle())
+			add(listStart, data, listStateHash, sizes, zMax, parseTime, rc);
+	}
+	BaseTAParser::stopAtEndOfList = false;
+}
+
+bool TAListCache::splice(Ta_Dma *& data, Ta_Dma *data_end, rend_context& rc)
+{
+	if (entries.empty())
+		return false;
+	Clock::time_point start = Clock::now();
+	const u64 seed = stateHash(BaseTAParser::getState());
+	const size_t available = (u8 *)data_end - (u8 *)data;
+	auto it = lengths.find(XXH64(data, std::min<size_t>(available, sizeof(Ta_Dma)), seed));
+	if (it == lengths.end())
+		return false;
+	for (u32 length : it->second)
+	{
+		if (length > available)
+			continue;
+		auto entryIt = entries.find(XXH64(data, length, seed));
+		if (entryIt == entries.end())
+			continue;
+		Entry& entry = entryIt->second;
+		if (entry.taData.size() != length || memcmp(entry.taData.data(), data, length) != 0)
+			continue;
+
+		const u32 vtxBase = rc.verts.size();
+		const u32 modtrigBase = rc.modtrig.size();
+		for (int i = 0; i < 3; i++)
+		{
+			std::vector<PolyParam>& list = *globalParams(rc, i);
+			for (PolyParam pp : entry.globalParams[i])
+			{
+				pp.first += vtxBase;
+				// Textures may have been updated or deleted
+				if (pp.pcw.Texture && BaseTAParser::fetchTextures)
+				{
+					pp.texture = renderer->GetTexture(pp.tsp, pp.tcw);
+					if (pp.tsp1.full != (u32)-1)
+						pp.texture1 = renderer->GetTexture(pp.tsp1, pp.tcw1);
+				}
+				list.push_back(pp);
+			}
+		}
+		for (int i = 0; i < 2; i++)
+		{
+			std::vector<ModifierVolumeParam>& list = *modVolParams(rc, i);
+			for (ModifierVolumeParam mvp : entry.modVolParams[i])
+			{
+				mvp.first += modtrigBase;
+				list.push_back(mvp);
+			}
+		}
+		rc.verts.insert(rc.verts.end(), entry.verts.begin(), entry.verts.end());
+		if (!entry.vertsTwoVolumes.empty())
+		{
+			rc.vertsTwoVolumes.resize(vtxBase);
+			rc.vertsTwoVolumes.insert(rc.vertsTwoVolumes.end(), entry.vertsTwoVolumes.begin(), entry.vertsTwoVolumes.end());
+		}
+		rc.modtrig.insert(rc.modtrig.end(), entry.modtrig.begin(), entry.modtrig.end());
+		rc.fZ_max = std::max(rc.fZ_max, entry.zMax);
+		BaseTAParser::setState(entry.exitState);
+
+		data = (Ta_Dma *)((u8 *)data + length);
+		entry.lastUsed = frame;
+		hits++;
+		savedTime += entry.parseTime - (Clock::now() - start);
+		return true;
+	}
+	return false;
+}
+
+void TAListCache::add(const Ta_Dma *data, const Ta_Dma *end, u64 stateHash, const Sizes& sizes, float zMax,
+		Clock::duration parseTime, rend_context& rc)
+{
+	misses++;
+	const u32 length = (const u8 *)end - (const u8 *)data;
+	if (length == 0)
+		return;
+	const u64 hash = XXH64(data, length, stateHash);
+	if (seen.insert(hash).second)
+	{
+		// Only cache lists that are seen at least twice
+		if (seen.size() > 4096)
+			seen.clear();
+		return;
+	}
+	seen.erase(hash);
+	if (cacheSize + length > MaxCacheSize)
+		return;
+	const u64 headHash = XXH64(data, std::min<size_t>(length, sizeof(Ta_Dma)), stateHash);
+	std::vector<u32>& headLengths = lengths[headHash];
+	if (headLengths.size() >= MaxLengthsPerHead)
+		return;
+	if (entries.count(hash) != 0)
+		// Hash collision
+		return;
+
+	Entry entry;
+	entry.taData.assign((const u8 *)data, (const u8 *)end);
+	entry.exitState = BaseTAParser::getState();
+	for (int i = 0; i < 3; i++)
+	{
+		const std::vector<PolyParam>& list = *globalParams(rc, i);
+		entry.globalParams[i].assign(list.begin() + sizes.globalParams[i], list.end());
+		for (PolyParam& pp : entry.globalParams[i])
+		{
+			pp.first -= sizes.verts;
+			pp.texture = nullptr;
+			pp.texture1 = nullptr;
+		}
+	}
+	for (int i = 0; i < 2; i++)
+	{
+		const std::vector<ModifierVolumeParam>& list = *modVolParams(rc, i);
+		entry.modVolParams[i].assign(list.begin() + sizes.modVolParams[i], list.end());
+		for (ModifierVolumeParam& mvp : entry.modVolParams[i])
+			mvp.first -= sizes.modtrig;
+	}
+	entry.verts.assign(rc.verts.begin() + sizes.verts, rc.verts.end());
+	if (rc.vertsTwoVolumes.size() > sizes.verts)
+	{
+		rc.alignVertexStreams();
+		entry.vertsTwoVolumes.assign(rc.vertsTwoVolumes.begin() + sizes.verts, rc.vertsTwoVolumes.end());
+	}
+	entry.modtrig.assign(rc.modtrig.begin() + sizes.modtrig, rc.modtrig.end());
+	entry.zMax = zMax;
+	entry.parseTime = parseTime;
+	entry.lastUsed = frame;
+	entry.headHash = headHash;
+	const size_t size = entry.size();
+	if (cacheSize + size > MaxCacheSize)
+		return;
+	if (std::find(headLengths.begin(), headLengths.end(), length) == headLengths.end())
+		headLengths.push_back(length);
+	entries.emplace(hash, std::move(entry));
+	cacheSize += size;
+}
+
+void TAListCache::endFrame()
+{
+	if (hits + misses != 0)
+		DEBUG_LOG(PVR, "TA list cache: %d/%d hits, %.3f ms saved, %d entries %d KB", hits, hits + misses,
+				std::chrono::duration<float, std::milli>(savedTime).count(), (int)entries.size(), (int)(cacheSize / 1024));
+	hits = 0;
+	misses = 0;
+	savedTime = {};
+	frame++;
+	bool evicted = false;
+	for (auto it = entries.begin(); it != entries.end(); )
+	{
+		if (frame - it->second.lastUsed > MaxUnusedFrames)
+		{
+			cacheSize -= it->second.size();
+			it = entries.erase(it);
+			evicted = true;
+		}
+		else {
+			++it;
+		}
+	}
+	if (evicted)
+	{
+		lengths.clear();
+		for (const auto& [hash, entry] : entries)
+		{
+			std::vector<u32>& headLengths = lengths[entry.headHash];
+			if (std::find(headLengths.begin(), headLengths.end(), entry.taData.size()) == headLengths.end())
+				headLengths.push_back(entry.taData.size());
+		}
+	}
+}
+
 static void getRegionTileClipping(u32& xmin, u32& xmax, u32& ymin, u32& ymax);
 static void getRegionSettings(int passNumber, RenderPass& pass);
 
-static void parseRenderPass(RenderPass& pass, const RenderPass& previousPass, rend_context& ctx, bool primRestart)
+static bool isPerPixelSorting()
 {
-	const bool perPixel = config::RendererType == RenderType::OpenGL_OIT
+	return config::RendererType == RenderType::OpenGL_OIT
 			|| config::RendererType == RenderType::DirectX11_OIT
 			|| config::RendererType == RenderType::Vulkan_OIT;
+}
+
+static void parseRenderPass(RenderPass& pass, const RenderPass& previousPass, rend_context& ctx, bool primRestart)
+{
+	const bool perPixel = isPerPixelSorting();
 	const bool mergeTranslucent = config::PerStripSorting || perPixel;
 
 	if (config::RenderResolution > 480 && !config::EmulateFramebuffer && config::FixUpscaleBleedingEdge)
@@ -1177,14 +1667,9 @@ static void parseRenderPass(RenderPass& pass, const RenderPass& previousPass, re
 		makeIndex(ctx.global_param_pt, previousPass.pt_count, pass.pt_count, true, ctx);
 	}
 	pass.sorted_tr_count = previousPass.sorted_tr_count;
-	if (pass.autosort && !perPixel)
-	{
-		if (config::PerStripSorting)
-			sortPolyParams(ctx.global_param_tr, previousPass.tr_count, pass.tr_count, ctx);
-		else
-			sortTriangles(ctx, pass, previousPass);
-	}
-	// sortTriangles already created the index
+	if (pass.autosort && !perPixel && config::PerStripSorting)
+		sortPolyParams(ctx.global_param_tr, previousPass.tr_count, pass.tr_count, ctx);
+	// sortTriangles creates the index once all passes are parsed
 	if (!pass.autosort || perPixel || config::PerStripSorting)
 	{
 		if (primRestart)
@@ -1214,12 +1699,15 @@ static void ta_parse_vdrc(TA_context* ctx, bool primRestart)
 		Ta_Dma* ta_data = (Ta_Dma *)childCtx->getTADataBegin();
 		Ta_Dma* ta_data_end = (Ta_Dma *)childCtx->getTADataEnd();
 
-		while (ta_data < ta_data_end)
-			try {
-				ta_data = BaseTAParser::TaCmd(ta_data, ta_data_end);
-			} catch (const TAParserException& e) {
-				break;
-			}
+		if (config::CacheTALists)
+			taListCache.parse(ta_data, ta_data_end, vd_rc);
+		else
+			while (ta_data < ta_data_end)
+				try {
+					ta_data = BaseTAParser::TaCmd(ta_data, ta_data_end);
+				} catch (const TAParserException& e) {
+					break;
+				}
 
 		// Disable blending for opaque polys of the first pass
 		if (pass == 0)
@@ -1260,6 +1748,8 @@ static void ta_parse_vdrc(TA_context* ctx, bool primRestart)
 	vd_rc.fb_Y_CLIP.min = std::max(vd_rc.fb_Y_CLIP.min, ymin);
 	vd_rc.fb_Y_CLIP.max = std::min(vd_rc.fb_Y_CLIP.max, ymax + 31);
 
+	if (config::CacheTALists)
+		taListCache.endFrame();
 	vd_ctx = nullptr;
 }
 
@@ -1318,6 +1808,11 @@ void ta_parse(TA_context *ctx, bool primRestart)
 		ta_parse_naomi2(ctx, primRestart);
 	else
 		ta_parse_vdrc(ctx, primRestart);
+	if (!isPerPixelSorting() && !config::PerStripSorting)
+		sortTriangles(ctx->rend);
+	ctx->rend.alignVertexStreams();
+	DEBUG_LOG(PVR, "Vertex data: %d vertices, %d bytes (%d bytes saved)", (int)ctx->rend.verts.size(),
+			(int)ctx->rend.vertexDataSize(), (int)(ctx->rend.verts.size() * sizeof(N2Vertex) - ctx->rend.vertexDataSize()));
 }
 
 //
@@ -1401,9 +1896,13 @@ void ta_add_poly(int listType, const ModifierVolumeParam& mvp)
 	vd_ctx = nullptr;
 }
 
-void ta_add_vertex(const Vertex& vtx)
+void ta_add_vertex(const N2Vertex& vtx)
 {
-	ta_ctx->rend.verts.push_back(vtx);
+	rend_context& rc = ta_ctx->rend;
+	rc.verts.push_back(vtx);
+	// Elan polygons use all the vertex attributes
+	rc.lastTwoVolumes() = vtx;
+	rc.lastNormal() = vtx;
 	n2CurrentPP->count++;
 }
 
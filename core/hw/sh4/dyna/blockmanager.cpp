@@ -203,6 +203,11 @@ void bm_DiscardBlock(RuntimeBlockInfo* block)
 
 	blkmap.erase(it);
 
+	// The code of the block may be reused so it must not be relinked when its successors are discarded
+	if (block_ptr->pNextBlock != nullptr)
+		block_ptr->pNextBlock->RemRef(block_ptr);
+	if (block_ptr->pBranchBlock != nullptr)
+		block_ptr->pBranchBlock->RemRef(block_ptr);
 	block_ptr->pNextBlock = NULL;
 	block_ptr->pBranchBlock = NULL;
 	block_ptr->Relink();
@@ -218,9 +223,33 @@ void bm_DiscardBlock(RuntimeBlockInfo* block)
 	block_ptr->Discard();
 }
 
+u32 bm_DiscardCodeRange(void *start, u32 size)
+{
+	std::vector<RuntimeBlockInfo *> blocks;
+	for (auto it = blkmap.lower_bound(start); it != blkmap.end() && it->first < (u8 *)start + size; ++it)
+		blocks.push_back(it->second.get());
+	for (RuntimeBlockInfo *block : blocks)
+		bm_DiscardBlock(block);
+	return blocks.size();
+}
+
+// Logs the code cache statistics when blocks have been compiled since the last time
+static void logCodeCacheStats()
+{
+	static u32 lastCompiledBlocks;
+	const CodeCacheStats& stats = rdv_CodeCacheStats();
+	if (stats.compiledBlocks == lastCompiledBlocks)
+		return;
+	lastCompiledBlocks = stats.compiledBlocks;
+	DEBUG_LOG(DYNAREC, "Code cache: %u blocks compiled in %.1f ms, max %.3f ms, %u evictions of %u blocks, %u flushes",
+			stats.compiledBlocks, stats.compileTime * 1000.0, stats.maxCompileTime * 1000.0,
+			stats.evictions, stats.evictedBlocks, stats.flushes);
+}
+
 void bm_Periodical_1s()
 {
 	bm_CleanupDeletedBlocks();
+	logCodeCacheStats();
 }
 
 void bm_vmem_pagefill(void** ptr, u32 size_bytes)
@@ -282,7 +311,6 @@ void bm_UnlockPage(u32 addr, u32 size)
 
 void bm_ResetCache()
 {
-	sh4Dynarec->reset();
 	addrspace::bm_reset();
 
 	for (const auto& it : blkmap)
@@ -77,6 +77,8 @@ RuntimeBlockInfoPtr DYNACALL bm_GetBlock(u32 addr);
 
 void bm_AddBlock(RuntimeBlockInfo* blk);
 void bm_DiscardBlock(RuntimeBlockInfo* block);
+// Discards the blocks whose code starts in the given range and returns their number
+u32 bm_DiscardCodeRange(void *start, u32 size);
 void bm_Reset();
 void bm_ResetCache();
 void bm_ResetTempCache(bool full);
@@ -60,6 +60,8 @@ static void Emit(shilop op, shil_param rd = shil_param(), shil_param rs1 = shil_
 	blk->oplist.push_back(sp);
 }
 
+static bool dec_generic(u32 op);
+
 static void dec_fallback(u32 op)
 {
 	shil_opcode opcd;
@@ -297,6 +299,35 @@ sh4dec(i0000_0000_0000_1001)
 {
 }
 
+// Cache operations are only emulated with the cache model
+//ocbi @<REG_N>
+sh4dec(i0000_nnnn_1001_0011)
+{
+	if (cacheModelEnabled)
+		dec_fallback(op);
+}
+
+//ocbp @<REG_N>
+sh4dec(i0000_nnnn_1010_0011)
+{
+	if (cacheModelEnabled)
+		dec_fallback(op);
+}
+
+//ocbwb @<REG_N>
+sh4dec(i0000_nnnn_1011_0011)
+{
+	if (cacheModelEnabled)
+		dec_fallback(op);
+}
+
+//pref @<REG_N>
+sh4dec(i0000_nnnn_1000_0011)
+{
+	if (cacheModelEnabled || !dec_generic(op))
+		dec_fallback(op);
+}
+
 //fschg
 sh4dec(i1111_0011_1111_1101)
 {
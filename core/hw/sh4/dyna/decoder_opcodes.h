@@ -25,6 +25,10 @@ sh4dec(i0011_nnnn_mmmm_1000);
 sh4dec(i0011_nnnn_mmmm_1100);
 sh4dec(i0111_nnnn_iiii_iiii);
 sh4dec(i0000_0000_0000_1001);
+sh4dec(i0000_nnnn_1001_0011);
+sh4dec(i0000_nnnn_1010_0011);
+sh4dec(i0000_nnnn_1011_0011);
+sh4dec(i0000_nnnn_1000_0011);
 sh4dec(i1111_0011_1111_1101);
 sh4dec(i1111_1011_1111_1101);
 sh4dec(i0100_nnnn_0010_0100);
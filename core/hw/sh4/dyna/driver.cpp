@@ -1,4 +1,7 @@
 #include "types.h"
+#include <algorithm>
+#include <array>
+#include <chrono>
 #include <unordered_set>
 
 #include "hw/sh4/sh4_interpreter.h"
@@ -7,17 +10,28 @@
 
 #include "hw/sh4/sh4_mem.h"
 #include "hw/sh4/modules/mmu.h"
+#include "hw/sh4/sh4_cache.h"
 
 #include "blockmanager.h"
 #include "ngen.h"
 #include "decoder.h"
 #include "oslib/virtmem.h"
+#include "cfg/option.h"
 
 #if FEAT_SHREC != DYNAREC_NONE
 
+// Maximum size of the main code cache. The size in use is set by config::DynarecCodeCacheSize.
+#if HOST_CPU == CPU_ARM
+// Blocks are linked with branches that have a 32 MB range
 constexpr u32 CODE_SIZE = 10_MB;
+#else
+constexpr u32 CODE_SIZE = 32_MB;
+#endif
 constexpr u32 TEMP_CODE_SIZE = 1_MB;
 constexpr u32 FULL_SIZE = CODE_SIZE + TEMP_CODE_SIZE;
+// The main code cache is split into segments that are filled in turn. When the current one is full,
+// the next one, which holds the oldest blocks, is emptied and reused.
+constexpr u32 CODE_SEGMENTS = 8;
 
 #if defined(_WIN32) || FEAT_SHREC != DYNAREC_JIT || defined(TARGET_IPHONE) || defined(TARGET_ARM_MAC)
 static u8 *SH4_TCB;
@@ -40,10 +54,89 @@ ptrdiff_t cc_rx_offset;
 
 static std::unordered_set<u32> smc_hotspots;
 
+static u32 codeSize = CODE_SIZE;
+static u32 segmentSize = CODE_SIZE / CODE_SEGMENTS;
+static u32 currentSegment;
+// Offset of the first block in the code cache, after the main loop
+static u32 codeStart;
+static CodeCacheStats codeCacheStats;
+
 static sh4_if sh4Interp;
 static Sh4CodeBuffer codeBuffer;
 Sh4Dynarec *sh4Dynarec;
 
+// The registers to pin are re-evaluated every time this many blocks have been compiled
+constexpr u32 PIN_CHECK_INTERVAL = 4096;
+// Number of uses of r8 to r14 in compiled blocks since the last hard reset, older blocks weighing less
+static std::array<u32, reg_r14 - reg_r8 + 1> regUseCounts;
+static u32 compiledBlocks;
+static std::vector<Sh4RegType> pinnedRegs;
+static std::vector<Sh4RegType> nextPinnedRegs;
+u32 rdv_RepinRequest;
+
+const std::vector<Sh4RegType>& rdv_PinnedRegs()
+{
+	return pinnedRegs;
+}
+
+static void profileRegs(const RuntimeBlockInfo *block)
+{
+	auto countUse = [](const shil_param& param) {
+		if (param.is_r32i() && param._reg >= reg_r8 && param._reg <= reg_r14)
+			regUseCounts[param._reg - reg_r8]++;
+	};
+	for (const shil_opcode& op : block->oplist)
+	{
+		countUse(op.rs1);
+		countUse(op.rs2);
+		countUse(op.rs3);
+		countUse(op.rd);
+		countUse(op.rd2);
+	}
+}
+
+static u32 regUseWeight(const std::vector<Sh4RegType>& regs)
+{
+	u32 weight = 0;
+	for (Sh4RegType reg : regs)
+		weight += regUseCounts[reg - reg_r8];
+	return weight;
+}
+
+static void checkPinnedRegs()
+{
+	std::vector<Sh4RegType> regs;
+	const u32 count = config::DynarecPinRegisters ? sh4Dynarec->getPinnableRegCount() : 0;
+	if (count != 0)
+	{
+		for (int reg = reg_r8; reg <= reg_r14; reg++)
+			regs.push_back((Sh4RegType)reg);
+		std::stable_sort(regs.begin(), regs.end(), [](Sh4RegType a, Sh4RegType b) {
+			return regUseCounts[a - reg_r8] > regUseCounts[b - reg_r8];
+		});
+		regs.resize(std::min<size_t>(count, regs.size()));
+	}
+	// Changing the pinned regs flushes the code cache, so only do it for a significant gain
+	if (regs.size() != pinnedRegs.size() || regUseWeight(regs) > regUseWeight(pinnedRegs) * 5 / 4)
+	{
+		DEBUG_LOG(DYNAREC, "Pinned registers will change: %d regs, weight %d -> %d", (int)regs.size(),
+				regUseWeight(pinnedRegs), regUseWeight(regs));
+		nextPinnedRegs = regs;
+		rdv_RepinRequest = 1;
+	}
+	for (u32& useCount : regUseCounts)
+		useCount /= 2;
+}
+
+static void resetPinnedRegs()
+{
+	regUseCounts.fill(0);
+	compiledBlocks = 0;
+	pinnedRegs.clear();
+	nextPinnedRegs.clear();
+	rdv_RepinRequest = 0;
+}
+
 void *Sh4CodeBuffer::get()
 {
 	return tempBuffer ? &TempCodeCache[tempLastAddr] : &CodeCache[lastAddr];
@@ -62,7 +155,7 @@ u32 Sh4CodeBuffer::getFreeSpace()
 	if (tempBuffer)
 		return TEMP_CODE_SIZE - tempLastAddr;
 	else
-		return CODE_SIZE - lastAddr;
+		return lastAddrEnd - lastAddr;
 }
 
 void *Sh4CodeBuffer::getBase()
@@ -78,9 +171,20 @@ u32 Sh4CodeBuffer::getSize()
 void Sh4CodeBuffer::reset(bool temporary)
 {
 	if (temporary)
+	{
 		tempLastAddr = 0;
+	}
 	else
+	{
 		lastAddr = 0;
+		lastAddrEnd = segmentSize;
+	}
+}
+
+void Sh4CodeBuffer::setRange(u32 start, u32 end)
+{
+	lastAddr = start;
+	lastAddrEnd = end;
 }
 
 static void clear_temp_cache(bool full)
@@ -93,12 +197,37 @@ static void clear_temp_cache(bool full)
 static void recSh4_ClearCache()
 {
 	INFO_LOG(DYNAREC, "recSh4:Dynarec Cache clear at %08X free space %d", next_pc, codeBuffer.getFreeSpace());
+	codeCacheStats.flushes++;
+	codeSize = std::clamp<u32>(config::DynarecCodeCacheSize * 1_MB, 4_MB, CODE_SIZE);
+	segmentSize = (codeSize / CODE_SEGMENTS) & ~PAGE_MASK;
+	currentSegment = 0;
+	codeStart = 0;
 	codeBuffer.reset(false);
+	sh4Dynarec->reset();
 	bm_ResetCache();
 	smc_hotspots.clear();
 	clear_temp_cache(true);
 }
 
+// Evicts the blocks of the oldest segment and continues in it.
+// Blocks of this segment that are still in use are compiled again in it when next needed.
+static void nextCodeSegment()
+{
+	currentSegment = (currentSegment + 1) % CODE_SEGMENTS;
+	const u32 start = currentSegment == 0 ? codeStart : currentSegment * segmentSize;
+	const u32 end = currentSegment == CODE_SEGMENTS - 1 ? codeSize : (currentSegment + 1) * segmentSize;
+	const u32 blocks = bm_DiscardCodeRange(&CodeCache[start], end - start);
+	codeBuffer.setRange(start, end);
+	codeCacheStats.evictions++;
+	codeCacheStats.evictedBlocks += blocks;
+	DEBUG_LOG(DYNAREC, "Code cache segment %d evicted: %d blocks", currentSegment, blocks);
+}
+
+const CodeCacheStats& rdv_CodeCacheStats()
+{
+	return codeCacheStats;
+}
+
 static void recSh4_Run()
 {
 	sh4_int_bCpuRun = true;
@@ -107,7 +236,18 @@ static void recSh4_Run()
 	u8 *sh4_dyna_rcb = (u8 *)&Sh4cntx + sizeof(Sh4cntx);
 	INFO_LOG(DYNAREC, "cntx // fpcb offset: %td // pc offset: %td // pc %08X", (u8*)&sh4rcb.fpcb - sh4_dyna_rcb, (u8*)&sh4rcb.cntx.pc - sh4_dyna_rcb, sh4rcb.cntx.pc);
 	
-	sh4Dynarec->mainloop(sh4_dyna_rcb);
+	do {
+		// Pinned registers can only change while the main loop isn't running
+		rdv_RepinRequest = 0;
+		if (!config::DynarecPinRegisters)
+			nextPinnedRegs.clear();
+		if (nextPinnedRegs != pinnedRegs)
+		{
+			pinnedRegs = nextPinnedRegs;
+			recSh4_ClearCache();
+		}
+		sh4Dynarec->mainloop(sh4_dyna_rcb);
+	} while (rdv_RepinRequest != 0 && sh4_int_bCpuRun);
 
 	sh4_int_bCpuRun = false;
 }
@@ -170,9 +310,12 @@ bool RuntimeBlockInfo::Setup(u32 rpc,fpscr_t rfpu_cfg)
 DynarecCodeEntryPtr rdv_CompilePC(u32 blockcheck_failures)
 {
 	const u32 pc = next_pc;
+	const auto startTime = std::chrono::steady_clock::now();
 
-	if (codeBuffer.getFreeSpace() < 32_KB || pc == 0x8c0000e0 || pc == 0xac010000 || pc == 0xac008300)
+	if (pc == 0x8c0000e0 || pc == 0xac010000 || pc == 0xac008300)
 		recSh4_ClearCache();
+	else if (codeBuffer.getFreeSpace() < 32_KB)
+		nextCodeSegment();
 
 	RuntimeBlockInfo* rbi = sh4Dynarec->allocateBlock();
 
@@ -191,15 +334,25 @@ DynarecCodeEntryPtr rdv_CompilePC(u32 blockcheck_failures)
 		if (rbi->read_only)
 			INFO_LOG(DYNAREC, "WARNING: temp block %x (%x) is protected!", rbi->vaddr, rbi->addr);
 	}
+	profileRegs(rbi);
+	if (++compiledBlocks % PIN_CHECK_INTERVAL == 0)
+		checkPinnedRegs();
 	bool do_opts = !rbi->temp_block;
 	bool block_check = !rbi->read_only;
 	sh4Dynarec->compile(rbi, block_check, do_opts);
 	verify(rbi->code != nullptr);
+	if (codeStart == 0 && !rbi->temp_block)
+		codeStart = (u8 *)rbi->code - CodeCache;
 
 	bm_AddBlock(rbi);
 
 	codeBuffer.useTempBuffer(false);
 
+	const double time = std::chrono::duration<double>(std::chrono::steady_clock::now() - startTime).count();
+	codeCacheStats.compiledBlocks++;
+	codeCacheStats.compileTime += time;
+	codeCacheStats.maxCompileTime = std::max(codeCacheStats.maxCompileTime, time);
+
 	return rbi->code;
 }
 
@@ -299,6 +452,9 @@ void* DYNACALL rdv_LinkBlock(u8* code,u32 dpc)
 	}
 
 	DynarecCodeEntryPtr rv = rdv_FindOrCompile();  // Returns rx ptr
+	// The block may have been evicted to make room for the next one
+	if (!stale_block && bm_GetBlock(code) != rbi)
+		stale_block = true;
 
 	if (!mmu_enabled() && !stale_block)
 	{
@@ -354,6 +510,12 @@ static void recSh4_Step()
 static void recSh4_Reset(bool hard)
 {
 	sh4Interp.Reset(hard);
+	// Registers are profiled per game
+	if (hard)
+	{
+		resetPinnedRegs();
+		codeCacheStats = {};
+	}
 	recSh4_ClearCache();
 	if (hard)
 		bm_Reset();
@@ -381,7 +543,9 @@ static void recSh4_Init()
 	verify(CodeCache != nullptr);
 
 	TempCodeCache = CodeCache + CODE_SIZE;
+	codeBuffer.reset(false);
 	sh4Dynarec->init(codeBuffer);
+	sh4Dynarec->reset();
 	bm_ResetCache();
 }
 
@@ -447,6 +611,9 @@ static bool translateAddress(u32 addr, int size, u32 access, u32& outAddr, Runti
 
 bool rdv_readMemImmediate(u32 addr, int size, void*& ptr, bool& isRam, u32& physAddr, RuntimeBlockInfo* block)
 {
+	// Cached areas must be accessed through the cache model
+	if (cacheModelEnabled && cachedArea(addr >> 29))
+		return false;
 	size = std::min(size, 4);
 	if (!translateAddress(addr, size, MMU_TT_DREAD, physAddr, block))
 		return false;
@@ -457,6 +624,8 @@ bool rdv_readMemImmediate(u32 addr, int size, void*& ptr, bool& isRam, u32& phys
 
 bool rdv_writeMemImmediate(u32 addr, int size, void*& ptr, bool& isRam, u32& physAddr, RuntimeBlockInfo* block)
 {
+	if (cacheModelEnabled && cachedArea(addr >> 29))
+		return false;
 	size = std::min(size, 4);
 	if (!translateAddress(addr, size, MMU_TT_DWRITE, physAddr, block))
 		return false;
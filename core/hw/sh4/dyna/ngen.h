@@ -29,6 +29,23 @@ DynarecCodeEntryPtr rdv_CompilePC(u32 blockcheck_failures);
 DynarecCodeEntryPtr rdv_FindOrCompile();
 // Registers a custom FailedToFindBlock handler function
 void rdv_SetFailedToFindBlockHandler(void (*handler)());
+// Guest registers that the main loop and compiled blocks keep in host registers, most used first.
+// Only r8 to r14 can be pinned, and the list only changes when the main loop isn't running.
+const std::vector<Sh4RegType>& rdv_PinnedRegs();
+// Non-zero when the pinned registers should be changed. The main loop must then exit.
+extern u32 rdv_RepinRequest;
+
+// Code cache statistics since the last hard reset
+struct CodeCacheStats
+{
+	u32 flushes;			// the whole code cache was cleared
+	u32 evictions;			// a segment of the code cache was emptied to make room for new blocks
+	u32 evictedBlocks;
+	u32 compiledBlocks;
+	double compileTime;		// total time spent compiling, in seconds
+	double maxCompileTime;	// longest time taken by a single compilation, including the eviction or flush it caused
+};
+const CodeCacheStats& rdv_CodeCacheStats();
 
 //code -> pointer to code of block, dpc -> if dynamic block, pc. if cond, 0 for next, 1 for branch
 void* DYNACALL rdv_LinkBlock(u8* code,u32 dpc);
@@ -73,9 +90,12 @@ public:
 	void useTempBuffer(bool enable) { tempBuffer = enable; }
 	// Reset main or temp code buffer position to 0 (internal use)
 	void reset(bool temporary);
+	// Continue emitting main code at offset 'start', up to offset 'end' (internal use)
+	void setRange(u32 start, u32 end);
 
 private:
 	u32 lastAddr = 0;
+	u32 lastAddrEnd = 0;
 	u32 tempLastAddr = 0;
 	bool tempBuffer = false;
 };
@@ -91,6 +111,8 @@ public:
 	virtual void compile(RuntimeBlockInfo* block, bool smc_checks, bool optimise) = 0;
 	// Signal the dynarec that the code buffer has been cleared. It should re-generate its main loop if needed.
 	virtual void reset() {}
+	// Return how many guest registers can be pinned to host registers. See rdv_PinnedRegs().
+	virtual u32 getPinnableRegCount() { return 0; }
 	// Run the code.
 	// cntx points right after the Sh4RCB struct, which corresponds to the start of the 512 MB virtual address space
 	// (if available).
@@ -41,6 +41,7 @@ public:
 #endif
 
 		ConstPropPass();
+		CoalesceMemOpsPass();
 		// This should only be done for ram/vram/aram access
 		// Disabled for now and probably not worth the trouble
 		//WriteAfterWritePass();
@@ -53,13 +54,16 @@ public:
 
 #if DEBUG
 		if (stats.prop_constants > 0 || stats.dead_code_ops > 0 || stats.constant_ops_replaced > 0
-				|| stats.dead_registers > 0 || stats.dyn_to_stat_blocks > 0 || stats.waw_blocks > 0 || stats.combined_shifts > 0)
+				|| stats.dead_registers > 0 || stats.dyn_to_stat_blocks > 0 || stats.waw_blocks > 0 || stats.combined_shifts > 0
+				|| stats.coalesced_mem_ops > 0)
 		{
 			//INFO_LOG(DYNAREC, "AFTER %08x", block->vaddr);
 			//PrintBlock();
-			INFO_LOG(DYNAREC, "STATS: %08x ops %zd constants %d constops replaced %d dead code %d dead regs %d dyn2stat blks %d waw %d shifts %d", block->vaddr, block->oplist.size(),
+			INFO_LOG(DYNAREC, "STATS: %08x ops %zd constants %d constops replaced %d dead code %d dead regs %d dyn2stat blks %d waw %d shifts %d mem ops coalesced %d",
+					block->vaddr, block->oplist.size(),
 					stats.prop_constants, stats.constant_ops_replaced,
-					stats.dead_code_ops, stats.dead_registers, stats.dyn_to_stat_blocks, stats.waw_blocks, stats.combined_shifts);
+					stats.dead_code_ops, stats.dead_registers, stats.dyn_to_stat_blocks, stats.waw_blocks, stats.combined_shifts,
+					stats.coalesced_mem_ops);
 		}
 #endif
 	}
@@ -691,6 +695,183 @@ private:
 		}
 	}
 
+	// Address of a memory access: register value + constant offset, or constant (base is NoReg)
+	struct MemAddress
+	{
+		RegValue base;
+		u32 offset = 0;
+		bool valid = false;
+	};
+	using OffsetMap = std::map<RegValue, std::pair<RegValue, u32>>;	// (reg, version) -> ((base reg, version), offset)
+
+	void TrackRegOffset(const shil_opcode& op, OffsetMap& offsets)
+	{
+		if (op.op == shop_ifb || op.op == shop_sync_sr)
+		{
+			// register versions aren't updated by these ops
+			offsets.clear();
+			return;
+		}
+		if (!op.rd.is_r32i() || !op.rs1.is_r32i())
+			return;
+		u32 offset;
+		if (op.op == shop_mov32)
+			offset = 0;
+		else if (op.op == shop_add && op.rs2.is_imm())
+			offset = op.rs2.imm_value();
+		else if (op.op == shop_sub && op.rs2.is_imm())
+			offset = -op.rs2.imm_value();
+		else
+			return;
+		RegValue base(op.rs1);
+		auto it = offsets.find(base);
+		if (it != offsets.end())
+		{
+			base = it->second.first;
+			offset += it->second.second;
+		}
+		offsets[RegValue(op.rd)] = std::make_pair(base, offset);
+	}
+
+	MemAddress GetMemAddress(const shil_opcode& op, const OffsetMap& offsets)
+	{
+		MemAddress addr;
+		if (op.rs3.is_reg())
+			return addr;
+		if (op.rs1.is_imm())
+		{
+			addr.base = RegValue(NoReg, 0);
+			addr.offset = op.rs1.imm_value();
+		}
+		else
+		{
+			addr.base = RegValue(op.rs1);
+			auto it = offsets.find(addr.base);
+			if (it != offsets.end())
+			{
+				addr.base = it->second.first;
+				addr.offset = it->second.second;
+			}
+		}
+		if (op.rs3.is_imm())
+			addr.offset += op.rs3.imm_value();
+		addr.valid = true;
+		return addr;
+	}
+
+	static bool IsFpuMemOp32(const shil_opcode& op)
+	{
+		return op.size == 4
+				&& ((op.op == shop_readm && op.rd.is_r32f()) || (op.op == shop_writem && op.rs2.is_r32f()));
+	}
+
+	static bool ParamCoversReg(const shil_param& param, Sh4RegType reg)
+	{
+		return param.is_reg() && reg >= param._reg && reg < (Sh4RegType)(param._reg + param.count());
+	}
+
+	// Combine two 32-bit fpu loads or stores at consecutive addresses into a 64-bit access to a register pair,
+	// like fmov.d does. Typically fmov.s @rm+ sequences and fpu register pushes/pops.
+	// Unlike fmov.d, the merged access may only be 4-byte aligned. The generic memory handlers and
+	// the store queue handlers split such accesses in two.
+	void CoalesceMemOpsPass()
+	{
+		if (mmu_enabled() || cacheModelEnabled)
+			// The mmu and the operand cache model only handle 8-byte aligned 64-bit accesses
+			return;
+		OffsetMap offsets;
+		for (int opnum = 0; opnum < (int)block->oplist.size(); opnum++)
+		{
+			TrackRegOffset(block->oplist[opnum], offsets);
+			if (!IsFpuMemOp32(block->oplist[opnum]))
+				continue;
+
+			// Find the next memory access
+			OffsetMap nextOffsets = offsets;
+			size_t nextnum = opnum + 1;
+			for (; nextnum < block->oplist.size(); nextnum++)
+			{
+				const shil_opcode& op = block->oplist[nextnum];
+				if (op.op == shop_readm || op.op == shop_writem || op.op == shop_ifb || op.op == shop_pref
+						|| op.op == shop_sync_sr || op.op == shop_sync_fpscr)
+					break;
+				TrackRegOffset(op, nextOffsets);
+			}
+			if (nextnum == block->oplist.size())
+				break;
+			shil_opcode& first = block->oplist[opnum];
+			shil_opcode& second = block->oplist[nextnum];
+			if (second.op != first.op || !IsFpuMemOp32(second))
+				continue;
+			const MemAddress firstAddr = GetMemAddress(first, offsets);
+			const MemAddress secondAddr = GetMemAddress(second, nextOffsets);
+			if (!firstAddr.valid || !secondAddr.valid || firstAddr.base != secondAddr.base)
+				continue;
+			const bool read = first.op == shop_readm;
+			const shil_param& firstReg = read ? first.rd : first.rs2;
+			const shil_param& secondReg = read ? second.rd : second.rs2;
+			const bool firstIsLow = secondAddr.offset - firstAddr.offset == 4;
+			if (!firstIsLow && firstAddr.offset - secondAddr.offset != 4)
+				continue;
+			// Accesses other than to the stack may have side effects so their order must be kept
+			if (!firstIsLow && firstAddr.base.get_reg() != reg_r15)
+				continue;
+			// Immediate addresses are resolved to a single memory handler at compile time
+			if (firstAddr.base.get_reg() == NoReg && ((firstIsLow ? firstAddr.offset : secondAddr.offset) & 7) != 0)
+				continue;
+			const shil_param& lowReg = firstIsLow ? firstReg : secondReg;
+			const shil_param& highReg = firstIsLow ? secondReg : firstReg;
+			if (((lowReg._reg - reg_fr_0) & 1) != 0 || highReg._reg != lowReg._reg + 1)
+				continue;
+
+			// Loads are done with the first op and stores with the second one,
+			// so the register moved must not be used or modified in between
+			const Sh4RegType movedReg = read ? secondReg._reg : firstReg._reg;
+			bool conflict = false;
+			for (size_t i = opnum + 1; i < nextnum && !conflict; i++)
+			{
+				const shil_opcode& op = block->oplist[i];
+				conflict = ParamCoversReg(op.rd, movedReg) || ParamCoversReg(op.rd2, movedReg)
+						|| (read && (ParamCoversReg(op.rs1, movedReg) || ParamCoversReg(op.rs2, movedReg) || ParamCoversReg(op.rs3, movedReg)));
+			}
+			if (conflict)
+				continue;
+
+			shil_param pair(lowReg._reg < reg_xf_0 ? (Sh4RegType)(regv_dr_0 + (lowReg._reg - reg_fr_0) / 2)
+					: (Sh4RegType)(regv_xd_0 + (lowReg._reg - reg_xf_0) / 2));
+			pair.version[0] = lowReg.version[0];
+			pair.version[1] = highReg.version[0];
+			shil_opcode& merged = read ? first : second;
+			const u32 delta = (firstIsLow ? firstAddr.offset : secondAddr.offset) - (read ? firstAddr.offset : secondAddr.offset);
+			if (read)
+				merged.rd = pair;
+			else
+				merged.rs2 = pair;
+			merged.size = 8;
+			if (delta != 0)
+			{
+				if (merged.rs1.is_imm())
+					merged.rs1._imm += delta;
+				else if (merged.rs3.is_imm())
+					merged.rs3._imm += delta;
+				else
+					merged.rs3 = shil_param(delta);
+				if (merged.rs3.is_imm() && merged.rs3.imm_value() == 0)
+					merged.rs3.type = FMT_NULL;
+			}
+			if (read)
+			{
+				block->oplist.erase(block->oplist.begin() + nextnum);
+			}
+			else
+			{
+				block->oplist.erase(block->oplist.begin() + opnum);
+				opnum--;
+			}
+			stats.coalesced_mem_ops++;
+		}
+	}
+
 	void WriteAfterWritePass()
 	{
 		for (int opnum = 0; opnum < (int)block->oplist.size() - 1; opnum++)
@@ -771,6 +952,7 @@ private:
 		u32 dyn_to_stat_blocks = 0;
 		u32 waw_blocks = 0;
 		u32 combined_shifts = 0;
+		u32 coalesced_mem_ops = 0;
 	} stats;
 
 	// transient vars
@@ -24,8 +24,8 @@
 #include "hw/sh4/modules/mmu.h"
 #include "ssa.h"
 
-#include <deque>
-#include <map>
+#include <algorithm>
+#include <array>
 #include <vector>
 
 #define ssa_printf(...) DEBUG_LOG(DYNAREC, __VA_ARGS__)
@@ -37,15 +37,25 @@ public:
 	RegAlloc() = default;
 	virtual ~RegAlloc() = default;
 
-	void DoAlloc(RuntimeBlockInfo* block, const nreg_t* regs_avail, const nregf_t* regsf_avail)
+	// Guest registers in 'pinned' are kept in the corresponding host register of 'pinned_host' across blocks.
+	// They are only written back and reloaded around ops that access them in memory.
+	void DoAlloc(RuntimeBlockInfo* block, const nreg_t* regs_avail, const nregf_t* regsf_avail,
+			const std::vector<Sh4RegType>& pinned = {}, const nreg_t* pinned_host = nullptr)
 	{
 		this->block = block;
 		SSAOptimizer optim(block);
 		optim.AddVersionPass();
 
+		for (size_t i = 0; i < pinned.size(); i++)
+		{
+			verify(pinned[i] < sh4_reg_count && !IsFloat(pinned[i]));
+			regs[pinned[i]].pinned = true;
+			regs[pinned[i]].host_reg = pinned_host[i];
+		}
 		verify(host_gregs.empty());
-		while (*regs_avail != (nreg_t)-1)
-			host_gregs.push_back(*regs_avail++);
+		for (; *regs_avail != (nreg_t)-1; regs_avail++)
+			if (std::find(pinned_host, pinned_host + pinned.size(), *regs_avail) == pinned_host + pinned.size())
+				host_gregs.push_back(*regs_avail);
 
 		verify(host_fregs.empty());
 		while (*regsf_avail != (nregf_t)-1)
@@ -58,10 +68,13 @@ public:
 		if (op->op == shop_ifb)
 		{
 			FlushAllRegs(true);
+			FlushPinnedRegs(true);
 		}
 		else if (mmu_enabled() && (op->op == shop_readm || op->op == shop_writem || op->op == shop_pref))
 		{
 			FlushAllRegs(false);
+			// The memory access may raise an exception, which reloads pinned regs
+			FlushPinnedRegs(false);
 		}
 		else if (op->op == shop_sync_sr)
 		{
@@ -106,7 +119,7 @@ public:
 			{
 				for (u32 i = 0; i < op->rd.count(); i++)
 				{
-					verify(reg_alloced.count((Sh4RegType)(op->rd._reg + i)) == 0 || !reg_alloced[(Sh4RegType)(op->rd._reg + i)].write_back);
+					verify(!regs[op->rd._reg + i].allocated || !regs[op->rd._reg + i].write_back);
 					FlushReg((Sh4RegType)(op->rd._reg + i), true);
 				}
 			}
@@ -114,7 +127,7 @@ public:
 			{
 				for (u32 i = 0; i < op->rd2.count(); i++)
 				{
-					verify(reg_alloced.count((Sh4RegType)(op->rd2._reg + i)) == 0 || !reg_alloced[(Sh4RegType)(op->rd2._reg + i)].write_back);
+					verify(!regs[op->rd2._reg + i].allocated || !regs[op->rd2._reg + i].write_back);
 					FlushReg((Sh4RegType)(op->rd2._reg + i), true);
 				}
 			}
@@ -128,23 +141,34 @@ public:
 	{
 		for (Sh4RegType reg : pending_flushes)
 		{
-			verify(!reg_alloced[reg].write_back);
-			reg_alloced.erase(reg);
+			verify(!regs[reg].write_back);
+			Release(reg);
 		}
 		pending_flushes.clear();
 
 		// Flush normally
-		for (auto const& reg : reg_alloced)
-			FlushReg(reg.first, false);
+		for (Sh4RegType reg : alloced)
+			FlushReg(reg, false);
+
+		// Reload the pinned regs that the op may have modified in memory
+		for (Sh4RegType reg : pending_reloads)
+		{
+			if (!DefsReg(op, reg, false) && !fast_forwarding)
+			{
+				ssa_printf("PL %s -> %cx (pinned)", name_reg(reg).c_str(), 'a' + regs[reg].host_reg);
+				Preload(reg, (nreg_t)regs[reg].host_reg);
+			}
+		}
+		pending_reloads.clear();
 
 		// Hard flush all dirty regs. Useful for troubleshooting
-//		while (!reg_alloced.empty())
+//		while (!alloced.empty())
 //		{
-//			auto it = reg_alloced.begin();
+//			Sh4RegType reg = alloced.front();
 //
-//			if (it->second.dirty)
-//				it->second.write_back = true;
-//			FlushReg(it->first, true);
+//			if (regs[reg].dirty)
+//				regs[reg].write_back = true;
+//			FlushReg(reg, true);
 //		}
 
 		// Final writebacks
@@ -230,16 +254,19 @@ public:
 
 	bool reg_used(nreg_t host_reg)
 	{
-		for (auto const& reg : reg_alloced)
-			if ((nreg_t)reg.second.host_reg == host_reg && !IsFloat(reg.first))
+		for (Sh4RegType reg : alloced)
+			if ((nreg_t)regs[reg].host_reg == host_reg && !IsFloat(reg))
+				return true;
+		for (int reg = reg_r0; reg <= reg_r15; reg++)
+			if (regs[reg].pinned && (nreg_t)regs[reg].host_reg == host_reg)
 				return true;
 		return false;
 	}
 
 	bool regf_used(nregf_t host_reg)
 	{
-		for (auto const& reg : reg_alloced)
-			if ((nregf_t)reg.second.host_reg == host_reg && IsFloat(reg.first))
+		for (Sh4RegType reg : alloced)
+			if ((nregf_t)regs[reg].host_reg == host_reg && IsFloat(reg))
 				return true;
 		return false;
 	}
@@ -248,11 +275,13 @@ public:
 		verify(final_opend || block->oplist.empty());
 		final_opend = false;
 		FlushAllRegs(true);
-		verify(reg_alloced.empty());
+		verify(alloced.empty());
 		verify(pending_flushes.empty());
+		verify(pending_reloads.empty());
 		block = NULL;
 		host_fregs.clear();
 		host_gregs.clear();
+		regs = {};
 	}
 
 	virtual void Preload(u32 reg, nreg_t nreg) = 0;
@@ -267,9 +296,38 @@ private:
 		u16 version;
 		bool write_back;
 		bool dirty;
+		bool allocated;
+		bool pinned;
 	};
 	static constexpr u32 MaxVecSize = AllocVec2 ? 2 : 1;
 
+	// Stack of free host registers. Registers are allocated from the back.
+	template<typename T>
+	class HostRegList
+	{
+	public:
+		bool empty() const { return count == 0; }
+		size_t size() const { return count; }
+		void clear() { count = 0; }
+		T back() const { return list[count - 1]; }
+		void pop_back() { count--; }
+		void push_back(T reg) {
+			verify(count < list.size());
+			list[count++] = reg;
+		}
+		void push_front(T reg) {
+			verify(count < list.size());
+			for (u32 i = count; i > 0; i--)
+				list[i] = list[i - 1];
+			list[0] = reg;
+			count++;
+		}
+
+	private:
+		std::array<T, 32> list;
+		u32 count = 0;
+	};
+
 	bool IsFloat(Sh4RegType reg)
 	{
 		return reg >= reg_fr_0 && reg <= reg_xf_15;
@@ -277,28 +335,41 @@ private:
 
 	nreg_t mapg(Sh4RegType reg)
 	{
-		verify(reg_alloced.count(reg));
-		return (nreg_t)reg_alloced[reg].host_reg;
+		verify(regs[reg].allocated || regs[reg].pinned);
+		return (nreg_t)regs[reg].host_reg;
 	}
 
 	nregf_t mapf(Sh4RegType reg)
 	{
-		verify(reg_alloced.count(reg));
-		return (nregf_t)reg_alloced[reg].host_reg;
+		verify(regs[reg].allocated);
+		return (nregf_t)regs[reg].host_reg;
 	}
 
 	bool IsAllocf(Sh4RegType reg)
 	{
 		if (!IsFloat(reg))
 			return false;
-		return reg_alloced.find(reg) != reg_alloced.end();
+		return regs[reg].allocated;
 	}
 
 	bool IsAllocg(Sh4RegType reg)
 	{
 		if (IsFloat(reg))
 			return false;
-		return reg_alloced.find(reg) != reg_alloced.end();
+		return regs[reg].allocated || regs[reg].pinned;
+	}
+
+	void Allocate(Sh4RegType reg, u32 host_reg, u16 version, bool write_back, bool dirty)
+	{
+		verify(!regs[reg].allocated && !regs[reg].pinned);
+		regs[reg] = { host_reg, version, write_back, dirty, true, false };
+		alloced.push_back(reg);
+	}
+
+	void Release(Sh4RegType reg)
+	{
+		regs[reg].allocated = false;
+		alloced.erase(std::find(alloced.begin(), alloced.end(), reg));
 	}
 
 	bool IsAllocAny(Sh4RegType reg)
@@ -330,18 +401,22 @@ private:
 
 	void FlushReg(Sh4RegType reg_num, bool hard)
 	{
-		auto reg = reg_alloced.find(reg_num);
-		if (reg != reg_alloced.end())
+		reg_alloc& reg = regs[reg_num];
+		if (reg.pinned)
 		{
-			WriteBackReg(reg->first, reg->second);
+			// Stays in its host reg but is reloaded after the op
+			FlushPinnedReg(reg_num, true);
+		}
+		else if (reg.allocated)
+		{
+			WriteBackReg(reg_num, reg);
 			if (hard)
 			{
-				u32 host_reg = reg->second.host_reg;
-				reg_alloced.erase(reg);
+				Release(reg_num);
 				if (IsFloat(reg_num))
-					host_fregs.push_front((nregf_t)host_reg);
+					host_fregs.push_front((nregf_t)reg.host_reg);
 				else
-					host_gregs.push_front((nreg_t)host_reg);
+					host_gregs.push_front((nreg_t)reg.host_reg);
 			}
 		}
 	}
@@ -350,14 +425,34 @@ private:
 	{
 		if (hard)
 		{
-			while (!reg_alloced.empty())
-				FlushReg(reg_alloced.begin()->first, true);
+			while (!alloced.empty())
+				FlushReg(alloced.front(), true);
 		}
 		else
 		{
-			for (auto const& reg : reg_alloced)
-				FlushReg(reg.first, false);
+			for (Sh4RegType reg : alloced)
+				FlushReg(reg, false);
+		}
+	}
+
+	void FlushPinnedReg(Sh4RegType reg, bool reload)
+	{
+		if (!fast_forwarding)
+		{
+			ssa_printf("WB %s <- %cx (pinned)", name_reg(reg).c_str(), 'a' + regs[reg].host_reg);
+			Writeback(reg, (nreg_t)regs[reg].host_reg);
 		}
+		if (reload && std::find(pending_reloads.begin(), pending_reloads.end(), reg) == pending_reloads.end())
+			pending_reloads.push_back(reg);
+	}
+
+	// Write back pinned regs so that the op can access them in memory,
+	// and reload them afterwards if the op may modify them.
+	void FlushPinnedRegs(bool reload)
+	{
+		for (int reg = reg_r0; reg <= reg_r15; reg++)
+			if (regs[reg].pinned)
+				FlushPinnedReg((Sh4RegType)reg, reload);
 	}
 
 	void AllocSourceReg(const shil_param& param)
@@ -367,8 +462,7 @@ private:
 		for (u32 i = 0; i < param.count(); i++)
 		{
 			Sh4RegType sh4reg = (Sh4RegType)(param._reg + i);
-			auto it = reg_alloced.find(sh4reg);
-			if (it == reg_alloced.end())
+			if (!regs[sh4reg].allocated && !regs[sh4reg].pinned)
 			{
 				u32 host_reg;
 				if (param.is_r32i())
@@ -391,7 +485,7 @@ private:
 					host_reg = host_fregs.back();
 					host_fregs.pop_back();
 				}
-				reg_alloced[sh4reg] = { host_reg, param.version[i], false, false };
+				Allocate(sh4reg, host_reg, param.version[i], false, false);
 				if (!fast_forwarding)
 				{
 					if (IsFloat(sh4reg))
@@ -445,8 +539,9 @@ private:
 		for (u32 i = 0; i < param.count(); i++)
 		{
 			Sh4RegType sh4reg = (Sh4RegType)(param._reg + i);
-			auto it = reg_alloced.find(sh4reg);
-			if (it == reg_alloced.end())
+			if (regs[sh4reg].pinned)
+				continue;
+			if (!regs[sh4reg].allocated)
 			{
 				u32 host_reg;
 				if (param.is_r32i())
@@ -469,21 +564,21 @@ private:
 					host_reg = host_fregs.back();
 					host_fregs.pop_back();
 				}
-				reg_alloced[sh4reg] = { host_reg, param.version[i], NeedsWriteBack(sh4reg, param.version[i]), true };
+				Allocate(sh4reg, host_reg, param.version[i], NeedsWriteBack(sh4reg, param.version[i]), true);
 				if (param.is_r32i())
-					ssa_printf("   %s.%d -> %cx %s", name_reg(sh4reg).c_str(), param.version[i], 'a' + host_reg, reg_alloced[sh4reg].write_back ? "(wb)" : "");
+					ssa_printf("   %s.%d -> %cx %s", name_reg(sh4reg).c_str(), param.version[i], 'a' + host_reg, regs[sh4reg].write_back ? "(wb)" : "");
 				else
-					ssa_printf("   %s.%d -> xmm%d %s", name_reg(sh4reg).c_str(), param.version[i], host_reg, reg_alloced[sh4reg].write_back ? "(wb)" : "");
+					ssa_printf("   %s.%d -> xmm%d %s", name_reg(sh4reg).c_str(), param.version[i], host_reg, regs[sh4reg].write_back ? "(wb)" : "");
 			}
 			else
 			{
-				reg_alloc& reg = reg_alloced[sh4reg];
+				reg_alloc& reg = regs[sh4reg];
 				verify(!reg.write_back);
 				reg.write_back = NeedsWriteBack(sh4reg, param.version[i]);
 				reg.dirty = true;
 				reg.version = param.version[i];
 			}
-			verify(reg_alloced[sh4reg].dirty);
+			verify(regs[sh4reg].dirty);
 		}
 	}
 
@@ -492,14 +587,14 @@ private:
 		Sh4RegType spilled_reg = Sh4RegType::NoReg;
 		int latest_use = -1;
 
-		for (auto const& reg : reg_alloced)
+		for (Sh4RegType reg : alloced)
 		{
-			if (IsFloat(reg.first) != freg)
+			if (IsFloat(reg) != freg)
 				continue;
 			// Don't spill already spilled regs
 			bool pending = false;
 			for (auto& pending_reg : pending_flushes)
-				if (pending_reg == reg.first)
+				if (pending_reg == reg)
 				{
 					pending = true;
 					break;
@@ -509,7 +604,7 @@ private:
 
 			// Don't spill current op scalar dest regs
 			shil_opcode* op = &block->oplist[opnum];
-			if (DefsReg(op, reg.first, false))
+			if (DefsReg(op, reg, false))
 				continue;
 
 			// Find the first use, but ignore vec ops
@@ -518,7 +613,7 @@ private:
 			{
 				op = &block->oplist[i];
 				// Vector ops don't use reg alloc
-				if (UsesReg(op, reg.first, reg.second.version, false))
+				if (UsesReg(op, reg, regs[reg].version, false))
 				{
 					first_use = i;
 					break;
@@ -527,13 +622,13 @@ private:
 			if (first_use == -1)
 			{
 				latest_use = -1;
-				spilled_reg = reg.first;
+				spilled_reg = reg;
 				break;
 			}
 			if (first_use > latest_use && first_use > opnum)
 			{
 				latest_use = first_use;
-				spilled_reg = reg.first;
+				spilled_reg = reg;
 			}
 		}
 		if (latest_use != -1)
@@ -541,8 +636,8 @@ private:
 			ssa_printf("RegAlloc: non optimal alloc? reg %s used in op %d", name_reg(spilled_reg).c_str(), latest_use);
 			spills++;
 			// need to write-back if dirty so reload works
-			if (reg_alloced[spilled_reg].dirty)
-				reg_alloced[spilled_reg].write_back = true;
+			if (regs[spilled_reg].dirty)
+				regs[spilled_reg].write_back = true;
 		}
 		verify(spilled_reg != Sh4RegType::NoReg);
 
@@ -554,8 +649,8 @@ private:
 			// It's possible that the same host reg is allocated to a source operand
 			// and to the (future) dest operand. In this case we want to keep both mappings
 			// until the current op is done.
-			WriteBackReg(spilled_reg, reg_alloced[spilled_reg]);
-			u32 host_reg = reg_alloced[spilled_reg].host_reg;
+			WriteBackReg(spilled_reg, regs[spilled_reg]);
+			u32 host_reg = regs[spilled_reg].host_reg;
 			if (IsFloat(spilled_reg))
 				host_fregs.push_front((nregf_t)host_reg);
 			else
@@ -654,10 +749,13 @@ private:
 #endif
 
 	RuntimeBlockInfo* block = NULL;
-	std::deque<nreg_t> host_gregs;
-	std::deque<nregf_t> host_fregs;
+	HostRegList<nreg_t> host_gregs;
+	HostRegList<nregf_t> host_fregs;
 	std::vector<Sh4RegType> pending_flushes;
-	std::map<Sh4RegType, reg_alloc> reg_alloced;
+	std::vector<Sh4RegType> pending_reloads;
+	// State of each guest register, and list of the allocated ones
+	std::array<reg_alloc, sh4_reg_count> regs {};
+	std::vector<Sh4RegType> alloced;
 	int opnum = 0;
 
 	bool final_opend = false;
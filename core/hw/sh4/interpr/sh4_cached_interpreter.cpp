@@ -0,0 +1,266 @@
+/*
+	This file is part of Flycast.
+
+    Flycast is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 2 of the License, or
+    (at your option) any later version.
+
+    Flycast is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Flycast.  If not, see <https://www.gnu.org/licenses/>.
+ */
+/*
+	Cached interpreter: sh4 code is decoded once into blocks of opcode handlers
+	that are then run without fetching and decoding each instruction again.
+	Blocks are found by physical address and compared with memory before being run
+	so that they're discarded when their code is overwritten.
+*/
+#include "types.h"
+#include "../sh4_interpreter.h"
+#include "../sh4_opcode_list.h"
+#include "../sh4_core.h"
+#include "../sh4_interrupts.h"
+#include "hw/sh4/sh4_mem.h"
+#include "../sh4_sched.h"
+#include "../sh4_cycles.h"
+#include "hw/sh4/modules/mmu.h"
+#include "debug/gdb_server.h"
+
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+namespace
+{
+
+struct CachedBlock
+{
+	void decode(u32 pc);
+	bool check() const;
+	void run() const;
+
+	u32 vaddr = 0;
+	u32 addr = 0;
+	u32 guestCycles = 0;
+	bool hasFpuOp = false;
+	// The last instruction is the delay slot of the branch before it
+	bool hasDelaySlot = false;
+	std::vector<DecodedOpcode> instructions;
+	std::vector<u16> code;
+};
+
+sh4_if sh4Interp;
+// Blocks by physical address
+std::unordered_map<u32, std::unique_ptr<CachedBlock>> blocks;
+bool flushPending;
+
+void CachedBlock::decode(u32 pc)
+{
+	vaddr = pc;
+	// Pipeline state is only tracked within a block
+	Sh4Cycles cycles(CPU_RATIO);
+	auto add = [&](u16 op) {
+		instructions.push_back({ OpPtr[op], op });
+		code.push_back(op);
+		guestCycles += cycles.countCycles(op);
+		hasFpuOp |= OpDesc[op]->IsFloatingPoint();
+	};
+	for (;;)
+	{
+		u16 op = IReadMem16(pc);
+		const sh4_opcodelistentry *desc = OpDesc[op];
+		add(op);
+		pc += 2;
+		if (desc->SetPC())
+		{
+			// The delay slot is decoded with its branch unless it's on another mmu page
+			if ((desc->type & Delayslot) != 0 && !(mmu_enabled() && (pc & 0x3ff) == 0))
+			{
+				add(IReadMem16(pc));
+				hasDelaySlot = true;
+			}
+			break;
+		}
+		// SR writes end the block since the FPU disable check is done once per block.
+		if (desc->SetSR() || (desc->type & Invalid) != 0
+				|| guestCycles >= SH4_TIMESLICE / 2
+				|| (mmu_enabled() && (pc & 0x3ff) == 0))	// smallest mmu page size
+			break;
+	}
+}
+
+// Blocks must be checked before being run since writes to their code aren't tracked
+bool CachedBlock::check() const
+{
+	const u8 *mem = GetMemPtr(addr, code.size() * sizeof(u16));
+	if (mem == nullptr)
+		return true;
+	return memcmp(mem, code.data(), code.size() * sizeof(u16)) == 0;
+}
+
+void CachedBlock::run() const
+{
+	Sh4cntx.cycle_counter -= guestCycles;
+	const DecodedOpcode *insn = instructions.data();
+	const DecodedOpcode *end = insn + instructions.size();
+	if (hasDelaySlot)
+	{
+		// Run by the branch, or below if it isn't taken
+		end--;
+		decodedDelaySlot = end;
+	}
+	if (hasFpuOp && sr.FD == 1)
+	{
+		do {
+			next_pc += 2;
+			if (OpDesc[insn->op]->IsFloatingPoint())
+				RaiseFPUDisableException();
+			insn->handler(insn->op);
+		} while (++insn != end);
+		if (decodedDelaySlot != nullptr)
+		{
+			decodedDelaySlot = nullptr;
+			next_pc += 2;
+			if (OpDesc[insn->op]->IsFloatingPoint())
+				RaiseFPUDisableException();
+			insn->handler(insn->op);
+		}
+	}
+	else
+	{
+		do {
+			next_pc += 2;
+			insn->handler(insn->op);
+		} while (++insn != end);
+		if (decodedDelaySlot != nullptr)
+		{
+			decodedDelaySlot = nullptr;
+			next_pc += 2;
+			insn->handler(insn->op);
+		}
+	}
+}
+
+const CachedBlock *getBlock()
+{
+	// Blocks aren't deleted while they're running
+	if (flushPending)
+	{
+		blocks.clear();
+		flushPending = false;
+	}
+	u32 addr = next_pc;
+	if (!mmu_enabled())
+	{
+		if (next_pc & 1)
+			// address error
+			throw SH4ThrownException(next_pc, Sh4Ex_AddressErrorRead);
+	}
+	else
+	{
+		MmuError rv = mmu_instruction_translation(next_pc, addr);
+		if (rv != MmuError::NONE)
+		{
+			DoMMUException(next_pc, rv, MMU_TT_IREAD);
+			return nullptr;
+		}
+	}
+
+	std::unique_ptr<CachedBlock>& block = blocks[addr];
+	if (block != nullptr)
+	{
+		if (block->check())
+			return block.get();
+		DEBUG_LOG(INTERPRETER, "Cached block %08x modified", block->vaddr);
+	}
+	block = std::make_unique<CachedBlock>();
+	block->addr = addr;
+	block->decode(next_pc);
+
+	return block.get();
+}
+
+void clearCache() {
+	flushPending = true;
+}
+
+void run()
+{
+	sh4_int_bCpuRun = true;
+	RestoreHostRoundingMode();
+
+	try {
+		do
+		{
+			try {
+				do
+				{
+					const CachedBlock *block = getBlock();
+					if (block != nullptr)
+						block->run();
+				} while (p_sh4rcb->cntx.cycle_counter > 0);
+				p_sh4rcb->cntx.cycle_counter += SH4_TIMESLICE;
+				UpdateSystem_INTC();
+			} catch (const SH4ThrownException& ex) {
+				decodedDelaySlot = nullptr;
+				Do_Exception(ex.epc, ex.expEvn);
+				// an exception requires the instruction pipeline to drain, so approx 5 cycles
+				sh4cycles.addCycles(5 * CPU_RATIO);
+			}
+		} while (sh4_int_bCpuRun);
+	} catch (const debugger::Stop&) {
+		decodedDelaySlot = nullptr;
+	}
+
+	sh4_int_bCpuRun = false;
+}
+
+void reset(bool hard)
+{
+	sh4Interp.Reset(hard);
+	clearCache();
+}
+
+void init()
+{
+	sh4Interp.Init();
+	clearCache();
+}
+
+void term()
+{
+	blocks.clear();
+	sh4Interp.Term();
+}
+
+void stop() {
+	sh4Interp.Stop();
+}
+
+void step() {
+	sh4Interp.Step();
+}
+
+bool isCpuRunning() {
+	return sh4Interp.IsCpuRunning();
+}
+
+}
+
+void Get_Sh4CachedInterpreter(sh4_if* cpu)
+{
+	Get_Sh4Interpreter(&sh4Interp);
+	cpu->Run = run;
+	cpu->Stop = stop;
+	cpu->Step = step;
+	cpu->Reset = reset;
+	cpu->Init = init;
+	cpu->Term = term;
+	cpu->IsCpuRunning = isCpuRunning;
+	cpu->ResetCache = clearCache;
+}
@@ -14,16 +14,10 @@
 #include "debug/gdb_server.h"
 #include "../sh4_cycles.h"
 
-// SH4 underclock factor when using the interpreter so that it's somewhat usable
-#ifdef STRICT_MODE
-constexpr int CPU_RATIO = 1;
-#else
-constexpr int CPU_RATIO = 8;
-#endif
-
 Sh4ICache icache;
 Sh4OCache ocache;
 Sh4Cycles sh4cycles(CPU_RATIO);
+const DecodedOpcode *decodedDelaySlot;
 
 static void ExecuteOpcode(u16 op)
 {
@@ -134,12 +128,39 @@ static bool Sh4_int_IsCpuRunning()
 }
 
 //TODO : Check for valid delayslot instruction
+static const DecodedOpcode *takeDecodedDelaySlot()
+{
+	const DecodedOpcode *slot = decodedDelaySlot;
+	if (slot != nullptr)
+	{
+		decodedDelaySlot = nullptr;
+		next_pc += 2;
+	}
+	return slot;
+}
+
+// Its cycles are counted with the cached block
+static void ExecuteDecodedOpcode(const DecodedOpcode& opcode)
+{
+	if (sr.FD == 1 && OpDesc[opcode.op]->IsFloatingPoint())
+		RaiseFPUDisableException();
+	opcode.handler(opcode.op);
+}
+
 void ExecuteDelayslot()
 {
 	try {
-		u32 op = ReadNexOp();
+		const DecodedOpcode *slot = takeDecodedDelaySlot();
+		if (slot != nullptr)
+		{
+			ExecuteDecodedOpcode(*slot);
+		}
+		else
+		{
+			u32 op = ReadNexOp();
 
-		ExecuteOpcode(op);
+			ExecuteOpcode(op);
+		}
 	} catch (SH4ThrownException& ex) {
 		AdjustDelaySlotException(ex);
 		throw ex;
@@ -157,11 +178,15 @@ void ExecuteDelayslot_RTE()
 		// the MD bit is accessed after modification.
 		// The other bits—S, T, M, Q, FD, BL, and RB—after modification are used for delay slot
 		// instruction execution. The STC and STC.L SR instructions access all SR bits after modification.
-		u32 op = ReadNexOp();
+		const DecodedOpcode *slot = takeDecodedDelaySlot();
+		u32 op = slot == nullptr ? ReadNexOp() : slot->op;
 		// Now restore all SR bits
 		sh4_sr_SetFull(ssr);
 		// And execute
-		ExecuteOpcode(op);
+		if (slot != nullptr)
+			ExecuteDecodedOpcode(*slot);
+		else
+			ExecuteOpcode(op);
 	} catch (const SH4ThrownException&) {
 		throw FlycastException("Fatal: SH4 exception in RTE delay slot");
 	} catch (const debugger::Stop& e) {
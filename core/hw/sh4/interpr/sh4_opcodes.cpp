@@ -11,10 +11,7 @@
 #include "hw/sh4/sh4_interrupts.h"
 #include "debug/gdb_server.h"
 #include "hw/sh4/dyna/decoder.h"
-
-#ifdef STRICT_MODE
 #include "hw/sh4/sh4_cache.h"
-#endif
 
 //Read Mem macros
 
@@ -1122,25 +1119,22 @@ sh4op(i0000_0000_0011_1000)
 //ocbi @<REG_N>
 sh4op(i0000_nnnn_1001_0011)
 {
-#ifdef STRICT_MODE
-	ocache.WriteBack(r[GetN(op)], false, true);
-#endif
+	if (cacheModelEnabled)
+		ocache.WriteBack(r[GetN(op)], false, true);
 }
 
 //ocbp @<REG_N>
 sh4op(i0000_nnnn_1010_0011)
 {
-#ifdef STRICT_MODE
-	ocache.WriteBack(r[GetN(op)], true, true);
-#endif
+	if (cacheModelEnabled)
+		ocache.WriteBack(r[GetN(op)], true, true);
 }
 
 //ocbwb @<REG_N>
 sh4op(i0000_nnnn_1011_0011)
 {
-#ifdef STRICT_MODE
-	ocache.WriteBack(r[GetN(op)], true, false);
-#endif
+	if (cacheModelEnabled)
+		ocache.WriteBack(r[GetN(op)], true, false);
 }
 
 //pref @<REG_N>
@@ -1156,11 +1150,9 @@ sh4op(i0000_nnnn_1000_0011)
 		else
 			do_sqw_nommu(Dest, sq_both);
 	}
-	else
+	else if (cacheModelEnabled)
 	{
-#ifdef STRICT_MODE
 		ocache.Prefetch(Dest);
-#endif
 	}
 }
 
@@ -71,12 +71,18 @@ static void CCN_CCR_write(u32 addr, u32 value)
 	}
 	if (temp.OCI) {
 		DEBUG_LOG(SH4, "Sh4: o-cache invalidation %08X", curr_pc);
-		if (!config::DynarecEnabled)
+		if (!config::DynarecEnabled || cacheModelEnabled)
 			ocache.Invalidate();
 		temp.OCI = 0;
 	}
 
 	CCN_CCR=temp;
+
+	const bool cacheModel = cacheModelEnabled;
+	SetMemoryHandlers();
+	if (cacheModel != cacheModelEnabled)
+		// Blocks must be recompiled with or without the cache model
+		sh4_cpu.ResetCache();
 }
 
 static u32 CPU_VERSION_read(u32 addr)
@@ -12,6 +12,7 @@
 #include "dmac.h"
 #include "hw/sh4/sh4_interrupts.h"
 #include "hw/holly/holly_intc.h"
+#include "profiler/fc_profiler.h"
 
 DMACRegisters dmac;
 
@@ -46,6 +47,7 @@ void DMAC_Ch2St()
 	// 12000000 - 12FFFFE0
 	if ((dst & 0x01000000) == 0)
 	{
+		FC_PROFILE_BYTES("TA DMA", len);
 		if ((src & RAM_MASK) + len > RAM_SIZE)
 		{
 			u32 newLen = RAM_SIZE - (src & RAM_MASK);
@@ -64,36 +66,19 @@ void DMAC_Ch2St()
 	else
 	{
 		bool path64b = SB_C2DSTAT & 0x02000000 ? SB_LMMODE1 == 0 : SB_LMMODE0 == 0;
-
-		if (path64b)
-		{
-			// 64-bit path
-			dst = (dst & 0x00FFFFFF) | 0xa4000000;
-			if ((src & RAM_MASK) + len > RAM_SIZE)
-			{
-				u32 newLen = RAM_SIZE - (src & RAM_MASK);
-				WriteMemBlock_nommu_dma(dst, src, newLen);
-				len -= newLen;
-				src += newLen;
-				dst += newLen;
-			}
-			WriteMemBlock_nommu_dma(dst, src, len);
-			src += len;
-			dst += len;
-		}
-		else
+		// 64-bit or 32-bit path
+		dst = (dst & 0x00FFFFFF) | (path64b ? 0xa4000000 : 0xa5000000);
+		if ((src & RAM_MASK) + len > RAM_SIZE)
 		{
-			// 32-bit path
-			dst = (dst & 0xFFFFFF) | 0xa5000000;
-			while (len > 0)
-			{
-				u32 v = ReadMem32_nommu(src);
-				pvr_write32p<u32>(dst, v);
-				len -= 4;
-				src += 4;
-				dst += 4;
-			}
+			u32 newLen = RAM_SIZE - (src & RAM_MASK);
+			pvr_write_block(dst, GetMemPtr(src, newLen), newLen);
+			len -= newLen;
+			src += newLen;
+			dst += newLen;
 		}
+		pvr_write_block(dst, GetMemPtr(src, len), len);
+		src += len;
+		dst += len;
 		SB_C2DSTAT = dst;
 	}
 
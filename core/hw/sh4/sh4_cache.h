@@ -231,7 +231,8 @@ extern Sh4ICache icache;
 class Sh4OCache
 {
 public:
-	template<class T>
+	// Without exceptions, invalid accesses bypass the cache
+	template<class T, bool Exceptions = true>
 	T ReadMem(u32 address)
 	{
 		u32 physAddr;
@@ -239,7 +240,11 @@ public:
 		bool copyBack;
 		MmuError err = translateAddress<T, MMU_TT_DREAD>(address, physAddr, cacheOn, copyBack);
 		if (err != MmuError::NONE)
+		{
+			if (!Exceptions)
+				return addrspace::readt<T>(address);
 			mmu_raise_exception(err, address, MMU_TT_DREAD);
+		}
 
 		if (!cacheOn) {
 			sh4cycles.addReadAccessCycles(physAddr, sizeof(T));
@@ -262,7 +267,7 @@ public:
 		return *(T*)&line.data[physAddr & 0x1f];
 	}
 
-	template<class T>
+	template<class T, bool Exceptions = true>
 	void WriteMem(u32 address, T data)
 	{
 		u32 physAddr = 0;
@@ -270,7 +275,14 @@ public:
 		bool copyBack = false;
 		MmuError err = translateAddress<T, MMU_TT_DWRITE>(address, physAddr, cacheOn, copyBack);
 		if (err != MmuError::NONE)
+		{
+			if (!Exceptions)
+			{
+				addrspace::writet<T>(address, data);
+				return;
+			}
 			mmu_raise_exception(err, address, MMU_TT_DWRITE);
+		}
 
 		if (!cacheOn)
 		{
@@ -605,6 +617,20 @@ void WriteCachedMem(u32 address, T data)
 	ocache.WriteMem<T>(address, data);
 }
 
+// Used by the dynarecs, which don't handle sh4 exceptions without the mmu.
+// Address errors are ignored and the memory is accessed as it is without the cache model.
+template<class T>
+T ReadCachedMemNoException(u32 address)
+{
+	return ocache.ReadMem<T, false>(address);
+}
+
+template<class T>
+void WriteCachedMemNoException(u32 address, T data)
+{
+	ocache.WriteMem<T, false>(address, data);
+}
+
 static inline u16 IReadCachedMem(u32 address)
 {
 	return icache.ReadMem(address);
@@ -322,6 +322,8 @@ static inline void sh4_sr_SetFull(u32 value)
 //Get an interface to sh4 interpreter
 void Get_Sh4Interpreter(sh4_if* cpu);
 void Get_Sh4Recompiler(sh4_if* cpu);
+//Get an interface to the cached interpreter
+void Get_Sh4CachedInterpreter(sh4_if* cpu);
 
 u32* GetRegPtr(u32 reg);
 
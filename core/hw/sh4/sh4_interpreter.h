@@ -36,7 +36,24 @@ enum OpcodeType
 void ExecuteDelayslot();
 void ExecuteDelayslot_RTE();
 
+// Opcode decoded by the cached interpreter
+struct DecodedOpcode
+{
+	OpCallFP *handler;
+	u16 op;
+};
+// Delay slot of the branch being run by the cached interpreter. When set, ExecuteDelayslot()
+// runs it instead of fetching the next opcode and doesn't count its cycles.
+extern const DecodedOpcode *decodedDelaySlot;
+
 #define SH4_TIMESLICE 448	// at 112 Bangai-O doesn't start. 224 is ok
 
+// SH4 underclock factor when using the interpreter so that it's somewhat usable
+#ifdef STRICT_MODE
+constexpr int CPU_RATIO = 1;
+#else
+constexpr int CPU_RATIO = 8;
+#endif
+
 int UpdateSystem();
 int UpdateSystem_INTC();
@@ -11,10 +11,8 @@
 #include "hw/pvr/pvr_mem.h"
 #include "hw/mem/addrspace.h"
 #include "hw/sh4/modules/mmu.h"
-
-#ifdef STRICT_MODE
 #include "sh4_cache.h"
-#endif
+#include "cfg/option.h"
 
 //main system mem
 RamRegion mem_b;
@@ -31,6 +29,8 @@ WriteMem16Func WriteMem16;
 WriteMem32Func WriteMem32;
 WriteMem64Func WriteMem64;
 
+bool cacheModelEnabled;
+
 //AREA 1
 static addrspace::handler area1_32b;
 
@@ -202,58 +202,12 @@ void mem_Term()
 
 void WriteMemBlock_nommu_dma(u32 dst, u32 src, u32 size)
 {
-	bool dst_ismem, src_ismem;
-	void* dst_ptr = addrspace::writeConst(dst, dst_ismem, 4);
-	void* src_ptr = addrspace::readConst(src, src_ismem, 4);
-
-	if (dst_ismem && src_ismem)
-	{
-		memcpy(dst_ptr, src_ptr, size);
-	}
-	else if (src_ismem)
-	{
-		WriteMemBlock_nommu_ptr(dst, (u32*)src_ptr, size);
-	}
-	else
-	{
-		verify(size % 4 == 0);
-		for (u32 i = 0; i < size; i += 4)
-			WriteMem32_nommu(dst + i, ReadMem32_nommu(src + i));
-	}
+	addrspace::copyBlock(dst, src, size);
 }
 
 void WriteMemBlock_nommu_ptr(u32 dst, const u32 *src, u32 size)
 {
-	bool dst_ismem;
-
-	void* dst_ptr = addrspace::writeConst(dst, dst_ismem, 4);
-
-	if (dst_ismem)
-	{
-		memcpy(dst_ptr, src, size);
-	}
-	else
-	{
-		for (u32 i = 0; i < size;)
-		{
-			u32 left = size - i;
-			if (left >= 4)
-			{
-				WriteMem32_nommu(dst + i, src[i >> 2]);
-				i += 4;
-			}
-			else if (left >= 2)
-			{
-				WriteMem16_nommu(dst + i, ((u16 *)src)[i >> 1]);
-				i += 2;
-			}
-			else
-			{
-				WriteMem8_nommu(dst + i, ((u8 *)src)[i]);
-				i++;
-			}
-		}
-	}
+	addrspace::writeBlock(dst, src, size);
 }
 
 void WriteMemBlock_nommu_sq(u32 dst, const SQBuffer *src)
@@ -266,8 +220,7 @@ void WriteMemBlock_nommu_sq(u32 dst, const SQBuffer *src)
 	}
 	else
 	{
-		for (u32 i = 0; i < sizeof(SQBuffer); i += 4)
-			WriteMem32_nommu(dst + i, *(const u32 *)&src->data[i]);
+		addrspace::writeBlock(dst, src, sizeof(SQBuffer));
 	}
 }
 
@@ -289,6 +242,20 @@ u8* GetMemPtr(u32 addr, u32 size)
 	return nullptr;
 }
 
+// The operand cache is only emulated when a game uses part of it as RAM or changes its index mode.
+// Memory is accessed directly otherwise.
+static bool useCacheModel()
+{
+	if (!config::DynarecAccurateCache || mmu_enabled() || CCN_CCR.OCE == 0)
+		return false;
+#if FEAT_SHREC != DYNAREC_NONE && HOST_CPU != CPU_X64 && HOST_CPU != CPU_ARM64
+	// Not supported by this dynarec
+	if (config::DynarecEnabled)
+		return false;
+#endif
+	return CCN_CCR.ORA == 1 || CCN_CCR.OIX == 1;
+}
+
 void SetMemoryHandlers()
 {
 #ifdef STRICT_MODE
@@ -304,6 +271,7 @@ void SetMemoryHandlers()
 	if (!config::DynarecEnabled)
 	{
 		interpreterRunning = true;
+		cacheModelEnabled = true;
 		IReadMem16 = &IReadCachedMem;
 		ReadMem8 = &ReadCachedMem<u8>;
 		ReadMem16 = &ReadCachedMem<u16>;
@@ -319,6 +287,32 @@ void SetMemoryHandlers()
 	}
 	interpreterRunning = false;
 #endif
+	const bool useCache = useCacheModel();
+	if (useCache != cacheModelEnabled)
+	{
+		if (useCache)
+			// Memory is up to date
+			ocache.Invalidate();
+		else
+			ocache.WriteBackAll();
+		cacheModelEnabled = useCache;
+	}
+	if (cacheModelEnabled)
+	{
+		// Instructions are still fetched from memory
+		IReadMem16 = &addrspace::read16;
+		ReadMem8 = &ReadCachedMem<u8>;
+		ReadMem16 = &ReadCachedMem<u16>;
+		ReadMem32 = &ReadCachedMem<u32>;
+		ReadMem64 = &ReadCachedMem<u64>;
+
+		WriteMem8 = &WriteCachedMem<u8>;
+		WriteMem16 = &WriteCachedMem<u16>;
+		WriteMem32 = &WriteCachedMem<u32>;
+		WriteMem64 = &WriteCachedMem<u64>;
+
+		return;
+	}
 	if (mmu_enabled())
 	{
 		IReadMem16 = &mmu_IReadMem16;
@@ -70,3 +70,5 @@ static inline bool IsOnRam(u32 addr)
 }
 
 void SetMemoryHandlers();
+// Data accesses go through the operand cache model
+extern bool cacheModelEnabled;
@@ -11,6 +11,8 @@
 #include <fcntl.h>
 #include <cerrno>
 #include <unistd.h>
+#include <cstdio>
+#include <cstring>
 
 #include "hw/mem/addrspace.h"
 #include "hw/sh4/sh4_if.h"
@@ -86,6 +88,56 @@ bool region_set_exec(void *start, size_t len)
 	return true;
 }
 
+static bool useHugePages;
+static bool prefaultPages;
+
+void set_hints(bool hugePages, bool prefault)
+{
+#ifdef MADV_HUGEPAGE
+	if (hugePages && !useHugePages)
+	{
+		// Guest memory is shared memory, which only gets huge pages if the kernel allows it
+		FILE *f = fopen("/sys/kernel/mm/transparent_hugepage/shmem_enabled", "r");
+		if (f != nullptr)
+		{
+			char mode[128] {};
+			if (fgets(mode, sizeof(mode), f) != nullptr && strstr(mode, "[advise]") == nullptr
+					&& strstr(mode, "[always]") == nullptr && strstr(mode, "[within_size]") == nullptr)
+				WARN_LOG(VMEM, "Shared memory huge pages are disabled: %s", mode);
+			fclose(f);
+		}
+	}
+	useHugePages = hugePages;
+#endif
+	prefaultPages = prefault;
+}
+
+// Applies the hints to a newly mapped region
+static void adviseRegion(void *start, size_t len, bool writable)
+{
+#ifdef MADV_HUGEPAGE
+	if (useHugePages)
+	{
+		// Only whole huge pages can be used
+		constexpr uintptr_t HugePageSize = 2_MB;
+		const uintptr_t begin = ((uintptr_t)start + HugePageSize - 1) & ~(HugePageSize - 1);
+		const uintptr_t end = ((uintptr_t)start + len) & ~(HugePageSize - 1);
+		if (end > begin && madvise((void *)begin, end - begin, MADV_HUGEPAGE) != 0)
+			WARN_LOG(VMEM, "madvise(MADV_HUGEPAGE) failed: errno %d", errno);
+	}
+#endif
+	if (prefaultPages)
+	{
+#ifdef MADV_POPULATE_WRITE
+		if (madvise(start, len, writable ? MADV_POPULATE_WRITE : MADV_POPULATE_READ) == 0)
+			return;
+#endif
+		// Older kernels: read a byte of each page
+		for (size_t i = 0; i < len; i += PAGE_SIZE)
+			(void)*(volatile u8 *)((u8 *)start + i);
+	}
+}
+
 static void *mem_region_reserve(void *start, size_t len)
 {
 	void *p = mmap(start, len, PROT_NONE, MAP_PRIVATE | MAP_ANON, -1, 0);
@@ -241,6 +293,7 @@ void create_mappings(const Mapping *vmem_maps, unsigned nummaps) {
 			void *p = mem_region_map_file((void*)(uintptr_t)vmem_fd, &addrspace::ram_base[offset],
 					vmem_maps[i].memsize, vmem_maps[i].memoffset, vmem_maps[i].allow_writes);
 			verify(p != nullptr);
+			adviseRegion(p, vmem_maps[i].memsize, vmem_maps[i].allow_writes);
 		}
 	}
 }
@@ -249,10 +302,12 @@ void create_mappings(const Mapping *vmem_maps, unsigned nummaps) {
 bool prepare_jit_block(void *code_area, size_t size, void **code_area_rwx)
 {
     // Try to map is as RWX, this fails apparently on OSX (and perhaps other systems?)
-	if (code_area != nullptr && region_set_exec(code_area, size))
+	// Huge pages need anonymous memory so the area is always remapped in that case.
+	if (code_area != nullptr && !useHugePages && region_set_exec(code_area, size))
     {
         // Pointer location should be same:
         *code_area_rwx = code_area;
+        adviseRegion(code_area, size, true);
         return true;
     }
 #ifndef TARGET_ARM_MAC
@@ -278,6 +333,7 @@ bool prepare_jit_block(void *code_area, size_t size, void **code_area_rwx)
     if ( ret_ptr == MAP_FAILED )
         return false;
 #endif
+    adviseRegion(ret_ptr, size, true);
     *code_area_rwx = ret_ptr;
     return true;
 }
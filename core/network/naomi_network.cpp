@@ -263,11 +263,7 @@ bool NaomiNetwork::receive(const sockaddr_in *addr, const Packet *packet, u32 si
 		break;
 
 	case Data:
-		if (!receivedData.empty())
-			INFO_LOG(NETWORK, "Received packet overwritten");
-		receivedData.resize(size - packet->size(0));
-		memcpy(receivedData.data(), packet->data.payload, receivedData.size());
-		packetNumber = packet->data.packetNumber;
+		queueData(packet->data.packetNumber, packet->data.payload, size - (u32)packet->size(0));
 		// TODO? sendAck(peer, port);
 		return true;
 
@@ -288,6 +284,70 @@ bool NaomiNetwork::receive(const sockaddr_in *addr, const Packet *packet, u32 si
 	return false;
 }
 
+void NaomiNetwork::queueData(u16 packetNumber, const u8 *data, u32 size)
+{
+	std::lock_guard<std::mutex> _(queueMutex);
+	// packet numbers wrap around
+	auto isBefore = [](u16 a, u16 b) { return (s16)(a - b) < 0; };
+	if (lastPacketValid && !isBefore(lastPacketNumber, packetNumber))
+	{
+		if ((s16)(lastPacketNumber - packetNumber) < MaxLatePackets)
+		{
+			INFO_LOG(NETWORK, "Late packet %d dropped", packetNumber);
+			return;
+		}
+		// The sender's board has been reset and numbers its packets from 0 again
+		INFO_LOG(NETWORK, "Packet numbers restarted at %d (last %d)", packetNumber, lastPacketNumber);
+		dataQueue.clear();
+		lastPacketValid = false;
+	}
+	auto it = std::find_if(dataQueue.begin(), dataQueue.end(), [&](const DataPacket& p) {
+		return !isBefore(p.packetNumber, packetNumber);
+	});
+	if (it != dataQueue.end() && it->packetNumber == packetNumber)
+		// duplicate
+		return;
+	dataQueue.insert(it, DataPacket{ packetNumber, std::vector<u8>(data, data + size) });
+	if (dataQueue.size() > MaxQueuedPackets)
+	{
+		INFO_LOG(NETWORK, "Received packet overwritten");
+		dataQueue.pop_front();
+	}
+	queueCond.notify_one();
+}
+
+void NaomiNetwork::ioThreadLoop()
+{
+	ThreadName _("NaomiNetwork-io");
+	try {
+		while (!networkStopping)
+		{
+			fd_set fds;
+			FD_ZERO(&fds);
+			FD_SET(sock, &fds);
+			timeval tv{ 0, 10000 };
+			int rc = select((int)sock + 1, &fds, nullptr, nullptr, &tv);
+			if (rc == -1)
+			{
+				int error = get_last_error();
+#ifndef _WIN32
+				if (error == EINTR)
+					continue;
+#endif
+				throw Exception("select error: errno " + std::to_string(error));
+			}
+			if (rc > 0)
+				// drain all pending packets
+				poll();
+		}
+	} catch (const Exception& e) {
+		WARN_LOG(NETWORK, "NaomiNetwork I/O thread: %s", e.what());
+		std::lock_guard<std::mutex> _(queueMutex);
+		ioError = e.what();
+		queueCond.notify_one();
+	}
+}
+
 // Sets the game network config using MIE eeprom or bbsram:
 // Node -1 disables network
 // Node 0 is master, nodes 1+ are slave
@@ -26,7 +26,12 @@
 
 #include <algorithm>
 #include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
 #include <future>
+#include <mutex>
+#include <thread>
 #include <vector>
 
 class NaomiNetwork
@@ -47,6 +52,15 @@ public:
 		return std::async(std::launch::async, [this] {
 			ThreadName _("NaomiNetwork-start");
 			bool res = startNetwork();
+			if (res)
+			{
+				std::lock_guard<std::mutex> _(ioThreadMutex);
+				// shutdown() may have been called in the meantime
+				if (networkStopping)
+					res = false;
+				else
+					ioThread = std::thread(&NaomiNetwork::ioThreadLoop, this);
+			}
 			emu.setNetworkState(res);
 			return res;
 		});
@@ -54,6 +68,12 @@ public:
 
 	void shutdown()
 	{
+		networkStopping = true;
+		{
+			std::lock_guard<std::mutex> _(ioThreadMutex);
+			if (ioThread.joinable())
+				ioThread.join();
+		}
 		enableNetworkBroadcast(false);
 		emu.setNetworkState(false);
 		if (sock != INVALID_SOCKET)
@@ -61,13 +81,29 @@ public:
 			closesocket(sock);
 			sock = INVALID_SOCKET;
 		}
+		std::lock_guard<std::mutex> _(queueMutex);
+		dataQueue.clear();
+		receivedData.clear();
+		lastPacketValid = false;
+		ioError.clear();
 	}
 
-	bool receive(u8 *data, u32 size, u16 *packetNumber)
+	// Packets are received by the I/O thread. Wait up to timeout for one if none is available.
+	bool receive(u8 *data, u32 size, u16 *packetNumber, std::chrono::milliseconds timeout = {})
 	{
-		poll();
 		if (receivedData.empty())
-			return false;
+		{
+			std::unique_lock<std::mutex> lock(queueMutex);
+			if (!queueCond.wait_for(lock, timeout, [this]() { return !dataQueue.empty() || !ioError.empty(); }))
+				return false;
+			if (!ioError.empty())
+				throw Exception(ioError);
+			receivedData = std::move(dataQueue.front().data);
+			this->packetNumber = dataQueue.front().packetNumber;
+			dataQueue.pop_front();
+			lastPacketNumber = this->packetNumber;
+			lastPacketValid = true;
+		}
 
 		size = std::min(size, (u32)receivedData.size());
 		memcpy(data, receivedData.data(), size);
@@ -179,6 +215,8 @@ private:
 	}
 
 	bool receive(const sockaddr_in *addr, const Packet *packet, u32 size);
+	void queueData(u16 packetNumber, const u8 *data, u32 size);
+	void ioThreadLoop();
 
 	void sendAck(const sockaddr_in *addr, bool ack = true)
 	{
@@ -206,6 +244,24 @@ private:
 	u16 packetNumber = 0;
 	bool _startNow = false;
 
+	// Data packets received by the I/O thread, ordered by packet number
+	struct DataPacket
+	{
+		u16 packetNumber;
+		std::vector<u8> data;
+	};
+	static constexpr size_t MaxQueuedPackets = 2;
+	// Packets further behind the last one received mean that the sender has restarted
+	static constexpr int MaxLatePackets = 8;
+	std::thread ioThread;
+	std::mutex ioThreadMutex;
+	std::mutex queueMutex;
+	std::condition_variable queueCond;
+	std::deque<DataPacket> dataQueue;
+	u16 lastPacketNumber = 0;
+	bool lastPacketValid = false;
+	std::string ioError;
+
 	// Server stuff
 	struct Slave
 	{
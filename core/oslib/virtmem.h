@@ -21,6 +21,9 @@ void ondemand_page(void *address, unsigned size_bytes);
 void create_mappings(const Mapping *vmem_maps, unsigned nummaps);
 // Just tries to wipe as much as possible in the relevant area.
 void destroy();
+// Hints for the mappings and jit blocks created afterwards: back them with huge pages where possible
+// and fault their pages in right away. Platforms may ignore them.
+void set_hints(bool hugePages, bool prefault);
 // Given a block of data in the .text section, prepares it for JIT action.
 // both code_area and size are page aligned. Returns success.
 bool prepare_jit_block(void *code_area, size_t size, void **code_area_rwx);
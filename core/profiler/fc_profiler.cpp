@@ -10,6 +10,17 @@ namespace fc_profiler
 	thread_local ProfileThread* ProfileScope::s_thread = nullptr;
 	std::vector<ProfileThread*> ProfileThread::s_allThreads;
 	std::recursive_mutex ProfileThread::s_allThreadsLock;
+	std::vector<ThroughputCounter*> ThroughputCounter::s_allCounters;
+
+	ThroughputCounter::ThroughputCounter(const char* _name)
+		: name(_name)
+		, bytes(0)
+		, lastBytes(0)
+		, rate(0.0)
+	{
+		std::unique_lock<std::recursive_mutex> lock(ProfileThread::s_allThreadsLock);
+		s_allCounters.push_back(this);
+	}
 
 	void startThread(const std::string& threadName)
 	{
@@ -135,6 +146,32 @@ namespace fc_profiler
 		}
 	}
 
+	void drawCounters()
+	{
+		std::unique_lock<std::recursive_mutex> lock(ProfileThread::s_allThreadsLock);
+
+		// Rates are updated every second
+		static std::chrono::steady_clock::time_point lastUpdate = std::chrono::steady_clock::now();
+		const std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+		const double elapsed = std::chrono::duration<double>(now - lastUpdate).count();
+		if (elapsed >= 1.0)
+		{
+			for (ThroughputCounter* counter : ThroughputCounter::s_allCounters)
+			{
+				const u64 bytes = counter->bytes.load(std::memory_order_relaxed);
+				counter->rate = (double)(bytes - counter->lastBytes) / elapsed;
+				counter->lastBytes = bytes;
+			}
+			lastUpdate = now;
+		}
+		for (const ThroughputCounter* counter : ThroughputCounter::s_allCounters)
+		{
+			char text[256];
+			std::snprintf(text, 256, "%.1f MB/s : %s", (float)(counter->rate / 1024.0 / 1024.0), counter->name);
+			ImGui::TreeNode(text);
+		}
+	}
+
 	void drawGraph(const ProfileThread& profileThread)
 	{
 		char threadName[256];
@@ -8,6 +8,7 @@
 #include <chrono>
 #include <thread>
 #include <mutex>
+#include <atomic>
 
 #ifndef __PRETTY_FUNCTION__
 #ifdef _MSC_VER
@@ -111,10 +112,28 @@ namespace fc_profiler
 		static thread_local ProfileThread* s_thread;
 	};
 
+	// Amount of data processed by a function, shown in bytes per second
+	struct ThroughputCounter
+	{
+		ThroughputCounter(const char* _name);
+
+		void add(u64 value) {
+			bytes.fetch_add(value, std::memory_order_relaxed);
+		}
+
+		const char* name;
+		std::atomic<u64> bytes;
+		u64 lastBytes;
+		double rate;
+
+		static std::vector<ThroughputCounter*> s_allCounters;
+	};
+
 	void startThread(const std::string& threadName);
 	void endThread(double warningTime = 0.0);
 	void drawGUI(const std::vector<ProfileThread::ResultNode>& results);
 	void drawGraph(const ProfileThread& profileThread);
+	void drawCounters();
 	void outputTTY(const std::vector<ProfileThread::ResultNode>& results);
 }
 
@@ -124,6 +143,12 @@ namespace fc_profiler
 #define FC_PROFILE_SCOPE_NAMED(name) \
 	fc_profiler::ProfileScope __profile__scope(name, __FILE__, __LINE__);
 
+#define FC_PROFILE_BYTES(name, size) \
+	do { \
+		static fc_profiler::ThroughputCounter __profile__counter(name); \
+		__profile__counter.add(size); \
+	} while (false)
+
 #else
 
 namespace fc_profiler
@@ -134,5 +159,6 @@ namespace fc_profiler
 
 #define FC_PROFILE_SCOPE
 #define FC_PROFILE_SCOPE_NAMED(name)
+#define FC_PROFILE_BYTES(name, size)
 
 #endif
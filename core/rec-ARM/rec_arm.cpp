@@ -2512,6 +2512,9 @@ void Arm32Assembler::genMainLoop()
 				And(r1, r0, 0x3F);
 				Add(r1, r1, r8);
 				jump((void *)&addrspace::write64, ne);
+				// unaligned: the second half wraps around to the start of the buffer
+				Tst(r0, 4);
+				jump((void *)&addrspace::write64, ne);
 				Strd(r2, r3, MemOperand(r1, rcbOffset(sq_buffer)));
 			}
 			else
@@ -24,6 +24,7 @@
 #ifndef _M_ARM64
 #include <unistd.h>
 #endif
+#include <deque>
 #include <map>
 
 #include <aarch64/macro-assembler-aarch64.h>
@@ -38,6 +39,7 @@ using namespace vixl::aarch64;
 #include "hw/sh4/sh4_core.h"
 #include "hw/sh4/dyna/ngen.h"
 #include "hw/sh4/sh4_mem.h"
+#include "hw/sh4/sh4_cache.h"
 #include "hw/sh4/sh4_rom.h"
 #include "arm64_regalloc.h"
 #include "hw/mem/addrspace.h"
@@ -907,38 +909,78 @@ public:
 				}
 				break;
 
-			/* fall back to the canonical implementations for better precision
 			case shop_fipr:
 				Add(x9, x28, sh4_context_mem_operand(op.rs1.reg_ptr()).GetOffset());
 				Ld1(v0.V4S(), MemOperand(x9));
-				if (op.rs1._reg != op.rs2._reg)
+				Add(x9, x28, sh4_context_mem_operand(op.rs2.reg_ptr()).GetOffset());
+				Ld1(v1.V4S(), MemOperand(x9));
+				if (fastVectorOps())
 				{
-					Add(x9, x28, sh4_context_mem_operand(op.rs2.reg_ptr()).GetOffset());
-					Ld1(v1.V4S(), MemOperand(x9));
 					Fmul(v0.V4S(), v0.V4S(), v1.V4S());
+					Faddp(v1.V4S(), v0.V4S(), v0.V4S());
+					Faddp(regalloc.MapVRegister(op.rd), v1.V2S());
 				}
 				else
-					Fmul(v0.V4S(), v0.V4S(), v0.V4S());
-				Faddp(v1.V4S(), v0.V4S(), v0.V4S());
-				Faddp(regalloc.MapVRegister(op.rd), v1.V2S());
+				{
+					// Same rounding as the interpreter: exact products, summed in order in double precision
+					Fcvtl(v2.V2D(), v0.V2S());
+					Fcvtl2(v3.V2D(), v0.V4S());
+					Fcvtl(v4.V2D(), v1.V2S());
+					Fcvtl2(v5.V2D(), v1.V4S());
+					Fmul(v2.V2D(), v2.V2D(), v4.V2D());
+					Fmul(v3.V2D(), v3.V2D(), v5.V2D());
+					Faddp(d2, v2.V2D());
+					Fadd(d2, d2, d3);
+					Mov(d4, v3.V2D(), 1);
+					Fadd(d2, d2, d4);
+					Fcvt(regalloc.MapVRegister(op.rd), d2);
+				}
 				break;
 
 			case shop_ftrv:
 				Add(x9, x28, sh4_context_mem_operand(op.rs1.reg_ptr()).GetOffset());
 				Ld1(v0.V4S(), MemOperand(x9));
 				Add(x9, x28, sh4_context_mem_operand(op.rs2.reg_ptr()).GetOffset());
-				Ld1(v1.V4S(), MemOperand(x9, 16, PostIndex));
-				Ld1(v2.V4S(), MemOperand(x9, 16, PostIndex));
-				Ld1(v3.V4S(), MemOperand(x9, 16, PostIndex));
-				Ld1(v4.V4S(), MemOperand(x9, 16, PostIndex));
-				Fmul(v5.V4S(), v1.V4S(), s0, 0);
-				Fmla(v5.V4S(), v2.V4S(), s0, 1);
-				Fmla(v5.V4S(), v3.V4S(), s0, 2);
-				Fmla(v5.V4S(), v4.V4S(), s0, 3);
-				Add(x9, x28, sh4_context_mem_operand(op.rd.reg_ptr()).GetOffset());
-				St1(v5.V4S(), MemOperand(x9));
+				if (fastVectorOps())
+				{
+					Ld1(v1.V4S(), v2.V4S(), v3.V4S(), v4.V4S(), MemOperand(x9));
+					Fmul(v5.V4S(), v1.V4S(), v0.S(), 0);
+					Fmla(v5.V4S(), v2.V4S(), v0.S(), 1);
+					Fmla(v5.V4S(), v3.V4S(), v0.S(), 2);
+					Fmla(v5.V4S(), v4.V4S(), v0.S(), 3);
+					Add(x9, x28, sh4_context_mem_operand(op.rd.reg_ptr()).GetOffset());
+					St1(v5.V4S(), MemOperand(x9));
+				}
+				else
+				{
+					// Two rows at a time in double precision, accumulated in the same order as the interpreter
+					Fcvtl(v6.V2D(), v0.V2S());
+					Fcvtl2(v7.V2D(), v0.V4S());
+					for (int i = 0; i < 4; i++)
+					{
+						const VRegister& fn = i < 2 ? v6 : v7;
+						Ld1(v1.V4S(), MemOperand(x9, 16, PostIndex));
+						Fcvtl(v2.V2D(), v1.V2S());
+						Fcvtl2(v3.V2D(), v1.V4S());
+						if (i == 0)
+						{
+							Fmul(v4.V2D(), v2.V2D(), fn.D(), i & 1);
+							Fmul(v5.V2D(), v3.V2D(), fn.D(), i & 1);
+						}
+						else
+						{
+							Fmul(v2.V2D(), v2.V2D(), fn.D(), i & 1);
+							Fmul(v3.V2D(), v3.V2D(), fn.D(), i & 1);
+							Fadd(v4.V2D(), v4.V2D(), v2.V2D());
+							Fadd(v5.V2D(), v5.V2D(), v3.V2D());
+						}
+					}
+					Fcvtn(v4.V2S(), v4.V2D());
+					Fcvtn2(v4.V4S(), v5.V2D());
+					Add(x9, x28, sh4_context_mem_operand(op.rd.reg_ptr()).GetOffset());
+					St1(v4.V4S(), MemOperand(x9));
+				}
 				break;
-			*/
 
 			case shop_frswap:
 				Add(x9, x28, sh4_context_mem_operand(op.rs1.reg_ptr()).GetOffset());
@@ -969,6 +1011,7 @@ public:
 		block->relink_data = 0;
 
 		RelinkBlock(block);
+		genMmuMissStubs();
 
 		Finalize();
 		jitWriteProtect(codeBuffer, true);
@@ -1130,6 +1173,61 @@ public:
 		EnsureCodeSize(start_instruction, write_memory_rewrite_size);
 	}
 
+	// Memory accesses through the operand cache model
+	void GenReadMemoryCached(u32 size)
+	{
+		switch (size)
+		{
+		case 1:
+			GenCallRuntime(ReadCachedMemNoException<u8>);
+			Sxtb(w0, w0);
+			break;
+
+		case 2:
+			GenCallRuntime(ReadCachedMemNoException<u16>);
+			Sxth(w0, w0);
+			break;
+
+		case 4:
+			GenCallRuntime(ReadCachedMemNoException<u32>);
+			break;
+
+		case 8:
+			GenCallRuntime(ReadCachedMemNoException<u64>);
+			break;
+
+		default:
+			die("1..8 bytes");
+			break;
+		}
+	}
+
+	void GenWriteMemoryCached(u32 size)
+	{
+		switch (size)
+		{
+		case 1:
+			GenCallRuntime(WriteCachedMemNoException<u8>);
+			break;
+
+		case 2:
+			GenCallRuntime(WriteCachedMemNoException<u16>);
+			break;
+
+		case 4:
+			GenCallRuntime(WriteCachedMemNoException<u32>);
+			break;
+
+		case 8:
+			GenCallRuntime(WriteCachedMemNoException<u64>);
+			break;
+
+		default:
+			die("1..8 bytes");
+			break;
+		}
+	}
+
 	u32 RelinkBlock(RuntimeBlockInfo *block)
 	{
 		ptrdiff_t start_offset = GetBuffer()->GetCursorOffset();
@@ -1565,6 +1663,9 @@ public:
 		Lsr(x7, x0, 26);
 		Cmp(x7, 0x38);
 		GenBranchRuntime(addrspace::write64, Condition::ne);
+		// unaligned: the second half wraps around to the start of the buffer
+		Tst(x0, 4);
+		GenBranchRuntime(addrspace::write64, Condition::ne);
 		And(x0, x0, 0x3f);
 		Sub(x7, x0, sizeof(Sh4RCB::sq_buffer), LeaveFlags);
 		Str(x1, MemOperand(x28, x7));
@@ -1600,6 +1701,11 @@ public:
 	}
 
 private:
+	// FIPR and FTRV may be computed in single precision, except with netplay which needs the same results on all hosts
+	bool fastVectorOps() const {
+		return config::DynarecFastVectorOps && !config::GGPOEnable;
+	}
+
 	// Runtime branches/calls need to be adjusted if rx space is different to rw space.
 	// Therefore can't mix GenBranch with GenBranchRuntime!
 
@@ -1682,23 +1788,33 @@ private:
 	{
 		if (mmu_enabled())
 		{
-			Label inCache;
-			Label done;
+			// The LUT hit path falls through. Misses are handled out of line after the block code.
+			MmuMissStub& stub = mmuMissStubs.emplace_back();
+			stub.write = write;
+			stub.pc = block->vaddr + op.guest_offs - (op.delay_slot ? 2 : 0);
 
 			Lsr(w1, w0, 12);
 			Ldr(w1, MemOperand(x27, x1, LSL, 2));
-			Cbnz(w1, &inCache);
-			Mov(w1, write);
-			Mov(w2, block->vaddr + op.guest_offs - (op.delay_slot ? 2 : 0));	// pc
-			GenCallRuntime(mmuDynarecLookup);
-			B(&done);
-			Bind(&inCache);
+			Cbz(w1, &stub.miss);
 			And(w0, w0, 0xFFF);
 			Orr(w0, w0, w1);
-			Bind(&done);
+			Bind(&stub.done);
 		}
 	}
 
+	void genMmuMissStubs()
+	{
+		for (MmuMissStub& stub : mmuMissStubs)
+		{
+			Bind(&stub.miss);
+			Mov(w1, stub.write);
+			Mov(w2, stub.pc);
+			GenCallRuntime(mmuDynarecLookup);
+			B(&stub.done);
+		}
+		mmuMissStubs.clear();
+	}
+
 	void GenReadMemory(const shil_opcode& op, size_t opid, bool optimise)
 	{
 		if (GenReadMemoryImmediate(op))
@@ -1707,7 +1823,9 @@ private:
 		GenMemAddr(op, &w0);
 		genMmuLookup(op, 0);
 
-		if (!optimise || !GenReadMemoryFast(op, opid))
+		if (cacheModelEnabled)
+			GenReadMemoryCached(op.size);
+		else if (!optimise || !GenReadMemoryFast(op, opid))
 			GenReadMemorySlow(op.size);
 
 		if (op.size < 8)
@@ -1893,10 +2011,10 @@ private:
 			shil_param_to_host_reg(op.rs2, w1);
 		else
 			shil_param_to_host_reg(op.rs2, x1);
-		if (optimise && GenWriteMemoryFast(op, opid))
-			return;
-
-		GenWriteMemorySlow(op.size);
+		if (cacheModelEnabled)
+			GenWriteMemoryCached(op.size);
+		else if (!optimise || !GenWriteMemoryFast(op, opid))
+			GenWriteMemorySlow(op.size);
 	}
 
 	bool GenWriteMemoryImmediate(const shil_opcode& op)
@@ -2167,6 +2285,15 @@ private:
 		const shil_param *prm;
 	};
 	std::vector<CC_PS> CC_pars;
+	// Out-of-line mmu lookups for LUT misses, emitted at the end of the block
+	struct MmuMissStub
+	{
+		Label miss;
+		Label done;
+		u32 write;
+		u32 pc;
+	};
+	std::deque<MmuMissStub> mmuMissStubs;
 	std::vector<const WRegister*> call_regs;
 	std::vector<const XRegister*> call_regs64;
 	std::vector<const VRegister*> call_fregs;
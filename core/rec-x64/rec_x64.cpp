@@ -6,6 +6,7 @@
 
 #include <xbyak/xbyak.h>
 #include <xbyak/xbyak_util.h>
+#include <deque>
 using namespace Xbyak::util;
 
 #include "types.h"
@@ -16,6 +17,7 @@ using namespace Xbyak::util;
 
 #include "hw/sh4/sh4_core.h"
 #include "hw/sh4/sh4_mem.h"
+#include "hw/sh4/sh4_cache.h"
 #include "x64_regalloc.h"
 #include "xbyak_base.h"
 #include "oslib/unwind_info.h"
@@ -231,7 +233,10 @@ public:
 					genMmuLookup(block, op, 0);
 
 					int size = op.size == 1 ? MemSize::S8 : op.size == 2 ? MemSize::S16 : op.size == 4 ? MemSize::S32 : MemSize::S64;
-					GenCall((void (*)())MemHandlers[optimise ? MemType::Fast : MemType::Slow][size][MemOp::R], mmu_enabled());
+					if (cacheModelEnabled)
+						genCachedRead(size);
+					else
+						GenCall((void (*)())MemHandlers[optimise ? MemType::Fast : MemType::Slow][size][MemOp::R], mmu_enabled());
 
 #if ALLOC_F64 == false
 					if (size == MemSize::S64)
@@ -278,7 +283,10 @@ public:
 						shil_param_to_host_reg(op.rs2, call_regs64[1]);
 
 					int size = op.size == 1 ? MemSize::S8 : op.size == 2 ? MemSize::S16 : op.size == 4 ? MemSize::S32 : MemSize::S64;
-					GenCall((void (*)())MemHandlers[optimise ? MemType::Fast : MemType::Slow][size][MemOp::W], mmu_enabled());
+					if (cacheModelEnabled)
+						genCachedWrite(size);
+					else
+						GenCall((void (*)())MemHandlers[optimise ? MemType::Fast : MemType::Slow][size][MemOp::W], mmu_enabled());
 				}
 			}
 			break;
@@ -456,6 +464,80 @@ public:
 					}
 				}
 				break;
+
+			case shop_fipr:
+				mov(rax, (uintptr_t)op.rs1.reg_ptr());
+				mov(rcx, (uintptr_t)op.rs2.reg_ptr());
+				if (fastVectorOps() && cpu.has(Cpu::tSSE41))
+				{
+					movaps(xmm0, xword[rax]);
+					dpps(xmm0, xword[rcx], 0xF1);
+				}
+				else
+				{
+					// Same rounding as the interpreter: exact products, summed in order in double precision
+					cvtps2pd(xmm0, qword[rax]);
+					cvtps2pd(xmm1, qword[rax + 8]);
+					cvtps2pd(xmm2, qword[rcx]);
+					mulpd(xmm0, xmm2);
+					cvtps2pd(xmm2, qword[rcx + 8]);
+					mulpd(xmm1, xmm2);
+					movapd(xmm2, xmm0);
+					unpckhpd(xmm2, xmm2);
+					addsd(xmm0, xmm2);
+					addsd(xmm0, xmm1);
+					unpckhpd(xmm1, xmm1);
+					addsd(xmm0, xmm1);
+					cvtsd2ss(xmm0, xmm0);
+				}
+				movss(regalloc.MapXRegister(op.rd), xmm0);
+				break;
+
+			case shop_ftrv:
+				mov(rax, (uintptr_t)op.rs1.reg_ptr());
+				mov(rcx, (uintptr_t)op.rs2.reg_ptr());
+				if (fastVectorOps())
+				{
+					for (int i = 0; i < 4; i++)
+					{
+						movss(xmm1, dword[rax + i * 4]);
+						shufps(xmm1, xmm1, 0);
+						mulps(xmm1, xword[rcx + i * 16]);
+						if (i == 0)
+							movaps(xmm0, xmm1);
+						else
+							addps(xmm0, xmm1);
+					}
+				}
+				else
+				{
+					// Two rows at a time in double precision, accumulated in the same order as the interpreter
+					for (int i = 0; i < 4; i++)
+					{
+						cvtss2sd(xmm4, dword[rax + i * 4]);
+						unpcklpd(xmm4, xmm4);
+						cvtps2pd(xmm2, qword[rcx + i * 16]);
+						cvtps2pd(xmm3, qword[rcx + i * 16 + 8]);
+						mulpd(xmm2, xmm4);
+						mulpd(xmm3, xmm4);
+						if (i == 0)
+						{
+							movapd(xmm0, xmm2);
+							movapd(xmm1, xmm3);
+						}
+						else
+						{
+							addpd(xmm0, xmm2);
+							addpd(xmm1, xmm3);
+						}
+					}
+					cvtpd2ps(xmm0, xmm0);
+					cvtpd2ps(xmm1, xmm1);
+					movlhps(xmm0, xmm1);
+				}
+				mov(rax, (uintptr_t)op.rd.reg_ptr());
+				movaps(xword[rax], xmm0);
+				break;
 #endif
 
 			default:
@@ -536,6 +618,8 @@ public:
 		add(rsp, STACK_ALIGN);
 		ret();
 
+		genMmuMissStubs();
+
 		ready();
 
 		block->code = (DynarecCodeEntryPtr)getCode();
@@ -677,6 +761,7 @@ public:
 		unwinder.endProlog(getSize());
 
 		mov(qword[rip + &jmp_rsp], rsp);
+		loadPinnedRegs();
 
 	//run_loop:
 		Xbyak::Label run_loop;
@@ -687,6 +772,10 @@ public:
 
 		test(edx, edx);
 		je(end_run_loop);
+		mov(rax, (size_t)&rdv_RepinRequest);
+		mov(edx, dword[rax]);
+		test(edx, edx);
+		jne(end_run_loop);
 
 	//slice_loop:
 		Xbyak::Label slice_loop;
@@ -707,6 +796,8 @@ public:
 
 	//end_run_loop:
 		L(end_run_loop);
+		for (size_t i = 0; i < rdv_PinnedRegs().size(); i++)
+			RegWriteback(rdv_PinnedRegs()[i], pinned_regs[i]);
 		add(rsp, STACK_ALIGN);
 		pop(r15);
 		pop(r14);
@@ -737,6 +828,8 @@ public:
 		Xbyak::Label handleExceptionLabel;
 		L(handleExceptionLabel);
 		mov(rsp, qword[rip + &jmp_rsp]);
+		// Pinned regs have been written back before the exception
+		loadPinnedRegs();
 		jmp(run_loop);
 
 		genMemHandlers();
@@ -754,6 +847,12 @@ public:
 		codeBuffer.advance(getSize());
 	}
 
+	void loadPinnedRegs()
+	{
+		for (size_t i = 0; i < rdv_PinnedRegs().size(); i++)
+			RegPreload(rdv_PinnedRegs()[i], pinned_regs[i]);
+	}
+
 	bool rewriteMemAccess(host_context_t &context)
 	{
 		if (!addrspace::virtmemEnabled())
@@ -803,13 +902,25 @@ public:
 	}
 
 private:
+	// FIPR and FTRV may be computed in single precision, except with netplay which needs the same results on all hosts
+	bool fastVectorOps() const {
+		return config::DynarecFastVectorOps && !config::GGPOEnable;
+	}
+
 	void genMmuLookup(const RuntimeBlockInfo* block, const shil_opcode& op, u32 write)
 	{
 		if (mmu_enabled())
 		{
+			const u32 pc = block->vaddr + op.guest_offs - (op.delay_slot ? 2 : 0);
 #ifdef FAST_MMU
-			Xbyak::Label inCache;
-			Xbyak::Label done;
+			// The LUT hit path falls through. Misses are handled out of line after the block code.
+			MmuMissStub& stub = mmuMissStubs.emplace_back();
+			stub.write = write;
+			stub.pc = pc;
+#ifndef _WIN32
+			for (int i = 0; i < 4; i++)
+				stub.savedXmm[i] = current_opid != (size_t)-1 && regalloc.IsMapped(Xbyak::Xmm(8 + i), current_opid);
+#endif
 
 			mov(eax, call_regs[0]);
 			shr(eax, 12);
@@ -823,21 +934,84 @@ private:
 				mov(eax, dword[(uintptr_t)mmuAddressLUT + rax * 4]);
 			}
 			test(eax, eax);
-			jne(inCache);
-#endif
+			jz(stub.miss, T_NEAR);
+			and_(call_regs[0], 0xFFF);
+			or_(call_regs[0], eax);
+			L(stub.done);
+#else
 			mov(call_regs[1], write);
-			mov(call_regs[2], block->vaddr + op.guest_offs - (op.delay_slot ? 2 : 0));	// pc
+			mov(call_regs[2], pc);
 			GenCall(mmuDynarecLookup);
 			mov(call_regs[0], eax);
-#ifdef FAST_MMU
-			jmp(done);
-			L(inCache);
-			and_(call_regs[0], 0xFFF);
-			or_(call_regs[0], eax);
-			L(done);
 #endif
 		}
 	}
+
+	void genMmuMissStubs()
+	{
+		for (MmuMissStub& stub : mmuMissStubs)
+		{
+			L(stub.miss);
+			mov(call_regs[1], stub.write);
+			mov(call_regs[2], stub.pc);
+#ifndef _WIN32
+			for (int i = 0; i < 4; i++)
+				if (stub.savedXmm[i])
+					movd(ptr[rip + &xmmSave[i]], Xbyak::Xmm(8 + i));
+#endif
+			call(CC_RX2RW(mmuDynarecLookup));
+#ifndef _WIN32
+			for (int i = 0; i < 4; i++)
+				if (stub.savedXmm[i])
+					movd(Xbyak::Xmm(8 + i), ptr[rip + &xmmSave[i]]);
+#endif
+			mov(call_regs[0], eax);
+			jmp(stub.done, T_NEAR);
+		}
+		mmuMissStubs.clear();
+	}
+
+	// Memory accesses through the operand cache model
+	void genCachedRead(int size)
+	{
+		switch (size)
+		{
+		case MemSize::S8:
+			GenCall(ReadCachedMemNoException<u8>);
+			movsx(eax, al);
+			break;
+		case MemSize::S16:
+			GenCall(ReadCachedMemNoException<u16>);
+			movsx(eax, ax);
+			break;
+		case MemSize::S32:
+			GenCall(ReadCachedMemNoException<u32>);
+			break;
+		case MemSize::S64:
+			GenCall(ReadCachedMemNoException<u64>);
+			break;
+		}
+	}
+
+	void genCachedWrite(int size)
+	{
+		switch (size)
+		{
+		case MemSize::S8:
+			GenCall(WriteCachedMemNoException<u8>);
+			break;
+		case MemSize::S16:
+			GenCall(WriteCachedMemNoException<u16>);
+			break;
+		case MemSize::S32:
+			GenCall(WriteCachedMemNoException<u32>);
+			break;
+		case MemSize::S64:
+			GenCall(WriteCachedMemNoException<u64>);
+			break;
+		}
+	}
+
 	bool GenReadMemImmediate(const shil_opcode& op, RuntimeBlockInfo* block)
 	{
 		if (!op.rs1.is_imm())
@@ -1159,6 +1333,12 @@ private:
 						shr(r9d, 26);
 						cmp(r9d, 0x38);
 						jne(no_sqw);
+						if (size == MemSize::S64)
+						{
+							// unaligned: the second half wraps around to the start of the buffer
+							test(call_regs[0], 4);
+							jnz(no_sqw);
+						}
 						mov(rax, (uintptr_t)p_sh4rcb->sq_buffer);
 						and_(call_regs[0], 0x3F);
 
@@ -1280,6 +1460,17 @@ private:
 	};
 	std::vector<CC_PS> CC_pars;
 
+	// Out-of-line mmu lookups for LUT misses, emitted at the end of the block
+	struct MmuMissStub
+	{
+		Xbyak::Label miss;
+		Xbyak::Label done;
+		u32 write;
+		u32 pc;
+		bool savedXmm[4] {};
+	};
+	std::deque<MmuMissStub> mmuMissStubs;
+
 	X64RegAlloc regalloc;
 	Xbyak::util::Cpu cpu;
 	size_t current_opid;
@@ -1332,6 +1523,10 @@ public:
 		this->codeBuffer = &codeBuffer;
 	}
 
+	u32 getPinnableRegCount() override {
+		return std::size(pinned_regs);
+	}
+
 	void mainloop(void *) override
 	{
 		verify(::mainloop != nullptr);
@@ -20,6 +20,7 @@
 
 #include <xbyak/xbyak.h>
 #include "hw/sh4/dyna/ssa_regalloc.h"
+#include "hw/sh4/dyna/ngen.h"
 
 #ifdef _WIN32
 static Xbyak::Operand::Code alloc_regs[] = { Xbyak::Operand::RBX, Xbyak::Operand::RBP, Xbyak::Operand::RDI, Xbyak::Operand::RSI,
@@ -33,6 +34,12 @@ static s8 alloc_fregs[] = { 8, 9, 10, 11, -1 };		// XMM8-11
 // all xmm registers are caller-saved on linux
 #define ALLOC_F64 false
 #endif
+// Host registers holding the pinned guest registers, taken from alloc_regs
+#ifdef _WIN32
+static const Xbyak::Operand::Code pinned_regs[] = { Xbyak::Operand::R15, Xbyak::Operand::R14, Xbyak::Operand::R13 };
+#else
+static const Xbyak::Operand::Code pinned_regs[] = { Xbyak::Operand::R15, Xbyak::Operand::R14 };
+#endif
 
 class BlockCompiler;
 
@@ -42,7 +49,7 @@ struct X64RegAlloc : RegAlloc<Xbyak::Operand::Code, s8, ALLOC_F64>
 
 	void DoAlloc(RuntimeBlockInfo* block)
 	{
-		RegAlloc::DoAlloc(block, alloc_regs, alloc_fregs);
+		RegAlloc::DoAlloc(block, alloc_regs, alloc_fregs, rdv_PinnedRegs(), pinned_regs);
 	}
 
 	void Preload(u32 reg, Xbyak::Operand::Code nreg) override;
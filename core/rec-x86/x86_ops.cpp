@@ -144,7 +144,12 @@ void X86Compiler::genMemHandlers()
 					{
 						movss(dword[(size_t)p_sh4rcb->sq_buffer + ecx], xmm0);
 						if (size == MemSize::F64)
-							movss(dword[((size_t)p_sh4rcb->sq_buffer + 4) + ecx], xmm1);
+						{
+							// the second half wraps around to the start of the buffer if unaligned
+							add(ecx, 4);
+							and_(ecx, 0x3F);
+							movss(dword[(size_t)p_sh4rcb->sq_buffer + ecx], xmm1);
+						}
 					}
 					ret();
 					L(no_sqw);
@@ -5,9 +5,17 @@
 #include "hw/mem/addrspace.h"
 
 #include <algorithm>
+#include <atomic>
+#include <chrono>
 #include <mutex>
 #include <xxhash.h>
 
+#if HOST_CPU == CPU_X64 || (HOST_CPU == CPU_X86 && defined(__SSE2__))
+#include <emmintrin.h>
+#elif HOST_CPU == CPU_ARM64 || (HOST_CPU == CPU_ARM && defined(__ARM_NEON__))
+#include <arm_neon.h>
+#endif
+
 #ifdef _OPENMP
 #include <omp.h>
 #endif
@@ -245,6 +253,35 @@ bool VramLockedWrite(u8* address)
 	return VramLockedWriteOffset(offset);
 }
 
+void VramLockedWriteRange(size_t offset, size_t size)
+{
+	if (offset >= VRAM_SIZE || size == 0)
+		return;
+	const size_t firstPage = offset / PAGE_SIZE;
+	const size_t lastPage = (std::min<size_t>(offset + size, VRAM_SIZE) - 1) / PAGE_SIZE;
+
+	std::lock_guard<std::mutex> lockguard(vramlist_lock);
+	// Pages with an empty lock list aren't protected
+	size_t unprotectStart = (size_t)-1;
+	for (size_t page = firstPage; page <= lastPage + 1; page++)
+	{
+		if (page <= lastPage && !VramLocks[page].empty())
+		{
+			for (auto& lock : VramLocks[page])
+				if (lock != nullptr)
+					lock->texture->invalidate();
+			VramLocks[page].clear();
+			if (unprotectStart == (size_t)-1)
+				unprotectStart = page;
+		}
+		else if (unprotectStart != (size_t)-1)
+		{
+			addrspace::unprotectVram((u32)(unprotectStart * PAGE_SIZE), (u32)((page - unprotectStart) * PAGE_SIZE));
+			unprotectStart = (size_t)-1;
+		}
+	}
+}
+
 //unlocks mem
 //also frees the handle
 static void libCore_vramlock_Unlock_block_wb(vram_block* block)
@@ -842,9 +879,321 @@ void BaseTextureCacheData::SetDirectXColorOrder(bool enabled) {
 	pal_needs_update = true;
 }
 
+static std::atomic<u64> fbReadTime;
+static std::atomic<u64> fbWriteTime;
+static std::atomic<u32> fbReadCount;
+static std::atomic<u32> fbWriteCount;
+
+// Accumulates the time spent in a framebuffer conversion
+class FramebufferTimer
+{
+public:
+	FramebufferTimer(std::atomic<u64>& time, std::atomic<u32>& count) : time(time), start(std::chrono::steady_clock::now()) {
+		count++;
+	}
+	~FramebufferTimer() {
+		time += std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count();
+	}
+
+private:
+	std::atomic<u64>& time;
+	std::chrono::steady_clock::time_point start;
+};
+
+FramebufferStats getFramebufferStats()
+{
+	return { fbReadTime, fbWriteTime, fbReadCount, fbWriteCount };
+}
+
+//
+// Framebuffer conversion kernels: 8 pixels at a time, with one 16-bit lane per pixel and channel.
+//
+#if HOST_CPU == CPU_X64 || (HOST_CPU == CPU_X86 && defined(__SSE2__))
+#define FB_SIMD
+
+using PixelVec = __m128i;
+
+static inline PixelVec vsplat(u16 v) {
+	return _mm_set1_epi16(v);
+}
+static inline PixelVec vor(PixelVec a, PixelVec b) {
+	return _mm_or_si128(a, b);
+}
+static inline PixelVec vand(PixelVec a, PixelVec b) {
+	return _mm_and_si128(a, b);
+}
+static inline PixelVec vadd(PixelVec a, PixelVec b) {
+	return _mm_add_epi16(a, b);
+}
+static inline PixelVec vmin(PixelVec a, PixelVec b) {
+	// operands are small positive values
+	return _mm_min_epi16(a, b);
+}
+template<int N>
+static inline PixelVec vshl(PixelVec v) {
+	return _mm_slli_epi16(v, N);
+}
+template<int N>
+static inline PixelVec vshr(PixelVec v) {
+	return _mm_srli_epi16(v, N);
+}
+// 0xffff if v >= threshold
+static inline PixelVec vgreaterEqual(PixelVec v, u8 threshold) {
+	return _mm_cmpgt_epi16(v, _mm_set1_epi16(threshold - 1));
+}
+static inline PixelVec vload16(const u8 *src) {
+	return _mm_loadu_si128((const __m128i *)src);
+}
+static inline void vstore16(u8 *dst, PixelVec v) {
+	_mm_storeu_si128((__m128i *)dst, v);
+}
+// Store 8 32-bit pixels made of the low and high 16 bits
+static inline void vstore32(u8 *dst, PixelVec low, PixelVec high)
+{
+	_mm_storeu_si128((__m128i *)dst, _mm_unpacklo_epi16(low, high));
+	_mm_storeu_si128((__m128i *)(dst + 16), _mm_unpackhi_epi16(low, high));
+}
+
+// Channels of 8 32-bit pixels
+template<int Red, int Green, int Blue, int Alpha>
+struct Pixels8
+{
+	Pixels8(const u8 *p)
+	{
+		const __m128i lo = _mm_loadu_si128((const __m128i *)p);
+		const __m128i hi = _mm_loadu_si128((const __m128i *)(p + 16));
+		r = channel<Red>(lo, hi);
+		g = channel<Green>(lo, hi);
+		b = channel<Blue>(lo, hi);
+		a = channel<Alpha>(lo, hi);
+	}
+
+	template<int Index>
+	static PixelVec channel(__m128i lo, __m128i hi)
+	{
+		const __m128i mask = _mm_set1_epi32(0xff);
+		return _mm_packs_epi32(_mm_and_si128(_mm_srli_epi32(lo, Index * 8), mask),
+				_mm_and_si128(_mm_srli_epi32(hi, Index * 8), mask));
+	}
+
+	PixelVec r, g, b, a;
+};
+
+// 8 0RGB pixels to RGBA (SwapRB) or BGRA
+template<bool SwapRB>
+static inline void convertC888(const u8 *src, u8 *dst)
+{
+	const __m128i alpha = _mm_set1_epi32(0xff000000);
+	for (int i = 0; i < 32; i += 16)
+	{
+		__m128i v = _mm_loadu_si128((const __m128i *)(src + i));
+		if constexpr (SwapRB)
+		{
+			const __m128i mask = _mm_set1_epi32(0xff);
+			v = _mm_or_si128(_mm_or_si128(_mm_and_si128(v, _mm_set1_epi32(0xff00)),
+					_mm_and_si128(_mm_srli_epi32(v, 16), mask)),
+					_mm_slli_epi32(_mm_and_si128(v, mask), 16));
+		}
+		_mm_storeu_si128((__m128i *)(dst + i), _mm_or_si128(v, alpha));
+	}
+}
+
+#elif HOST_CPU == CPU_ARM64 || (HOST_CPU == CPU_ARM && defined(__ARM_NEON__))
+#define FB_SIMD
+
+using PixelVec = uint16x8_t;
+
+static inline PixelVec vsplat(u16 v) {
+	return vdupq_n_u16(v);
+}
+static inline PixelVec vor(PixelVec a, PixelVec b) {
+	return vorrq_u16(a, b);
+}
+static inline PixelVec vand(PixelVec a, PixelVec b) {
+	return vandq_u16(a, b);
+}
+static inline PixelVec vadd(PixelVec a, PixelVec b) {
+	return vaddq_u16(a, b);
+}
+static inline PixelVec vmin(PixelVec a, PixelVec b) {
+	return vminq_u16(a, b);
+}
+template<int N>
+static inline PixelVec vshl(PixelVec v) {
+	return vshlq_n_u16(v, N);
+}
+template<int N>
+static inline PixelVec vshr(PixelVec v)
+{
+	if constexpr (N == 0)
+		return v;
+	else
+		return vshrq_n_u16(v, N);
+}
+static inline PixelVec vgreaterEqual(PixelVec v, u8 threshold) {
+	return vcgeq_u16(v, vdupq_n_u16(threshold));
+}
+static inline PixelVec vload16(const u8 *src) {
+	return vld1q_u16((const u16 *)src);
+}
+static inline void vstore16(u8 *dst, PixelVec v) {
+	vst1q_u16((u16 *)dst, v);
+}
+static inline void vstore32(u8 *dst, PixelVec low, PixelVec high)
+{
+	uint16x8x2_t v = vzipq_u16(low, high);
+	vst1q_u16((u16 *)dst, v.val[0]);
+	vst1q_u16((u16 *)dst + 8, v.val[1]);
+}
+
+template<int Red, int Green, int Blue, int Alpha>
+struct Pixels8
+{
+	Pixels8(const u8 *p)
+	{
+		const uint8x8x4_t v = vld4_u8(p);
+		r = vmovl_u8(v.val[Red]);
+		g = vmovl_u8(v.val[Green]);
+		b = vmovl_u8(v.val[Blue]);
+		a = vmovl_u8(v.val[Alpha]);
+	}
+
+	PixelVec r, g, b, a;
+};
+
+template<bool SwapRB>
+static inline void convertC888(const u8 *src, u8 *dst)
+{
+	uint8x8x4_t v = vld4_u8(src);
+	if constexpr (SwapRB)
+		std::swap(v.val[0], v.val[2]);
+	v.val[3] = vdup_n_u8(0xff);
+	vst4_u8(dst, v);
+}
+
+#endif
+
+#ifdef FB_SIMD
+// Reduce 8-bit channels to the given number of bits, rounding or truncating
+template<int Bits, bool Round>
+static inline PixelVec reduceChannel(PixelVec c)
+{
+	if constexpr (Round)
+		// same as roundColor()
+		return vmin(vshr<8 - Bits>(vadd(c, vsplat(1 << (7 - Bits)))), vsplat((1 << Bits) - 1));
+	else
+		return vshr<8 - Bits>(c);
+}
+
+// Expand 5 or 6-bit channels to 8 bits and pack 8 pixels
+template<typename Packer>
+static inline void packPixels8(u8 *dst, PixelVec r, PixelVec g, PixelVec b)
+{
+	if constexpr (Packer::pack(1, 0, 0, 0) == 1)
+		vstore32(dst, vor(r, vshl<8>(g)), vor(b, vsplat(0xff00)));
+	else
+		vstore32(dst, vor(b, vshl<8>(g)), vor(r, vsplat(0xff00)));
+}
+#endif
+
+template<typename Packer>
+static void readLine0555(const u8 *src, u32 *dst, int width, u32 fb_concat)
+{
+	int i = 0;
+#ifdef FB_SIMD
+	const PixelVec mask = vsplat(0x1f);
+	const PixelVec concat = vsplat(fb_concat);
+	for (; i + 8 <= width; i += 8)
+	{
+		const PixelVec v = vload16(src + i * 2);
+		packPixels8<Packer>((u8 *)&dst[i],
+				vor(vshl<3>(vand(vshr<10>(v), mask)), concat),
+				vor(vshl<3>(vand(vshr<5>(v), mask)), concat),
+				vor(vshl<3>(vand(v, mask)), concat));
+	}
+#endif
+	for (; i < width; i++)
+	{
+		u16 px;
+		memcpy(&px, src + i * 2, sizeof(px));
+		dst[i] = Packer::pack(
+				(((px >> 10) & 0x1F) << 3) | fb_concat,
+				(((px >> 5) & 0x1F) << 3) | fb_concat,
+				(((px >> 0) & 0x1F) << 3) | fb_concat,
+				0xff);
+	}
+}
+
+template<typename Packer>
+static void readLine565(const u8 *src, u32 *dst, int width, u32 fb_concat)
+{
+	int i = 0;
+#ifdef FB_SIMD
+	const PixelVec concat = vsplat(fb_concat);
+	const PixelVec concatGreen = vsplat(fb_concat & 3);
+	for (; i + 8 <= width; i += 8)
+	{
+		const PixelVec v = vload16(src + i * 2);
+		packPixels8<Packer>((u8 *)&dst[i],
+				vor(vshl<3>(vshr<11>(v)), concat),
+				vor(vshl<2>(vand(vshr<5>(v), vsplat(0x3f))), concatGreen),
+				vor(vshl<3>(vand(v, vsplat(0x1f))), concat));
+	}
+#endif
+	for (; i < width; i++)
+	{
+		u16 px;
+		memcpy(&px, src + i * 2, sizeof(px));
+		dst[i] = Packer::pack(
+				(((px >> 11) & 0x1F) << 3) | fb_concat,
+				(((px >> 5) & 0x3F) << 2) | (fb_concat & 3),
+				(((px >> 0) & 0x1F) << 3) | fb_concat,
+				0xFF);
+	}
+}
+
+template<typename Packer>
+static void readLine888(const u8 *line, u32 *dst, int width)
+{
+	const u32 *words = (const u32 *)line;
+	for (int i = 0; i < width; i += 4)
+	{
+		u32 src = *words++;
+		*dst++ = Packer::pack(src >> 16, src >> 8, src, 0xff);
+		if (i + 1 >= width)
+			break;
+		u32 src2 = *words++;
+		*dst++ = Packer::pack(src2 >> 8, src2, src >> 24, 0xff);
+		if (i + 2 >= width)
+			break;
+		u32 src3 = *words++;
+		*dst++ = Packer::pack(src3, src2 >> 24, src2 >> 16, 0xff);
+		if (i + 3 >= width)
+			break;
+		*dst++ = Packer::pack(src3 >> 24, src3 >> 16, src3 >> 8, 0xff);
+	}
+}
+
+template<typename Packer>
+static void readLineC888(const u8 *src, u32 *dst, int width)
+{
+	int i = 0;
+#ifdef FB_SIMD
+	for (; i + 8 <= width; i += 8)
+		convertC888<Packer::pack(1, 0, 0, 0) == 1>(src + i * 4, (u8 *)&dst[i]);
+#endif
+	for (; i < width; i++)
+	{
+		u32 px;
+		memcpy(&px, src + i * 4, sizeof(px));
+		dst[i] = Packer::pack(px >> 16, px >> 8, px, 0xff);
+	}
+}
+
 template<typename Packer>
 void ReadFramebuffer(const FramebufferInfo& info, PixelBuffer<u32>& pb, int& width, int& height)
 {
+	FramebufferTimer timer(fbReadTime, fbReadCount);
 	width = (info.fb_r_size.fb_x_size + 1) * 2;     // in 16-bit words
 	height = info.fb_r_size.fb_y_size + 1;
 	int modulus = (info.fb_r_size.fb_modulus - 1) * 2;
@@ -891,78 +1240,30 @@ void ReadFramebuffer(const FramebufferInfo& info, PixelBuffer<u32>& pb, int& wid
 	u32 *dst = (u32 *)pb.data();
 	const u32 fb_concat = info.fb_r_ctrl.fb_concat;
 
-	switch (info.fb_r_ctrl.fb_depth)
+	// Each line is copied out of the 32-bit vram area before being converted.
+	// Packed 24-bit lines are read as whole 32-bit words.
+	const u32 lineSize = bpp == 3 ? (width * 3 + 3) / 4 * 4 : width * bpp;
+	std::vector<u8> line(lineSize);
+	for (int y = 0; y < height; y++)
 	{
-		case fbde_0555:    // 555 RGB
-			for (int y = 0; y < height; y++)
-			{
-				for (int i = 0; i < width; i++)
-				{
-					u16 src = pvr_read32p<u16>(addr);
-					*dst++ = Packer::pack(
-							(((src >> 10) & 0x1F) << 3) | fb_concat,
-							(((src >> 5) & 0x1F) << 3) | fb_concat,
-							(((src >> 0) & 0x1F) << 3) | fb_concat,
-							0xff);
-					addr += bpp;
-				}
-				addr += modulus * bpp;
-			}
-			break;
-
-		case fbde_565:    // 565 RGB
-			for (int y = 0; y < height; y++)
-			{
-				for (int i = 0; i < width; i++)
-				{
-					u16 src = pvr_read32p<u16>(addr);
-					*dst++ = Packer::pack(
-							(((src >> 11) & 0x1F) << 3) | fb_concat,
-							(((src >> 5) & 0x3F) << 2) | (fb_concat & 3),
-							(((src >> 0) & 0x1F) << 3) | fb_concat,
-							0xFF);
-					addr += bpp;
-				}
-				addr += modulus * bpp;
-			}
-			break;
-		case fbde_888:		// 888 RGB
-			for (int y = 0; y < height; y++)
-			{
-				for (int i = 0; i < width; i += 4)
-				{
-					u32 src = pvr_read32p<u32>(addr);
-					*dst++ = Packer::pack(src >> 16, src >> 8, src, 0xff);
-					addr += 4;
-					if (i + 1 >= width)
-						break;
-					u32 src2 = pvr_read32p<u32>(addr);
-					*dst++ = Packer::pack(src2 >> 8, src2, src >> 24, 0xff);
-					addr += 4;
-					if (i + 2 >= width)
-						break;
-					u32 src3 = pvr_read32p<u32>(addr);
-					*dst++ = Packer::pack(src3, src2 >> 24, src2 >> 16, 0xff);
-					addr += 4;
-					if (i + 3 >= width)
-						break;
-					*dst++ = Packer::pack(src3 >> 24, src3 >> 16, src3 >> 8, 0xff);
-				}
-				addr += modulus * bpp;
-			}
-			break;
-		case fbde_C888:     // 0888 RGB
-			for (int y = 0; y < height; y++)
-			{
-				for (int i = 0; i < width; i++)
-				{
-					u32 src = pvr_read32p<u32>(addr);
-					*dst++ = Packer::pack(src >> 16, src >> 8, src, 0xff);
-					addr += bpp;
-				}
-				addr += modulus * bpp;
-			}
-			break;
+		pvr_read32_block(addr, line.data(), lineSize);
+		switch (info.fb_r_ctrl.fb_depth)
+		{
+			case fbde_0555:    // 555 RGB
+				readLine0555<Packer>(line.data(), dst, width, fb_concat);
+				break;
+			case fbde_565:    // 565 RGB
+				readLine565<Packer>(line.data(), dst, width, fb_concat);
+				break;
+			case fbde_888:		// 888 RGB
+				readLine888<Packer>(line.data(), dst, width);
+				break;
+			case fbde_C888:     // 0888 RGB
+				readLineC888<Packer>(line.data(), dst, width);
+				break;
+		}
+		dst += width;
+		addr += lineSize + modulus * bpp;
 	}
 }
 template void ReadFramebuffer<RGBAPacker>(const FramebufferInfo& info, PixelBuffer<u32>& pb, int& width, int& height);
@@ -977,42 +1278,39 @@ static inline u8 roundColor(u8 in)
 	return out;
 }
 
-// write to 32-bit vram area (framebuffer)
-class FBPixelWriter
+// write to memory: 64-bit vram area (render to texture) or framebuffer line buffer
+class MemPixelWriter
 {
 public:
-	FBPixelWriter(u32 dstAddr) : dstAddr(dstAddr) {}
+	MemPixelWriter(void *dest) : dest((u8 *)dest) {}
 
 	template<typename T>
 	void write(T pixel) {
-		pvr_write32p(dstAddr, pixel);
-		dstAddr += sizeof(T);
+		memcpy(dest, &pixel, sizeof(T));
+		dest += sizeof(T);
 	}
 
-	void advance(int bytes) {
-		dstAddr += bytes;
+	// Returns the destination of the next bytes written
+	u8 *reserve(int bytes) {
+		u8 *p = dest;
+		dest += bytes;
+		return p;
 	}
 
-private:
-	u32 dstAddr;
-};
-
-// write to 64-bit vram area (render to texture)
-class TexPixelWriter
-{
-public:
-	TexPixelWriter(u16 *dest) : dest(dest) {}
+	void advance(int bytes) {
+		dest += bytes;
+	}
 
-	void write(u16 pixel) {
-		*dest++ = pixel;
+	void seek(void *dest) {
+		this->dest = (u8 *)dest;
 	}
 
-	void advance(int bytes) {
-		(u8 *&)dest += bytes;
+	const u8 *position() const {
+		return dest;
 	}
 
 private:
-	u16 *dest;
+	u8 *dest;
 };
 
 // 0555 KRGB 16 bit  (default)	Bit 15 is the value of fb_kval[7].
@@ -1026,7 +1324,18 @@ public:
 
 	void write(int xmin, int xmax, const u8 *& pixel, int y)
 	{
-		for (int c = xmin; c < xmax; c++)
+		int c = xmin;
+#ifdef FB_SIMD
+		const PixelVec kval = vsplat(kval_bit);
+		for (; c + 8 <= xmax; c += 8, pixel += 32)
+		{
+			Pixels8<Red, Green, Blue, Alpha> px(pixel);
+			vstore16(pixWriter.reserve(16), vor(
+					vor(vshl<10>(reduceChannel<5, Round>(px.r)), vshl<5>(reduceChannel<5, Round>(px.g))),
+					vor(reduceChannel<5, Round>(px.b), kval)));
+		}
+#endif
+		for (; c < xmax; c++)
 		{
 			u8 red, green, blue;
 			if constexpr (Round)
@@ -1062,7 +1371,17 @@ public:
 
 	void write(int xmin, int xmax, const u8 *& pixel, int y)
 	{
-		for (int c = xmin; c < xmax; c++)
+		int c = xmin;
+#ifdef FB_SIMD
+		for (; c + 8 <= xmax; c += 8, pixel += 32)
+		{
+			Pixels8<Red, Green, Blue, Alpha> px(pixel);
+			vstore16(pixWriter.reserve(16), vor(
+					vor(vshl<11>(reduceChannel<5, Round>(px.r)), vshl<5>(reduceChannel<6, Round>(px.g))),
+					reduceChannel<5, Round>(px.b)));
+		}
+#endif
+		for (; c < xmax; c++)
 		{
 			u8 red, green, blue;
 			if constexpr (Round)
@@ -1097,7 +1416,17 @@ public:
 
 	void write(int xmin, int xmax, const u8 *& pixel, int y)
 	{
-		for (int c = xmin; c < xmax; c++)
+		int c = xmin;
+#ifdef FB_SIMD
+		for (; c + 8 <= xmax; c += 8, pixel += 32)
+		{
+			Pixels8<Red, Green, Blue, Alpha> px(pixel);
+			vstore16(pixWriter.reserve(16), vor(
+					vor(vshl<8>(reduceChannel<4, Round>(px.r)), vshl<4>(reduceChannel<4, Round>(px.g))),
+					vor(reduceChannel<4, Round>(px.b), vshl<12>(reduceChannel<4, Round>(px.a)))));
+		}
+#endif
+		for (; c < xmax; c++)
 		{
 			u8 red, green, blue, alpha;
 			if constexpr (Round)
@@ -1136,7 +1465,18 @@ public:
 
 	void write(int xmin, int xmax, const u8 *& pixel, int y)
 	{
-		for (int c = xmin; c < xmax; c++)
+		int c = xmin;
+#ifdef FB_SIMD
+		const PixelVec alphaBit = vsplat(0x8000);
+		for (; c + 8 <= xmax; c += 8, pixel += 32)
+		{
+			Pixels8<Red, Green, Blue, Alpha> px(pixel);
+			vstore16(pixWriter.reserve(16), vor(
+					vor(vshl<10>(reduceChannel<5, Round>(px.r)), vshl<5>(reduceChannel<5, Round>(px.g))),
+					vor(reduceChannel<5, Round>(px.b), vand(vgreaterEqual(px.a, fb_alpha_threshold), alphaBit))));
+		}
+#endif
+		for (; c < xmax; c++)
 		{
 			u8 red, green, blue;
 			if constexpr (Round)
@@ -1201,7 +1541,16 @@ public:
 
 	void write(int xmin, int xmax, const u8 *& pixel, int y)
 	{
-		for (int c = xmin; c < xmax; c++)
+		int c = xmin;
+#ifdef FB_SIMD
+		const PixelVec kval = vsplat(fb_kval >> 16);
+		for (; c + 8 <= xmax; c += 8, pixel += 32)
+		{
+			Pixels8<Red, Green, Blue, Alpha> px(pixel);
+			vstore32(pixWriter.reserve(32), vor(vshl<8>(px.g), px.b), vor(kval, px.r));
+		}
+#endif
+		for (; c < xmax; c++)
 		{
 			pixWriter.write((u32)((pixel[Red] << 16) | (pixel[Green] << 8) | pixel[Blue] | fb_kval));
 			pixel += 4;
@@ -1224,7 +1573,15 @@ public:
 
 	void write(int xmin, int xmax, const u8 *& pixel, int y)
 	{
-		for (int c = xmin; c < xmax; c++)
+		int c = xmin;
+#ifdef FB_SIMD
+		for (; c + 8 <= xmax; c += 8, pixel += 32)
+		{
+			Pixels8<Red, Green, Blue, Alpha> px(pixel);
+			vstore32(pixWriter.reserve(32), vor(vshl<8>(px.g), px.b), vor(vshl<8>(px.a), px.r));
+		}
+#endif
+		for (; c < xmax; c++)
 		{
 			pixWriter.write((u32)((pixel[Red] << 16) | (pixel[Green] << 8) | pixel[Blue] | (pixel[Alpha] << 24)));
 			pixel += 4;
@@ -1246,7 +1603,7 @@ static void writeTexture(u32 width, u32 height, const u8 *data, u16 *dst, FB_W_C
 	else
 		padding = 0;
 
-	TexPixelWriter pixWriter(dst);
+	MemPixelWriter pixWriter(dst);
 	FBLineWriter lineWriter(fb_w_ctrl, pixWriter);
 
 	for (u32 l = 0; l < height; l++) {
@@ -1258,32 +1615,33 @@ static void writeTexture(u32 width, u32 height, const u8 *data, u16 *dst, FB_W_C
 template<int Red, int Green, int Blue, int Alpha>
 void WriteTextureToVRam(u32 width, u32 height, const u8 *data, u16 *dst, FB_W_CTRL_type fb_w_ctrl, u32 linestride)
 {
+	FramebufferTimer timer(fbWriteTime, fbWriteCount);
 	bool dither = fb_w_ctrl.fb_dither && config::EmulateFramebuffer;
 	switch (fb_w_ctrl.fb_packmode)
 	{
 	case 0: // 0555 KRGB 16 bit  (default)
 		if (dither)
-			writeTexture<FBLineWriter0555<Red, Green, Blue, Alpha, TexPixelWriter, false>>(width, height, data, dst, fb_w_ctrl, linestride);
+			writeTexture<FBLineWriter0555<Red, Green, Blue, Alpha, MemPixelWriter, false>>(width, height, data, dst, fb_w_ctrl, linestride);
 		else
-			writeTexture<FBLineWriter0555<Red, Green, Blue, Alpha, TexPixelWriter, true>>(width, height, data, dst, fb_w_ctrl, linestride);
+			writeTexture<FBLineWriter0555<Red, Green, Blue, Alpha, MemPixelWriter, true>>(width, height, data, dst, fb_w_ctrl, linestride);
 		break;
 	case 1: // 565 RGB 16 bit
 		if (dither)
-			writeTexture<FBLineWriter565<Red, Green, Blue, Alpha, TexPixelWriter, false>>(width, height, data, dst, fb_w_ctrl, linestride);
+			writeTexture<FBLineWriter565<Red, Green, Blue, Alpha, MemPixelWriter, false>>(width, height, data, dst, fb_w_ctrl, linestride);
 		else
-			writeTexture<FBLineWriter565<Red, Green, Blue, Alpha, TexPixelWriter, true>>(width, height, data, dst, fb_w_ctrl, linestride);
+			writeTexture<FBLineWriter565<Red, Green, Blue, Alpha, MemPixelWriter, true>>(width, height, data, dst, fb_w_ctrl, linestride);
 		break;
 	case 2: // 4444 ARGB 16 bit
 		if (dither)
-			writeTexture<FBLineWriter4444<Red, Green, Blue, Alpha, TexPixelWriter, false>>(width, height, data, dst, fb_w_ctrl, linestride);
+			writeTexture<FBLineWriter4444<Red, Green, Blue, Alpha, MemPixelWriter, false>>(width, height, data, dst, fb_w_ctrl, linestride);
 		else
-			writeTexture<FBLineWriter4444<Red, Green, Blue, Alpha, TexPixelWriter, true>>(width, height, data, dst, fb_w_ctrl, linestride);
+			writeTexture<FBLineWriter4444<Red, Green, Blue, Alpha, MemPixelWriter, true>>(width, height, data, dst, fb_w_ctrl, linestride);
 		break;
 	case 3: // 1555 ARGB 16 bit
 		if (dither)
-			writeTexture<FBLineWriter1555<Red, Green, Blue, Alpha, TexPixelWriter, false>>(width, height, data, dst, fb_w_ctrl, linestride);
+			writeTexture<FBLineWriter1555<Red, Green, Blue, Alpha, MemPixelWriter, false>>(width, height, data, dst, fb_w_ctrl, linestride);
 		else
-			writeTexture<FBLineWriter1555<Red, Green, Blue, Alpha, TexPixelWriter, true>>(width, height, data, dst, fb_w_ctrl, linestride);
+			writeTexture<FBLineWriter1555<Red, Green, Blue, Alpha, MemPixelWriter, true>>(width, height, data, dst, fb_w_ctrl, linestride);
 		break;
 	}
 }
@@ -1307,17 +1665,23 @@ static void writeFramebufferLW(u32 width, u32 height, const u8 *data, u32 dstAdd
 	const u32 clipWidth = std::min(width, xclip.max + 1u);
 	height = std::min(height, yclip.max + 1u);
 
-	FBPixelWriter pixWriter(dstAddr);
+	// Lines are converted into a buffer and then copied to the 32-bit vram area
+	std::vector<u8> line(width * 4);
+	MemPixelWriter pixWriter(line.data());
 	FBLineWriter lineWriter(fb_w_ctrl, pixWriter);
 
 	for (u32 l = yclip.min; l < height; l++)
 	{
 		p += 4 * xclip.min;
-		pixWriter.advance(bpp * xclip.min);
+		dstAddr += bpp * xclip.min;
 
+		pixWriter.seek(line.data());
 		lineWriter.write(xclip.min, clipWidth, p, l);
+		const u32 size = pixWriter.position() - line.data();
+		if (size != 0)
+			pvr_write32_block(dstAddr, line.data(), size);
 
-		pixWriter.advance(padding + (width - xclip.max - 1) * bpp);
+		dstAddr += size + padding + (width - xclip.max - 1) * bpp;
 		p += (width - xclip.max - 1) * 4;
 	}
 }
@@ -1325,28 +1689,29 @@ static void writeFramebufferLW(u32 width, u32 height, const u8 *data, u32 dstAdd
 template<int Red, int Green, int Blue, int Alpha>
 void WriteFramebuffer(u32 width, u32 height, const u8 *data, u32 dstAddr, FB_W_CTRL_type fb_w_ctrl, u32 linestride, FB_X_CLIP_type xclip, FB_Y_CLIP_type yclip)
 {
+	FramebufferTimer timer(fbWriteTime, fbWriteCount);
 	switch (fb_w_ctrl.fb_packmode)
 	{
 	case 0: // 0555 KRGB 16 bit
-		writeFramebufferLW<FBLineWriter0555<Red, Green, Blue, Alpha, FBPixelWriter>>(width, height, data, dstAddr, fb_w_ctrl, linestride, xclip, yclip);
+		writeFramebufferLW<FBLineWriter0555<Red, Green, Blue, Alpha, MemPixelWriter>>(width, height, data, dstAddr, fb_w_ctrl, linestride, xclip, yclip);
 		break;
 	case 1: // 565 RGB 16 bit
-		writeFramebufferLW<FBLineWriter565<Red, Green, Blue, Alpha, FBPixelWriter>>(width, height, data, dstAddr, fb_w_ctrl, linestride, xclip, yclip);
+		writeFramebufferLW<FBLineWriter565<Red, Green, Blue, Alpha, MemPixelWriter>>(width, height, data, dstAddr, fb_w_ctrl, linestride, xclip, yclip);
 		break;
 	case 2: // 4444 ARGB 16 bit
-		writeFramebufferLW<FBLineWriter4444<Red, Green, Blue, Alpha, FBPixelWriter>>(width, height, data, dstAddr, fb_w_ctrl, linestride, xclip, yclip);
+		writeFramebufferLW<FBLineWriter4444<Red, Green, Blue, Alpha, MemPixelWriter>>(width, height, data, dstAddr, fb_w_ctrl, linestride, xclip, yclip);
 		break;
 	case 3: // 1555 ARGB 16 bit
-		writeFramebufferLW<FBLineWriter1555<Red, Green, Blue, Alpha, FBPixelWriter>>(width, height, data, dstAddr, fb_w_ctrl, linestride, xclip, yclip);
+		writeFramebufferLW<FBLineWriter1555<Red, Green, Blue, Alpha, MemPixelWriter>>(width, height, data, dstAddr, fb_w_ctrl, linestride, xclip, yclip);
 		break;
 	case 4: // 888 RGB 24 bit packed
-		writeFramebufferLW<FBLineWriter888<Red, Green, Blue, Alpha, FBPixelWriter>>(width, height, data, dstAddr, fb_w_ctrl, linestride, xclip, yclip);
+		writeFramebufferLW<FBLineWriter888<Red, Green, Blue, Alpha, MemPixelWriter>>(width, height, data, dstAddr, fb_w_ctrl, linestride, xclip, yclip);
 		break;
 	case 5: // 0888 KRGB 32 bit
-		writeFramebufferLW<FBLineWriter0888<Red, Green, Blue, Alpha, FBPixelWriter>>(width, height, data, dstAddr, fb_w_ctrl, linestride, xclip, yclip);
+		writeFramebufferLW<FBLineWriter0888<Red, Green, Blue, Alpha, MemPixelWriter>>(width, height, data, dstAddr, fb_w_ctrl, linestride, xclip, yclip);
 		break;
 	case 6: // 8888 ARGB 32 bit
-		writeFramebufferLW<FBLineWriter8888<Red, Green, Blue, Alpha, FBPixelWriter>>(width, height, data, dstAddr, fb_w_ctrl, linestride, xclip, yclip);
+		writeFramebufferLW<FBLineWriter8888<Red, Green, Blue, Alpha, MemPixelWriter>>(width, height, data, dstAddr, fb_w_ctrl, linestride, xclip, yclip);
 		break;
 	default:
 		die("Invalid framebuffer format");
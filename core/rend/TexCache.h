@@ -129,13 +129,13 @@ public:
 
 // OpenGL
 struct RGBAPacker {
-	static u32 pack(u8 r, u8 g, u8 b, u8 a) {
+	static constexpr u32 pack(u8 r, u8 g, u8 b, u8 a) {
 		return r | (g << 8) | (b << 16) | (a << 24);
 	}
 };
 // DirectX
 struct BGRAPacker {
-	static u32 pack(u8 r, u8 g, u8 b, u8 a) {
+	static constexpr u32 pack(u8 r, u8 g, u8 b, u8 a) {
 		return b | (g << 8) | (r << 16) | (a << 24);
 	}
 };
@@ -560,6 +560,8 @@ struct vram_block
 
 bool VramLockedWriteOffset(size_t offset);
 bool VramLockedWrite(u8* address);
+// Invalidates the textures of a vram range before it's written to in bulk
+void VramLockedWriteRange(size_t offset, size_t size);
 
 void UpscalexBRZ(int factor, u32* source, u32* dest, int width, int height, bool has_alpha);
 
@@ -813,6 +815,15 @@ void WriteFramebuffer(u32 width, u32 height, const u8 *data, u32 dstAddr, FB_W_C
 // width and height in pixels. linestride in bytes
 template<int Red = 0, int Green = 1, int Blue = 2, int Alpha = 3>
 void WriteTextureToVRam(u32 width, u32 height, const u8 *data, u16 *dst, FB_W_CTRL_type fb_w_ctrl, u32 linestride);
+
+struct FramebufferStats
+{
+	u64 readTime;	// time spent reading framebuffers from vram, in microseconds
+	u64 writeTime;	// time spent writing framebuffers and render-to-texture buffers to vram, in microseconds
+	u32 reads;
+	u32 writes;
+};
+FramebufferStats getFramebufferStats();
 void getRenderToTextureDimensions(u32& width, u32& height, u32& pow2Width, u32& pow2Height);
 
 static inline void MakeFogTexture(u8 *tex_data)
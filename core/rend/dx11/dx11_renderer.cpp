@@ -34,7 +34,7 @@ const D3D11_INPUT_ELEMENT_DESC MainLayout[]
 	{ "COLOR",    0, DXGI_FORMAT_B8G8R8A8_UNORM, 0, (UINT)offsetof(Vertex, col), D3D11_INPUT_PER_VERTEX_DATA, 0 },
 	{ "COLOR",    1, DXGI_FORMAT_B8G8R8A8_UNORM, 0, (UINT)offsetof(Vertex, spc), D3D11_INPUT_PER_VERTEX_DATA, 0 },
 	{ "TEXCOORD", 0, DXGI_FORMAT_R32G32_FLOAT,   0, (UINT)offsetof(Vertex, u),  D3D11_INPUT_PER_VERTEX_DATA, 0 },
-	{ "NORMAL",   0, DXGI_FORMAT_R32G32B32_FLOAT, 0, (UINT)offsetof(Vertex, nx),  D3D11_INPUT_PER_VERTEX_DATA, 0 },
+	{ "NORMAL",   0, DXGI_FORMAT_R32G32B32_FLOAT, 2, (UINT)offsetof(VertexNormal, nx),  D3D11_INPUT_PER_VERTEX_DATA, 0 },
 };
 const D3D11_INPUT_ELEMENT_DESC ModVolLayout[]
 {
@@ -369,12 +369,24 @@ void DX11Renderer::uploadGeometryBuffers()
 {
 	setFirstProvokingVertex(pvrrc);
 
-	size_t size = pvrrc.verts.size() * sizeof(decltype(*pvrrc.verts.data()));
+	// The optional vertex streams are packed after the base vertices.
+	// Empty streams point at the base vertices, which are never read.
+	const size_t baseSize = pvrrc.verts.size() * sizeof(decltype(*pvrrc.verts.data()));
+	const size_t twoVolumesSize = pvrrc.vertsTwoVolumes.size() * sizeof(decltype(*pvrrc.vertsTwoVolumes.data()));
+	const size_t normalSize = pvrrc.vertsNormal.size() * sizeof(decltype(*pvrrc.vertsNormal.data()));
+	vertexStreamOffsets[0] = 0;
+	vertexStreamOffsets[1] = twoVolumesSize == 0 ? 0 : (u32)baseSize;
+	vertexStreamOffsets[2] = normalSize == 0 ? 0 : (u32)(baseSize + twoVolumesSize);
+	size_t size = baseSize + twoVolumesSize + normalSize;
 	bool rc = ensureBufferSize(vertexBuffer, D3D11_BIND_VERTEX_BUFFER, vertexBufferSize, size);
 	verify(rc);
 	D3D11_MAPPED_SUBRESOURCE mappedSubres;
 	deviceContext->Map(vertexBuffer, 0, D3D11_MAP_WRITE_DISCARD, 0, &mappedSubres);
-	memcpy(mappedSubres.pData, pvrrc.verts.data(), size);
+	memcpy(mappedSubres.pData, pvrrc.verts.data(), baseSize);
+	if (twoVolumesSize != 0)
+		memcpy((u8 *)mappedSubres.pData + vertexStreamOffsets[1], pvrrc.vertsTwoVolumes.data(), twoVolumesSize);
+	if (normalSize != 0)
+		memcpy((u8 *)mappedSubres.pData + vertexStreamOffsets[2], pvrrc.vertsNormal.data(), normalSize);
 	deviceContext->Unmap(vertexBuffer, 0);
 
 	size = pvrrc.idx.size() * sizeof(decltype(*pvrrc.idx.data()));
@@ -394,12 +406,17 @@ void DX11Renderer::uploadGeometryBuffers()
 		memcpy(mappedSubres.pData, data, size);
 		deviceContext->Unmap(modvolBuffer, 0);
 	}
-    unsigned int stride = sizeof(Vertex);
-    unsigned int offset = 0;
-	deviceContext->IASetVertexBuffers(0, 1, &vertexBuffer.get(), &stride, &offset);
+	setMainVertexBuffers();
 	deviceContext->IASetIndexBuffer(indexBuffer, DXGI_FORMAT_R32_UINT, 0);
 }
 
+void DX11Renderer::setMainVertexBuffers()
+{
+	static const UINT strides[] { sizeof(Vertex), sizeof(VertexTwoVolumes), sizeof(VertexNormal) };
+	ID3D11Buffer *buffers[] { vertexBuffer, vertexBuffer, vertexBuffer };
+	deviceContext->IASetVertexBuffers(0, std::size(buffers), buffers, strides, vertexStreamOffsets);
+}
+
 void DX11Renderer::setupPixelShaderConstants()
 {
 	PixelConstants pixelConstants;
@@ -868,9 +885,7 @@ void DX11Renderer::drawModVols(int first, int count)
 	deviceContext->OMSetDepthStencilState(depthStencilStates.getMVState(DepthStencilStates::Final), 0x81);
 
 	deviceContext->IASetInputLayout(mainInputLayout);
-    stride = sizeof(Vertex);
-    offset = 0;
-	deviceContext->IASetVertexBuffers(0, 1, &vertexBuffer.get(), &stride, &offset);
+	setMainVertexBuffers();
 	deviceContext->IASetIndexBuffer(indexBuffer, DXGI_FORMAT_R32_UINT, 0);
 	deviceContext->IASetPrimitiveTopology(D3D_PRIMITIVE_TOPOLOGY_TRIANGLESTRIP);
 
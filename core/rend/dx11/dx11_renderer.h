@@ -90,6 +90,7 @@ protected:
 	void createTexAndRenderTarget(ComPtr<ID3D11Texture2D>& texture, ComPtr<ID3D11RenderTargetView>& renderTarget, int width, int height);
 	void configVertexShader();
 	void uploadGeometryBuffers();
+	void setMainVertexBuffers();
 	void setupPixelShaderConstants();
 	void updateFogTexture();
 	void updatePaletteTexture();
@@ -108,6 +109,7 @@ protected:
 	ComPtr<ID3D11InputLayout> modVolInputLayout;
 	ComPtr<ID3D11Buffer> pxlPolyConstants;
 	ComPtr<ID3D11Buffer> vertexBuffer;
+	UINT vertexStreamOffsets[3] {};
 	ComPtr<ID3D11Buffer> indexBuffer;
 	ComPtr<ID3D11Buffer> modvolBuffer;
 	ComPtr<ID3D11RenderTargetView> fbRenderTarget;
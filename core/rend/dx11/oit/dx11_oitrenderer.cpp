@@ -35,11 +35,11 @@ const D3D11_INPUT_ELEMENT_DESC MainLayout[]
 	{ "COLOR",    0, DXGI_FORMAT_B8G8R8A8_UNORM, 0, (UINT)offsetof(Vertex, col), D3D11_INPUT_PER_VERTEX_DATA, 0 },
 	{ "COLOR",    1, DXGI_FORMAT_B8G8R8A8_UNORM, 0, (UINT)offsetof(Vertex, spc), D3D11_INPUT_PER_VERTEX_DATA, 0 },
 	{ "TEXCOORD", 0, DXGI_FORMAT_R32G32_FLOAT,   0, (UINT)offsetof(Vertex, u),  D3D11_INPUT_PER_VERTEX_DATA, 0 },
-	{ "COLOR",    2, DXGI_FORMAT_B8G8R8A8_UNORM, 0, (UINT)offsetof(Vertex, col1), D3D11_INPUT_PER_VERTEX_DATA, 0 },
-	{ "COLOR",    3, DXGI_FORMAT_B8G8R8A8_UNORM, 0, (UINT)offsetof(Vertex, spc1), D3D11_INPUT_PER_VERTEX_DATA, 0 },
-	{ "TEXCOORD", 1, DXGI_FORMAT_R32G32_FLOAT,   0, (UINT)offsetof(Vertex, u1),  D3D11_INPUT_PER_VERTEX_DATA, 0 },
+	{ "COLOR",    2, DXGI_FORMAT_B8G8R8A8_UNORM, 1, (UINT)offsetof(VertexTwoVolumes, col1), D3D11_INPUT_PER_VERTEX_DATA, 0 },
+	{ "COLOR",    3, DXGI_FORMAT_B8G8R8A8_UNORM, 1, (UINT)offsetof(VertexTwoVolumes, spc1), D3D11_INPUT_PER_VERTEX_DATA, 0 },
+	{ "TEXCOORD", 1, DXGI_FORMAT_R32G32_FLOAT,   1, (UINT)offsetof(VertexTwoVolumes, u1),  D3D11_INPUT_PER_VERTEX_DATA, 0 },
 	// Naomi 2
-	{ "NORMAL",   0, DXGI_FORMAT_R32G32B32_FLOAT, 0, (UINT)offsetof(Vertex, nx),  D3D11_INPUT_PER_VERTEX_DATA, 0 },
+	{ "NORMAL",   0, DXGI_FORMAT_R32G32B32_FLOAT, 2, (UINT)offsetof(VertexNormal, nx),  D3D11_INPUT_PER_VERTEX_DATA, 0 },
 };
 
 struct DX11OITRenderer : public DX11Renderer
@@ -447,9 +447,7 @@ struct DX11OITRenderer : public DX11Renderer
 
 		// Restore main input layout and vertex buffers
 		deviceContext->IASetInputLayout(mainInputLayout);
-	    stride = sizeof(Vertex);
-	    offset = 0;
-		deviceContext->IASetVertexBuffers(0, 1, &vertexBuffer.get(), &stride, &offset);
+		setMainVertexBuffers();
 		deviceContext->IASetIndexBuffer(indexBuffer, DXGI_FORMAT_R32_UINT, 0);
 	}
 
@@ -139,6 +139,8 @@ struct gl4_ctx
 	struct
 	{
 		std::unique_ptr<GlBuffer> geometry[2];
+		std::unique_ptr<GlBuffer> twoVolumes[2];
+		std::unique_ptr<GlBuffer> normals[2];
 		std::unique_ptr<GlBuffer> modvols[2];
 		std::unique_ptr<GlBuffer> idxs[2];
 		Gl4MainVertexArray main_vao[2];
@@ -149,6 +151,12 @@ struct gl4_ctx
 		GlBuffer *getVertexBuffer() {
 			return geometry[bufferIndex].get();
 		}
+		GlBuffer *getTwoVolumesBuffer() {
+			return twoVolumes[bufferIndex].get();
+		}
+		GlBuffer *getNormalBuffer() {
+			return normals[bufferIndex].get();
+		}
 		GlBuffer *getIndexBuffer() {
 			return idxs[bufferIndex].get();
 		}
@@ -202,6 +210,7 @@ public:
 };
 
 void gl4SetupMainVBO();
+void gl4EnableVertexStreams();
 void gl4SetupModvolVBO();
 void gl4CreateTextures(int width, int height);
 
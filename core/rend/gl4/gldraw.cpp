@@ -353,17 +353,38 @@ void Gl4MainVertexArray::defineVtxAttribs()
 	glEnableVertexAttribArray(VERTEX_UV_ARRAY);
 	glVertexAttribPointer(VERTEX_UV_ARRAY, 2, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)offsetof(Vertex,u));
 
+	gl4.vbo.getTwoVolumesBuffer()->bind();
 	glEnableVertexAttribArray(VERTEX_COL_BASE1_ARRAY);
-	glVertexAttribPointer(VERTEX_COL_BASE1_ARRAY, 4, GL_UNSIGNED_BYTE, GL_TRUE, sizeof(Vertex), (void*)offsetof(Vertex, col1));
+	glVertexAttribPointer(VERTEX_COL_BASE1_ARRAY, 4, GL_UNSIGNED_BYTE, GL_TRUE, sizeof(VertexTwoVolumes), (void*)offsetof(VertexTwoVolumes, col1));
 
 	glEnableVertexAttribArray(VERTEX_COL_OFFS1_ARRAY);
-	glVertexAttribPointer(VERTEX_COL_OFFS1_ARRAY, 4, GL_UNSIGNED_BYTE, GL_TRUE, sizeof(Vertex), (void*)offsetof(Vertex, spc1));
+	glVertexAttribPointer(VERTEX_COL_OFFS1_ARRAY, 4, GL_UNSIGNED_BYTE, GL_TRUE, sizeof(VertexTwoVolumes), (void*)offsetof(VertexTwoVolumes, spc1));
 
 	glEnableVertexAttribArray(VERTEX_UV1_ARRAY);
-	glVertexAttribPointer(VERTEX_UV1_ARRAY, 2, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)offsetof(Vertex, u1));
+	glVertexAttribPointer(VERTEX_UV1_ARRAY, 2, GL_FLOAT, GL_FALSE, sizeof(VertexTwoVolumes), (void*)offsetof(VertexTwoVolumes, u1));
 
+	gl4.vbo.getNormalBuffer()->bind();
 	glEnableVertexAttribArray(VERTEX_NORM_ARRAY);
-	glVertexAttribPointer(VERTEX_NORM_ARRAY, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)offsetof(Vertex, nx));
+	glVertexAttribPointer(VERTEX_NORM_ARRAY, 3, GL_FLOAT, GL_FALSE, sizeof(VertexNormal), (void*)offsetof(VertexNormal, nx));
+	gl4.vbo.getVertexBuffer()->bind();
+}
+
+void gl4EnableVertexStreams()
+{
+	gl4SetupMainVBO();
+	// The optional vertex streams are only present in frames that use them
+	const bool twoVolumes = !pvrrc.vertsTwoVolumes.empty();
+	for (GLuint array : { VERTEX_COL_BASE1_ARRAY, VERTEX_COL_OFFS1_ARRAY, VERTEX_UV1_ARRAY })
+	{
+		if (twoVolumes)
+			glEnableVertexAttribArray(array);
+		else
+			glDisableVertexAttribArray(array);
+	}
+	if (pvrrc.vertsNormal.empty())
+		glDisableVertexAttribArray(VERTEX_NORM_ARRAY);
+	else
+		glEnableVertexAttribArray(VERTEX_NORM_ARRAY);
 }
 
 void gl4SetupModvolVBO()
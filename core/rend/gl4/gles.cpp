@@ -615,6 +615,10 @@ static void gl4_term()
 {
 	for (auto& buffer : gl4.vbo.geometry)
 		buffer.reset();
+	for (auto& buffer : gl4.vbo.twoVolumes)
+		buffer.reset();
+	for (auto& buffer : gl4.vbo.normals)
+		buffer.reset();
 	for (auto& buffer : gl4.vbo.modvols)
 		buffer.reset();
 	for (auto& buffer : gl4.vbo.idxs)
@@ -659,6 +663,8 @@ static void gl_create_resources()
 	for (u32 i = 0; i < std::size(gl4.vbo.geometry); i++)
 	{
 		gl4.vbo.geometry[i] = std::make_unique<GlBuffer>(GL_ARRAY_BUFFER);
+		gl4.vbo.twoVolumes[i] = std::make_unique<GlBuffer>(GL_ARRAY_BUFFER);
+		gl4.vbo.normals[i] = std::make_unique<GlBuffer>(GL_ARRAY_BUFFER);
 		gl4.vbo.modvols[i] = std::make_unique<GlBuffer>(GL_ARRAY_BUFFER);
 		gl4.vbo.idxs[i] = std::make_unique<GlBuffer>(GL_ELEMENT_ARRAY_BUFFER);
 		// Create the buffer for Translucent poly params
@@ -897,6 +903,10 @@ bool OpenGL4Renderer::renderFrame(int width, int height)
 	//Main VBO
 	//move vertex to gpu
 	gl4.vbo.getVertexBuffer()->update(pvrrc.verts.data(), pvrrc.verts.size() * sizeof(decltype(*pvrrc.verts.data())));
+	if (!pvrrc.vertsTwoVolumes.empty())
+		gl4.vbo.getTwoVolumesBuffer()->update(pvrrc.vertsTwoVolumes.data(), pvrrc.vertsTwoVolumes.size() * sizeof(decltype(*pvrrc.vertsTwoVolumes.data())));
+	if (!pvrrc.vertsNormal.empty())
+		gl4.vbo.getNormalBuffer()->update(pvrrc.vertsNormal.data(), pvrrc.vertsNormal.size() * sizeof(decltype(*pvrrc.vertsNormal.data())));
 	gl4.vbo.getIndexBuffer()->update(pvrrc.idx.data(), pvrrc.idx.size() * sizeof(decltype(*pvrrc.idx.data())));
 
 	//Modvol VBO
@@ -917,6 +927,7 @@ bool OpenGL4Renderer::renderFrame(int width, int height)
 		// Declare storage
 		glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 1, gl4.vbo.getPolyParamBuffer()->getName());
 	}
+	gl4EnableVertexStreams();
 	glCheck();
 
 	if (is_rtt || !config::Widescreen || matrices.IsClipped() || config::Rotate90 || config::EmulateFramebuffer)
@@ -463,13 +463,20 @@ void MainVertexArray::defineVtxAttribs()
 	glEnableVertexAttribArray(VERTEX_UV_ARRAY);
 	glVertexAttribPointer(VERTEX_UV_ARRAY, 2, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)offsetof(Vertex,u));
 
+	gl.vbo.normals->bind();
 	glEnableVertexAttribArray(VERTEX_NORM_ARRAY);
-	glVertexAttribPointer(VERTEX_NORM_ARRAY, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)offsetof(Vertex, nx));
+	glVertexAttribPointer(VERTEX_NORM_ARRAY, 3, GL_FLOAT, GL_FALSE, sizeof(VertexNormal), (void*)offsetof(VertexNormal, nx));
+	gl.vbo.geometry->bind();
 }
 
 void SetupMainVBO()
 {
 	gl.vbo.mainVAO.bind(gl.vbo.geometry.get(), gl.vbo.idxs.get());
+	// The normal stream is only present in frames with naomi2 geometry
+	if (pvrrc.vertsNormal.empty())
+		glDisableVertexAttribArray(VERTEX_NORM_ARRAY);
+	else
+		glEnableVertexAttribArray(VERTEX_NORM_ARRAY);
 	glCheck();
 }
 
@@ -681,6 +688,52 @@ void OpenGLRenderer::RenderFramebuffer(const FramebufferInfo& info)
 	restoreCurrentFramebuffer();
 }
 
+#ifndef GLES2
+// Read the framebuffer into a pixel buffer object and write the previous frame to vram,
+// so that the GPU to vram copy of a frame overlaps with the rendering of the next one.
+static void readFramebufferAsync(u32 width, u32 height, u32 texAddr, u32 linestride, FB_X_CLIP_type xClip, FB_Y_CLIP_type yClip)
+{
+	auto& readback = gl.fbreadback;
+	auto& frame = readback.frames[readback.current];
+	const u32 size = width * height * 4;
+	if (frame.buffer == nullptr || frame.size < size)
+	{
+		frame.buffer = std::make_unique<GlBuffer>(GL_PIXEL_PACK_BUFFER, GL_STREAM_READ);
+		frame.buffer->update(nullptr, size);
+		frame.size = size;
+	}
+	else
+	{
+		frame.buffer->bind();
+	}
+	glReadPixels(0, 0, width, height, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+	frame.pending = true;
+	frame.width = width;
+	frame.height = height;
+	frame.texAddr = texAddr;
+	frame.linestride = linestride;
+	frame.fbWCtrl = pvrrc.fb_W_CTRL;
+	frame.xClip = xClip;
+	frame.yClip = yClip;
+
+	readback.current ^= 1;
+	auto& previous = readback.frames[readback.current];
+	if (previous.pending)
+	{
+		previous.buffer->bind();
+		const u8 *p = (const u8 *)glMapBufferRange(GL_PIXEL_PACK_BUFFER, 0, previous.width * previous.height * 4, GL_MAP_READ_BIT);
+		if (p != nullptr)
+		{
+			WriteFramebuffer(previous.width, previous.height, p, previous.texAddr, previous.fbWCtrl, previous.linestride,
+					previous.xClip, previous.yClip);
+			glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+		}
+		previous.pending = false;
+	}
+	glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+}
+#endif
+
 void writeFramebufferToVRAM()
 {
 	u32 width = (pvrrc.ta_GLOB_TILE_CLIP.tile_x_num + 1) * 32;
@@ -743,17 +796,29 @@ void writeFramebufferToVRAM()
 	glPixelStorei(GL_PACK_ALIGNMENT, 1);
 	u32 linestride = pvrrc.fb_W_LINESTRIDE * 8;
 
-	PixelBuffer<u32> tmp_buf;
-	tmp_buf.init(width, height);
-
-	u8 *p = (u8 *)tmp_buf.data();
-	glReadPixels(0, 0, width, height, GL_RGBA, GL_UNSIGNED_BYTE, p);
-
 	xClip.min = std::min(xClip.min, width - 1);
 	xClip.max = std::min(xClip.max, width - 1);
 	yClip.min = std::min(yClip.min, height - 1);
 	yClip.max = std::min(yClip.max, height - 1);
-	WriteFramebuffer(width, height, p, tex_addr, pvrrc.fb_W_CTRL, linestride, xClip, yClip);
+#ifndef GLES2
+	if (config::AsyncFramebufferReadback && gl.gl_major >= 3)
+	{
+		readFramebufferAsync(width, height, tex_addr, linestride, xClip, yClip);
+	}
+	else
+#endif
+	{
+		// Drop any frame left by the asynchronous path
+		for (auto& frame : gl.fbreadback.frames)
+			frame.pending = false;
+
+		PixelBuffer<u32> tmp_buf;
+		tmp_buf.init(width, height);
+
+		u8 *p = (u8 *)tmp_buf.data();
+		glReadPixels(0, 0, width, height, GL_RGBA, GL_UNSIGNED_BYTE, p);
+		WriteFramebuffer(width, height, p, tex_addr, pvrrc.fb_W_CTRL, linestride, xClip, yClip);
+	}
 
 	glBindFramebuffer(GL_FRAMEBUFFER, gl.ofbo.origFbo);
 	glCheck();
@@ -515,6 +515,12 @@ void termGLCommon()
 	gl.dcfb.tex = 0;
 	gl.ofbo2.framebuffer.reset();
 	gl.fbscaling.framebuffer.reset();
+	for (auto& frame : gl.fbreadback.frames)
+	{
+		frame.buffer.reset();
+		frame.size = 0;
+		frame.pending = false;
+	}
 	gl.videorouting.framebuffer.reset();
 	termVmuLightgun();
 #ifdef LIBRETRO
@@ -527,6 +533,7 @@ static void gles_term()
 	gl.vbo.mainVAO.term();
 	gl.vbo.modvolVAO.term();
 	gl.vbo.geometry.reset();
+	gl.vbo.normals.reset();
 	gl.vbo.modvols.reset();
 	gl.vbo.idxs.reset();
 	termGLCommon();
@@ -997,6 +1004,7 @@ static void gl_create_resources()
 
 	//create vbos
 	gl.vbo.geometry = std::make_unique<GlBuffer>(GL_ARRAY_BUFFER);
+	gl.vbo.normals = std::make_unique<GlBuffer>(GL_ARRAY_BUFFER);
 	gl.vbo.modvols = std::make_unique<GlBuffer>(GL_ARRAY_BUFFER);
 	gl.vbo.idxs = std::make_unique<GlBuffer>(GL_ELEMENT_ARRAY_BUFFER);
 
@@ -1370,6 +1378,8 @@ bool OpenGLRenderer::renderFrame(int width, int height)
 	//move vertex to gpu
 	//Main VBO
 	gl.vbo.geometry->update(&pvrrc.verts[0], pvrrc.verts.size() * sizeof(decltype(pvrrc.verts[0])));
+	if (!pvrrc.vertsNormal.empty())
+		gl.vbo.normals->update(pvrrc.vertsNormal.data(), pvrrc.vertsNormal.size() * sizeof(decltype(pvrrc.vertsNormal[0])));
 
 	upload_vertex_indices();
 
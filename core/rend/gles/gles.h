@@ -268,6 +268,7 @@ struct gl_ctx
 		MainVertexArray mainVAO;
 		ModvolVertexArray modvolVAO;
 		std::unique_ptr<GlBuffer> geometry;
+		std::unique_ptr<GlBuffer> normals;
 		std::unique_ptr<GlBuffer> modvols;
 		std::unique_ptr<GlBuffer> idxs;
 	} vbo;
@@ -297,6 +298,26 @@ struct gl_ctx
 		std::unique_ptr<GlFramebuffer> framebuffer;
 	} fbscaling;
 
+	// Asynchronous framebuffer readback: each frame is read into a pixel buffer
+	// and written to vram when the next frame is rendered.
+	struct
+	{
+		struct
+		{
+			std::unique_ptr<GlBuffer> buffer;
+			u32 size = 0;
+			bool pending = false;
+			u32 width;
+			u32 height;
+			u32 texAddr;
+			u32 linestride;
+			FB_W_CTRL_type fbWCtrl;
+			FB_X_CLIP_type xClip;
+			FB_Y_CLIP_type yClip;
+		} frames[2];
+		int current = 0;
+	} fbreadback;
+
 	struct
 	{
 		std::unique_ptr<GlFramebuffer> framebuffer;
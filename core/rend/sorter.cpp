@@ -22,7 +22,20 @@
 // On Dreamcast the last vertex is the provoking one so we must copy it onto the first.
 void setFirstProvokingVertex(rend_context& rendContext)
 {
-	auto setProvokingVertex = [&rendContext](const std::vector<PolyParam>& list) {
+	auto copyColors = [&rendContext](u32 first, u32 last) {
+		Vertex& vertex = rendContext.verts[first];
+		const Vertex& lastVertex = rendContext.verts[last];
+		memcpy(vertex.col, lastVertex.col, sizeof(vertex.col));
+		memcpy(vertex.spc, lastVertex.spc, sizeof(vertex.spc));
+		if (!rendContext.vertsTwoVolumes.empty())
+		{
+			VertexTwoVolumes& vertex1 = rendContext.vertsTwoVolumes[first];
+			const VertexTwoVolumes& lastVertex1 = rendContext.vertsTwoVolumes[last];
+			memcpy(vertex1.col1, lastVertex1.col1, sizeof(vertex1.col1));
+			memcpy(vertex1.spc1, lastVertex1.spc1, sizeof(vertex1.spc1));
+		}
+	};
+	auto setProvokingVertex = [&rendContext, &copyColors](const std::vector<PolyParam>& list) {
 		for (const PolyParam& pp : list)
 		{
 			if (pp.pcw.Gouraud)
@@ -33,7 +46,7 @@ void setFirstProvokingVertex(rend_context& rendContext)
 				if (idx == (u32)-1)
 					// primitive restart
 					continue;
-				Vertex& vertex = rendContext.verts[idx];
+				const u32 first = idx;
 				idx = rendContext.idx[pp.first + i + 1];
 				if (idx == (u32)-1) {
 					i++;
@@ -46,11 +59,7 @@ void setFirstProvokingVertex(rend_context& rendContext)
 					// primitive restart
 					continue;
 				}
-				Vertex& lastVertex = rendContext.verts[idx];
-				memcpy(vertex.col, lastVertex.col, sizeof(vertex.col));
-				memcpy(vertex.spc, lastVertex.spc, sizeof(vertex.spc));
-				memcpy(vertex.col1, lastVertex.col1, sizeof(vertex.col1));
-				memcpy(vertex.spc1, lastVertex.spc1, sizeof(vertex.spc1));
+				copyColors(first, idx);
 			}
 		}
 	};
@@ -67,14 +76,7 @@ void setFirstProvokingVertex(rend_context& rendContext)
 			if (rendContext.global_param_tr[tri.polyIndex].pcw.Gouraud)
 				continue;
 			for (u32 i = 0; i + 2 < tri.count; i += 3)
-			{
-				Vertex& vertex = rendContext.verts[rendContext.idx[tri.first + i]];
-				Vertex& lastVertex = rendContext.verts[rendContext.idx[tri.first + i + 2]];
-				memcpy(vertex.col, lastVertex.col, sizeof(vertex.col));
-				memcpy(vertex.spc, lastVertex.spc, sizeof(vertex.spc));
-				memcpy(vertex.col1, lastVertex.col1, sizeof(vertex.col1));
-				memcpy(vertex.spc1, lastVertex.spc1, sizeof(vertex.spc1));
-			}
+				copyColors(rendContext.idx[tri.first + i], rendContext.idx[tri.first + i + 2]);
 		}
 	}
 }
@@ -317,7 +317,7 @@ void Drawer::DrawModVols(const vk::CommandBuffer& cmdBuffer, int first, int coun
 			mod_base = -1;
 		}
 	}
-	cmdBuffer.bindVertexBuffers(0, curMainBuffer, {0});
+	BindMainVertexBuffers(cmdBuffer);
 
 	std::array<float, 5> pushConstants = { 1 - FPU_SHAD_SCALE.scale_factor / 256.f, 0, 0, 0, 0 };
 	cmdBuffer.pushConstants<float>(pipelineManager->GetPipelineLayout(), vk::ShaderStageFlagBits::eFragment, 0, pushConstants);
@@ -333,6 +333,10 @@ void Drawer::UploadMainBuffer(const VertexShaderUniforms& vertexUniforms, const
 
 	// Vertex
 	packer.add(pvrrc.verts.data(), pvrrc.verts.size() * sizeof(decltype(*pvrrc.verts.data())));
+	if (pvrrc.vertsNormal.empty())
+		offsets.normalOffset = 0;
+	else
+		offsets.normalOffset = packer.add(pvrrc.vertsNormal.data(), pvrrc.vertsNormal.size() * sizeof(decltype(*pvrrc.vertsNormal.data())));
 	// Modifier Volumes
 	offsets.modVolOffset = packer.add(pvrrc.modtrig.data(), pvrrc.modtrig.size() * sizeof(decltype(*pvrrc.modtrig.data())));
 	// Index
@@ -398,7 +402,7 @@ bool Drawer::Draw(const Texture *fogTexture, const Texture *paletteTexture)
 	descriptorSets.bindPerFrameDescriptorSets(cmdBuffer);
 
 	// Bind vertex and index buffers
-	cmdBuffer.bindVertexBuffers(0, curMainBuffer, {0});
+	BindMainVertexBuffers(cmdBuffer);
 	cmdBuffer.bindIndexBuffer(curMainBuffer, offsets.indexOffset, vk::IndexType::eUint32);
 
 	// Make sure to push constants even if not used
@@ -265,8 +265,15 @@ private:
 	void DrawModVols(const vk::CommandBuffer& cmdBuffer, int first, int count);
 	void UploadMainBuffer(const VertexShaderUniforms& vertexUniforms, const FragmentShaderUniforms& fragmentUniforms);
 
+	void BindMainVertexBuffers(const vk::CommandBuffer& cmdBuffer) const
+	{
+		// Empty optional streams point at the base vertices, which are never read
+		cmdBuffer.bindVertexBuffers(0, { curMainBuffer, curMainBuffer }, { 0, offsets.normalOffset });
+	}
+
 	int imageIndex = 0;
 	struct {
+		vk::DeviceSize normalOffset = 0;
 		vk::DeviceSize indexOffset = 0;
 		vk::DeviceSize modVolOffset = 0;
 		vk::DeviceSize vertexUniformOffset = 0;
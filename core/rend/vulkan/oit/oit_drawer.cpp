@@ -214,7 +214,7 @@ void OITDrawer::DrawModifierVolumes(const vk::CommandBuffer& cmdBuffer, int firs
 			}
 		}
 	}
-	cmdBuffer.bindVertexBuffers(0, curMainBuffer, {0});
+	BindMainVertexBuffers(cmdBuffer);
 }
 
 void OITDrawer::UploadMainBuffer(const OITDescriptorSets::VertexShaderUniforms& vertexUniforms,
@@ -224,6 +224,14 @@ void OITDrawer::UploadMainBuffer(const OITDescriptorSets::VertexShaderUniforms&
 
 	// Vertex
 	packer.add(pvrrc.verts.data(), pvrrc.verts.size() * sizeof(decltype(*pvrrc.verts.data())));
+	if (pvrrc.vertsTwoVolumes.empty())
+		offsets.twoVolumesOffset = 0;
+	else
+		offsets.twoVolumesOffset = packer.add(pvrrc.vertsTwoVolumes.data(), pvrrc.vertsTwoVolumes.size() * sizeof(decltype(*pvrrc.vertsTwoVolumes.data())));
+	if (pvrrc.vertsNormal.empty())
+		offsets.normalOffset = 0;
+	else
+		offsets.normalOffset = packer.add(pvrrc.vertsNormal.data(), pvrrc.vertsNormal.size() * sizeof(decltype(*pvrrc.vertsNormal.data())));
 	// Modifier Volumes
 	offsets.modVolOffset = packer.add(pvrrc.modtrig.data(), pvrrc.modtrig.size() * sizeof(decltype(*pvrrc.modtrig.data())));
 	// Index
@@ -340,7 +348,7 @@ bool OITDrawer::Draw(const Texture *fogTexture, const Texture *paletteTexture)
 	descriptorSets.updateColorInputDescSet(1, colorAttachments[1]->GetImageView());
 
 	// Bind vertex and index buffers
-	cmdBuffer.bindVertexBuffers(0, curMainBuffer, {0});
+	BindMainVertexBuffers(cmdBuffer);
 	cmdBuffer.bindIndexBuffer(curMainBuffer, offsets.indexOffset, vk::IndexType::eUint32);
 
 	// Make sure to push constants even if not used
@@ -448,7 +456,7 @@ bool OITDrawer::Draw(const Texture *fogTexture, const Texture *paletteTexture)
 		if (!finalPass)
 		{
 	    	// Re-bind vertex and index buffers
-	    	cmdBuffer.bindVertexBuffers(0, curMainBuffer, {0});
+	    	BindMainVertexBuffers(cmdBuffer);
 	    	cmdBuffer.bindIndexBuffer(curMainBuffer, offsets.indexOffset, vk::IndexType::eUint32);
 
 			// Tr depth-only pass
@@ -103,7 +103,16 @@ private:
 	void UploadMainBuffer(const OITDescriptorSets::VertexShaderUniforms& vertexUniforms,
 			const OITDescriptorSets::FragmentShaderUniforms& fragmentUniforms);
 
+	void BindMainVertexBuffers(const vk::CommandBuffer& cmdBuffer) const
+	{
+		// Empty optional streams point at the base vertices, which are never read
+		cmdBuffer.bindVertexBuffers(0, { curMainBuffer, curMainBuffer, curMainBuffer },
+				{ 0, offsets.twoVolumesOffset, offsets.normalOffset });
+	}
+
 	struct {
+		vk::DeviceSize twoVolumesOffset = 0;
+		vk::DeviceSize normalOffset = 0;
 		vk::DeviceSize indexOffset = 0;
 		vk::DeviceSize modVolOffset = 0;
 		vk::DeviceSize vertexUniformOffset = 0;
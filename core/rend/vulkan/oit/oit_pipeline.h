@@ -423,6 +423,8 @@ private:
 		static const vk::VertexInputBindingDescription vertexBindingDescriptions[] =
 		{
 				{ 0, sizeof(Vertex) },
+				{ 1, sizeof(VertexTwoVolumes) },
+				{ 2, sizeof(VertexNormal) },
 		};
 		static const vk::VertexInputAttributeDescription vertexInputAttributeDescriptions[] =
 		{
@@ -430,10 +432,10 @@ private:
 				vk::VertexInputAttributeDescription(1, 0, vk::Format::eR8G8B8A8Uint, offsetof(Vertex, col)),	// base color
 				vk::VertexInputAttributeDescription(2, 0, vk::Format::eR8G8B8A8Uint, offsetof(Vertex, spc)),	// offset color
 				vk::VertexInputAttributeDescription(3, 0, vk::Format::eR32G32Sfloat, offsetof(Vertex, u)),		// tex coord
-				vk::VertexInputAttributeDescription(4, 0, vk::Format::eR8G8B8A8Uint, offsetof(Vertex, col1)),	// base1 color
-				vk::VertexInputAttributeDescription(5, 0, vk::Format::eR8G8B8A8Uint, offsetof(Vertex, spc1)),	// offset1 color
-				vk::VertexInputAttributeDescription(6, 0, vk::Format::eR32G32Sfloat, offsetof(Vertex, u1)),		// tex1 coord
-				vk::VertexInputAttributeDescription(7, 0, vk::Format::eR32G32B32Sfloat, offsetof(Vertex, nx)),	// naomi2 normal
+				vk::VertexInputAttributeDescription(4, 1, vk::Format::eR8G8B8A8Uint, offsetof(VertexTwoVolumes, col1)),	// base1 color
+				vk::VertexInputAttributeDescription(5, 1, vk::Format::eR8G8B8A8Uint, offsetof(VertexTwoVolumes, spc1)),	// offset1 color
+				vk::VertexInputAttributeDescription(6, 1, vk::Format::eR32G32Sfloat, offsetof(VertexTwoVolumes, u1)),		// tex1 coord
+				vk::VertexInputAttributeDescription(7, 2, vk::Format::eR32G32B32Sfloat, offsetof(VertexNormal, nx)),	// naomi2 normal
 		};
 		static const vk::VertexInputAttributeDescription vertexInputLightAttributeDescriptions[] =
 		{
@@ -441,7 +443,7 @@ private:
 		};
 		return vk::PipelineVertexInputStateCreateInfo(
 				vk::PipelineVertexInputStateCreateFlags(),
-				std::size(vertexBindingDescriptions),
+				full ? std::size(vertexBindingDescriptions) : 1,
 				vertexBindingDescriptions,
 				full ? std::size(vertexInputAttributeDescriptions) : std::size(vertexInputLightAttributeDescriptions),
 				full ? vertexInputAttributeDescriptions : vertexInputLightAttributeDescriptions);
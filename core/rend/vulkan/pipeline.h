@@ -292,6 +292,7 @@ private:
 		static const vk::VertexInputBindingDescription vertexBindingDescriptions[] =
 		{
 				{ 0, sizeof(Vertex) },
+				{ 1, sizeof(VertexNormal) },
 		};
 		static const vk::VertexInputAttributeDescription vertexInputAttributeDescriptions[] =
 		{
@@ -299,7 +300,7 @@ private:
 				vk::VertexInputAttributeDescription(1, 0, vk::Format::eR8G8B8A8Uint, offsetof(Vertex, col)),	// base color
 				vk::VertexInputAttributeDescription(2, 0, vk::Format::eR8G8B8A8Uint, offsetof(Vertex, spc)),	// offset color
 				vk::VertexInputAttributeDescription(3, 0, vk::Format::eR32G32Sfloat, offsetof(Vertex, u)),		// tex coord
-				vk::VertexInputAttributeDescription(4, 0, vk::Format::eR32G32B32Sfloat, offsetof(Vertex, nx)),	// naomi2 normal
+				vk::VertexInputAttributeDescription(4, 1, vk::Format::eR32G32B32Sfloat, offsetof(VertexNormal, nx)),	// naomi2 normal
 		};
 		static const vk::VertexInputAttributeDescription vertexInputLightAttributeDescriptions[] =
 		{
@@ -307,7 +308,7 @@ private:
 		};
 		return vk::PipelineVertexInputStateCreateInfo(
 				vk::PipelineVertexInputStateCreateFlags(),
-				std::size(vertexBindingDescriptions),
+				full ? std::size(vertexBindingDescriptions) : 1,
 				vertexBindingDescriptions,
 				full ? std::size(vertexInputAttributeDescriptions) : std::size(vertexInputLightAttributeDescriptions),
 				full ? vertexInputAttributeDescriptions : vertexInputLightAttributeDescriptions);
@@ -52,6 +52,8 @@
 #include "oslib/storage.h"
 #include <stb_image_write.h>
 #include "hw/pvr/Renderer_if.h"
+#include "hw/pvr/elan.h"
+#include "rend/TexCache.h"
 #if defined(USE_SDL)
 #include "sdl/sdl.h"
 #endif
@@ -2248,6 +2250,11 @@ static void gui_settings_video()
     	OptionCheckbox("Full Framebuffer Emulation", config::EmulateFramebuffer,
     			"Fully accurate VRAM framebuffer emulation. Helps games that directly access the framebuffer for special effects. "
     			"Very slow and incompatible with upscaling and wide screen.");
+    	{
+    		DisabledScope scope(!config::EmulateFramebuffer);
+    		OptionCheckbox("Asynchronous Framebuffer Readback", config::AsyncFramebufferReadback,
+    				"Copy the framebuffer to VRAM while the next frame is rendered. Faster but one frame late. OpenGL only");
+    	}
     	OptionCheckbox("Load Custom Textures", config::CustomTextures,
     			"Load custom/high-res textures from data/textures/<game id>");
     }
@@ -2335,6 +2342,23 @@ static void gui_settings_video()
 
     	OptionArrowButtons("Frame Skipping", config::SkipFrame, 0, 6,
     			"Number of frames to skip between two actually rendered frames");
+    	{
+    		DisabledScope scope(!config::ThreadedRendering);
+    		ImGui::Text("Render Queue:");
+    		ImGui::Columns(3, "renderqueue", false);
+    		OptionRadioButton("Lowest Latency", config::RenderQueuePolicy, 0, "Wait for the previous frame to be rendered before queuing a new one");
+    		ImGui::NextColumn();
+    		OptionRadioButton("Max Throughput", config::RenderQueuePolicy, 1, "Always queue up to the maximum number of frames");
+    		ImGui::NextColumn();
+    		OptionRadioButton("Adaptive", config::RenderQueuePolicy, 2, "Queue more frames only when the GPU is running slow");
+    		ImGui::Columns(1, nullptr, false);
+    		OptionArrowButtons("Render Queue Depth", config::RenderQueueDepth, 1, MAX_RENDER_QUEUE_DEPTH,
+    				"Maximum number of frames queued for rendering. Higher values increase throughput but add input latency");
+    	}
+    	OptionCheckbox("Cache Display Lists", config::CacheTALists,
+    			"Reuse the geometry of display lists that are unchanged from previous frames");
+    	OptionCheckbox("Threaded Naomi 2 T&L", config::DeferredElan,
+    			"Process the Naomi 2 geometry on a separate thread. Disabled during netplay");
     	OptionCheckbox("Shadows", config::ModifierVolumes,
     			"Enable modifier volumes, usually used for shadows");
     	OptionCheckbox("Fog", config::Fog, "Enable fog effects");
@@ -2723,6 +2747,27 @@ static void gui_settings_advanced()
 		OptionRadioButton("Interpreter", config::DynarecEnabled, false,
 			"Use the interpreter. Very slow but may help in case of a dynarec problem");
 		ImGui::Columns(1, NULL, false);
+		{
+			DisabledScope scope(config::DynarecEnabled);
+			OptionCheckbox("Cache Decoded Instructions", config::CachedInterpreter,
+					"Decode the SH4 code once and keep it for later runs. Makes the interpreter faster");
+		}
+#if FEAT_SHREC != DYNAREC_NONE
+		{
+			DisabledScope scope(!config::DynarecEnabled);
+			OptionCheckbox("Pin Hot Registers", config::DynarecPinRegisters,
+					"Keep the most used SH4 registers in host registers between blocks. Only supported on x86-64");
+			OptionSlider("Code Cache Size", config::DynarecCodeCacheSize, 4, 32,
+					"Size of the memory holding the recompiled code. The oldest code is discarded when it's full. "
+					"Applied on the next reset", "%d MB");
+			OptionCheckbox("Fast Vector Math", config::DynarecFastVectorOps,
+					"Compute the FIPR and FTRV instructions in single precision. Faster but less accurate. "
+					"Ignored with netplay. Only supported on x86-64 and arm64");
+		}
+#endif
+		OptionCheckbox("Accurate SH4 Cache", config::DynarecAccurateCache,
+				"Emulate the SH4 operand cache when a game uses it as RAM or changes its index mode. "
+				"Slower. Only supported by the interpreter and the x86-64 and arm64 dynarecs");
 
 		OptionSlider("SH4 Clock", config::Sh4Clock, 100, 300,
 				"Over/Underclock the main SH4 CPU. Default is 200 MHz. Other values may crash, freeze or trigger unexpected nuclear reactions.",
@@ -2743,6 +2788,16 @@ static void gui_settings_advanced()
 			OptionCheckbox("Dreamcast 32MB RAM Mod", config::RamMod32MB,
 				"Enables 32MB RAM Mod for Dreamcast. May affect compatibility");
 		}
+#if defined(__linux__) && !defined(__ANDROID__)
+		{
+			DisabledScope scope(game_started);
+			OptionCheckbox("Use Huge Pages", config::HugePages,
+				"Back the emulated memory and the dynarec code cache with transparent huge pages. "
+				"Reduces TLB misses. Needs /sys/kernel/mm/transparent_hugepage/shmem_enabled set to advise");
+			OptionCheckbox("Prefault Memory", config::PrefaultMemory,
+				"Fault in all the emulated memory mappings when a game starts instead of on first access");
+		}
+#endif
         OptionCheckbox("Dump Textures", config::DumpTextures,
         		"Dump all textures into data/texdump/<game id>");
 
@@ -3517,6 +3572,15 @@ void gui_display_ui()
 static u64 LastFPSTime;
 static int lastFrameCount = 0;
 static float fps = -1;
+static RenderQueueStats queueStats;
+static float queueWait;
+static int queueDropped;
+static TAContextStats ctxStats;
+static int ctxGrowths;
+static elan::DeferredStats elanStats;
+static float elanOverlap;
+static FramebufferStats fbStats;
+static float fbTime;
 
 static std::string getFPSNotification()
 {
@@ -3525,12 +3589,42 @@ static std::string getFPSNotification()
 		u64 now = getTimeMs();
 		if (now - LastFPSTime >= 1000) {
 			fps = ((float)MainFrameCount - lastFrameCount) * 1000.f / (now - LastFPSTime);
+			// render queue: emulator wait time in ms per second and frames dropped over the last period
+			RenderQueueStats stats = getRenderQueueStats();
+			queueWait = (float)(stats.waitTime - queueStats.waitTime) / (now - LastFPSTime);
+			queueDropped = stats.droppedFrames - queueStats.droppedFrames;
+			queueStats = stats;
+			// TA contexts: frames that outgrew their buffers over the last period
+			TAContextStats cstats = getTAContextStats();
+			ctxGrowths = cstats.growths - ctxStats.growths;
+			ctxStats = cstats;
+			// deferred ELAN processing: worker time not spent waiting by the emulator, in ms per frame
+			elan::DeferredStats estats = elan::getDeferredStats();
+			const int frames = MainFrameCount - lastFrameCount;
+			if (frames > 0)
+				elanOverlap = (float)((s64)(estats.busyTime - elanStats.busyTime) - (s64)(estats.waitTime - elanStats.waitTime))
+						/ 1000.f / frames;
+			elanStats = estats;
+			// framebuffer and render to texture conversions in ms per frame
+			FramebufferStats fstats = getFramebufferStats();
+			if (frames > 0)
+				fbTime = (float)((fstats.readTime - fbStats.readTime) + (fstats.writeTime - fbStats.writeTime)) / 1000.f / frames;
+			fbStats = fstats;
 			LastFPSTime = now;
 			lastFrameCount = MainFrameCount;
 		}
 		if (fps >= 0.f && fps < 9999.f) {
-			char text[32];
-			snprintf(text, sizeof(text), "F:%4.1f%s", fps, settings.input.fastForwardMode ? " >>" : "");
+			char text[128];
+			int len = snprintf(text, sizeof(text), "F:%4.1f", fps);
+			if (config::ThreadedRendering)
+				len += snprintf(text + len, sizeof(text) - len, " Q:%d/%d W:%.1fms D:%d C:%u/%.0fMB G:%d",
+						queueStats.depth, queueStats.maxDepth, queueWait, queueDropped,
+						ctxStats.contexts, ctxStats.memory / 1024.0 / 1024.0, ctxGrowths);
+			if (config::DeferredElan && settings.platform.isNaomi2())
+				len += snprintf(text + len, sizeof(text) - len, " E:%.1fms", std::max(elanOverlap, 0.f));
+			if (config::EmulateFramebuffer || config::RenderToTextureBuffer)
+				len += snprintf(text + len, sizeof(text) - len, " FB:%.2fms", fbTime);
+			snprintf(text + len, sizeof(text) - len, "%s", settings.input.fastForwardMode ? " >>" : "");
 
 			return std::string(text);
 		}
@@ -3611,6 +3705,7 @@ void gui_display_profiler()
 			fc_profiler::drawGUI(profileThread->cachedResultTree);
 			ImGui::Unindent();
 		}
+		fc_profiler::drawCounters();
 	}
 	
 	for (const fc_profiler::ProfileThread* profileThread : fc_profiler::ProfileThread::s_allThreads)
@@ -97,6 +97,10 @@ void destroy() {
 	CloseHandle(mem_handle);
 }
 
+// Large pages can't be used for file mappings and their pages are committed when mapped
+void set_hints(bool hugePages, bool prefault) {
+}
+
 // Resets a chunk of memory by deleting its data and setting its protection back.
 void reset_mem(void *ptr, unsigned size_bytes) {
 	VirtualFree(ptr, size_bytes, MEM_DECOMMIT);
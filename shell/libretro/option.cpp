@@ -24,6 +24,11 @@ namespace config {
 // Dynarec
 
 Option<bool> DynarecEnabled("", true);
+Option<bool> CachedInterpreter("", false);
+Option<bool> DynarecPinRegisters("", false);
+Option<bool> DynarecAccurateCache("", false);
+Option<int> DynarecCodeCacheSize("", 16);
+Option<bool> DynarecFastVectorOps("", false);
 IntOption Sh4Clock(CORE_OPTION_NAME "_sh4clock", 200);
 
 // General
@@ -92,6 +97,11 @@ IntOption PerPixelLayers(CORE_OPTION_NAME "_oit_layers");
 Option<bool> NativeDepthInterpolation(CORE_OPTION_NAME "_native_depth_interpolation");
 Option<bool> EmulateFramebuffer(CORE_OPTION_NAME "_emulate_framebuffer", false);
 Option<bool> FixUpscaleBleedingEdge(CORE_OPTION_NAME "_fix_upscale_bleeding_edge", true);
+Option<int> RenderQueueDepth("", 2);
+Option<int> RenderQueuePolicy("", 0);
+Option<bool> CacheTALists("", true);
+Option<bool> DeferredElan("", false);
+Option<bool> AsyncFramebufferReadback("", false);
 
 // Misc
 
@@ -102,6 +112,8 @@ Option<bool> UseReios(CORE_OPTION_NAME "_hle_bios");
 Option<bool> OpenGlChecks("", false);
 Option<bool> FastGDRomLoad(CORE_OPTION_NAME "_gdrom_fast_loading", false);
 Option<bool> RamMod32MB(CORE_OPTION_NAME "_dc_32mb_mod", false);
+Option<bool, false> HugePages("", false);
+Option<bool, false> PrefaultMemory("", false);
 
 //Option<std::vector<std::string>, false> ContentPath("");
 //Option<bool, false> HideLegacyNaomiRoms("", true);
@@ -141,6 +141,11 @@ void destroy()
 	NOTICE_LOG(VMEM, "virtmem::destroy done");
 }
 
+// Code memory is mapped eagerly with regular pages
+void set_hints(bool hugePages, bool prefault)
+{
+}
+
 // Flush (unmap) the FPCB array
 void reset_mem(void *ptr, unsigned size)
 {
@@ -0,0 +1,144 @@
+#include "gtest/gtest.h"
+#include "types.h"
+#include "emulator.h"
+#include "hw/mem/addrspace.h"
+#include "hw/sh4/sh4_mem.h"
+
+#include <chrono>
+#include <cstdio>
+#include <random>
+
+class AddrspaceTest : public ::testing::Test
+{
+protected:
+	void SetUp() override
+	{
+		if (!addrspace::reserve())
+			die("addrspace::reserve failed");
+		emu.init();
+		mem_map_default();
+		dc_reset(true);
+	}
+
+	std::vector<u8> randomBytes(u32 size)
+	{
+		std::vector<u8> bytes(size);
+		for (u8& b : bytes)
+			b = (u8)gen();
+		return bytes;
+	}
+
+	// Reads the area one word at a time
+	std::vector<u8> readWords(u32 addr, u32 size)
+	{
+		std::vector<u8> bytes(size);
+		for (u32 i = 0; i < size; i += 4)
+		{
+			const u32 v = addrspace::read32(addr + i);
+			memcpy(&bytes[i], &v, 4);
+		}
+		return bytes;
+	}
+
+	std::mt19937 gen { 4242 };
+};
+
+TEST_F(AddrspaceTest, Resolve)
+{
+	// System ram wraps around at its end
+	addrspace::Span span = addrspace::resolve(0x0C000000 + RAM_SIZE - 0x100, 0x200);
+	ASSERT_NE(nullptr, span.ptr);
+	ASSERT_EQ(0x100u, span.size);
+	span = addrspace::resolve(0x0C000000 + RAM_SIZE, 0x100);
+	ASSERT_EQ(&mem_b[0], span.ptr);
+	ASSERT_EQ(0x100u, span.size);
+
+	// 32-bit vram is a handler run that ends at the next 64-bit mirror
+	span = addrspace::resolve(0x05000000, 0x2000000);
+	ASSERT_EQ(nullptr, span.ptr);
+	ASSERT_EQ(0x1000000u, span.size);
+}
+
+TEST_F(AddrspaceTest, MatchesWordAccess)
+{
+	const struct {
+		const char *name;
+		u32 addr;
+	} areas[] {
+		{ "ram wrap", 0x0C000000 + RAM_SIZE - 0x400 },
+		{ "vram 64-bit wrap", 0x04000000 + VRAM_SIZE - 0x400 },
+		{ "vram 32-bit", 0x05000000 + VRAM_SIZE / 2 - 0x400 },
+	};
+	constexpr u32 Size = 0x800;
+	for (const auto& area : areas)
+	{
+		const std::vector<u8> data = randomBytes(Size);
+		addrspace::writeBlock(area.addr, data.data(), Size);
+		ASSERT_EQ(data, readWords(area.addr, Size)) << area.name;
+
+		std::vector<u8> readBack(Size);
+		addrspace::readBlock(area.addr, readBack.data(), Size);
+		ASSERT_EQ(data, readBack) << area.name;
+
+		// 16-bit tail (8-bit vram writes are ignored)
+		std::vector<u8> tail = randomBytes(6);
+		addrspace::writeBlock(area.addr, tail.data(), tail.size());
+		std::vector<u8> bytes = readWords(area.addr, 8);
+		ASSERT_EQ(0, memcmp(tail.data(), bytes.data(), tail.size())) << area.name;
+		ASSERT_EQ(data[6], bytes[6]) << area.name;
+		ASSERT_EQ(data[7], bytes[7]) << area.name;
+	}
+}
+
+TEST_F(AddrspaceTest, CopyBlock)
+{
+	constexpr u32 Size = 0x1000;
+	constexpr u32 RamAddr = 0x0C100000;
+	constexpr u32 Vram32Addr = 0x05100000;
+	constexpr u32 Vram64Addr = 0x04600000;
+	const std::vector<u8> data = randomBytes(Size);
+	addrspace::writeBlock(RamAddr, data.data(), Size);
+
+	// ram to handler
+	addrspace::copyBlock(Vram32Addr, RamAddr, Size);
+	ASSERT_EQ(data, readWords(Vram32Addr, Size));
+	// handler to memory
+	addrspace::copyBlock(Vram64Addr, Vram32Addr, Size);
+	ASSERT_EQ(data, readWords(Vram64Addr, Size));
+	// handler to handler
+	addrspace::copyBlock(Vram32Addr + Size, Vram32Addr, Size);
+	ASSERT_EQ(data, readWords(Vram32Addr + Size, Size));
+	// memory to memory, across the end of ram
+	const u32 wrapAddr = 0x0C000000 + RAM_SIZE - Size / 2;
+	WriteMemBlock_nommu_dma(wrapAddr, Vram64Addr, Size);
+	ASSERT_EQ(data, readWords(wrapAddr, Size));
+	ASSERT_EQ(0, memcmp(&data[Size / 2], &mem_b[0], Size / 2));
+}
+
+// Compares the speed of block transfers and of the equivalent word accesses.
+// Run with --gtest_also_run_disabled_tests
+TEST_F(AddrspaceTest, DISABLED_Throughput)
+{
+	constexpr u32 Size = 1024 * 1024;
+	constexpr int Iterations = 20;
+	const std::vector<u8> data = randomBytes(Size);
+	using the_clock = std::chrono::steady_clock;
+
+	for (u32 addr : { 0x0C100000u, 0x05100000u })
+	{
+		auto start = the_clock::now();
+		for (int i = 0; i < Iterations; i++)
+			for (u32 j = 0; j < Size; j += 4)
+				addrspace::write32(addr + j, *(const u32 *)&data[j]);
+		const double wordTime = std::chrono::duration<double>(the_clock::now() - start).count();
+
+		start = the_clock::now();
+		for (int i = 0; i < Iterations; i++)
+			addrspace::writeBlock(addr, data.data(), Size);
+		const double blockTime = std::chrono::duration<double>(the_clock::now() - start).count();
+		ASSERT_EQ(data, readWords(addr, Size));
+
+		const double megabytes = (double)Size * Iterations / 1024.0 / 1024.0;
+		printf("%08x: word writes %.0f MB/s, block write %.0f MB/s\n", addr, megabytes / wordTime, megabytes / blockTime);
+	}
+}
@@ -0,0 +1,109 @@
+#include "gtest/gtest.h"
+#include "types.h"
+#include "hw/naomi/awcartridge.h"
+#include "hw/naomi/m4cartridge.h"
+#include "hw/naomi/gdcartridge.h"
+
+#include <memory>
+#include <random>
+
+class CartDecryptTest : public ::testing::Test
+{
+protected:
+	static void fillRandom(u8 *p, u32 size, u32 seed)
+	{
+		std::mt19937 gen(seed);
+		for (u32 i = 0; i < size; i++)
+			p[i] = (u8)gen();
+	}
+};
+
+TEST_F(CartDecryptTest, AtomiswaveAllKeys)
+{
+	constexpr u32 RomSize = 0x20000;
+	std::unique_ptr<AWCartridge> cart = std::make_unique<AWCartridge>(RomSize);
+	u32 size = RomSize;
+	u16 *rom = (u16 *)cart->GetPtr(0, size);
+	ASSERT_EQ(RomSize, size);
+	fillRandom((u8 *)rom, RomSize, 42);
+
+	std::vector<u16> decrypted(RomSize / 2 + 100);
+	for (u32 key = 0; key < 256; key++)
+	{
+		cart->SetKey(key);
+		// include a wrap-around past the end of the rom
+		cart->decrypt(decrypted.data(), 0, decrypted.size());
+		for (u32 i = 0; i < decrypted.size(); i++)
+			ASSERT_EQ(AWCartridge::decrypt(rom[i % (RomSize / 2)], i, key), decrypted[i]) << "key " << key << " word " << i;
+	}
+}
+
+class M4TestCartridge : public M4Cartridge
+{
+public:
+	M4TestCartridge(u32 size) : M4Cartridge(size) {}
+	using M4Cartridge::decrypt;
+	using M4Cartridge::enc_reset;
+};
+
+TEST_F(CartDecryptTest, M4Bulk)
+{
+	constexpr u32 DataSize = 0x10000;
+	std::vector<u8> cipherText(DataSize);
+	fillRandom(cipherText.data(), DataSize, 1234);
+
+	for (u32 seed = 0; seed < 8; seed++)
+	{
+		M4TestCartridge cart(2);
+		u8 *keyData = (u8 *)malloc(2048);	// freed by the cartridge
+		fillRandom(keyData, 2048, seed);
+		cart.SetKey(0x5504 + seed);
+		cart.SetKeyData(keyData);
+		cart.Init();
+
+		std::vector<u16> reference(DataSize / 2);
+		cart.enc_reset();
+		for (u32 i = 0; i < DataSize; i += 2)
+			reference[i / 2] = cart.decrypt((u16)(cipherText[i] | (cipherText[i + 1] << 8)));
+
+		std::vector<u8> decrypted(DataSize);
+		cart.enc_reset();
+		// odd number of words to check that the cipher state is carried over
+		cart.decrypt(&cipherText[0], &decrypted[0], 22);
+		cart.decrypt(&cipherText[22], &decrypted[22], DataSize - 22);
+		for (u32 i = 0; i < DataSize; i += 2)
+			ASSERT_EQ(reference[i / 2], decrypted[i] | (decrypted[i + 1] << 8)) << "seed " << seed << " offset " << i;
+	}
+}
+
+class GDTestCartridge : public GDCartridge
+{
+public:
+	GDTestCartridge() : GDCartridge(2) {}
+	using GDCartridge::des_decrypt;
+	using GDCartridge::rev64;
+};
+
+TEST_F(CartDecryptTest, DesKnownAnswer)
+{
+	GDTestCartridge cart;
+	u64 data = 0x85E813540F0AB405ull;
+	cart.des_decrypt((u8 *)&data, sizeof(data), GDTestCartridge::rev64(0x133457799BBCDFF1ull));
+	ASSERT_EQ(0x0123456789ABCDEFull, data);
+}
+
+TEST_F(CartDecryptTest, DesMultiThreaded)
+{
+	constexpr u32 DataSize = 0x500008;	// not a multiple of the chunk size
+	const u64 key = 0x0123456789abcdefull;
+	std::vector<u8> data(DataSize);
+	fillRandom(data.data(), DataSize, 5678);
+	std::vector<u8> reference = data;
+
+	GDTestCartridge cart;
+	cart.des_decrypt(data.data(), DataSize, key);
+	// one block at a time, on the calling thread
+	for (u32 i = 0; i < DataSize; i += 8)
+		cart.des_decrypt(&reference[i], 8, key);
+	ASSERT_EQ(reference, data);
+}
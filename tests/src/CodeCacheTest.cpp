@@ -0,0 +1,82 @@
+#include "sh4_cpu_test.h"
+#include "hw/sh4/sh4_core.h"
+#include "hw/sh4/dyna/ngen.h"
+#include "cfg/option.h"
+
+#if FEAT_SHREC != DYNAREC_NONE
+
+class CodeCacheTest : public Sh4CpuTest
+{
+protected:
+	// Number of one-instruction blocks in the program
+	static constexpr u32 Blocks = 0x10000;
+	static constexpr u32 Passes = 2;
+
+	void SetUp() override
+	{
+		Sh4CpuTest::SetUp();
+		savedCodeCacheSize = config::DynarecCodeCacheSize;
+	}
+
+	void TearDown() override
+	{
+		Sh4CpuTest::TearDown();
+		config::DynarecCodeCacheSize = savedCodeCacheSize;
+	}
+
+	// Runs a long chain of small blocks several times so that the code doesn't fit in the cache
+	void loadProgram()
+	{
+		u32 addr = ProgramAddress;
+		auto emit = [&addr](u16 op) {
+			addrspace::write16(addr, op);
+			addr += 2;
+		};
+		emit(0xE000);			// mov #0, r0
+		emit(0xE100 | Passes);	// mov #passes, r1
+		// loop:
+		const u32 loopAddress = addr;
+		for (u32 i = 0; i < Blocks; i++)
+		{
+			emit(0x7001);		// add #1, r0
+			emit(0xA000);		// bra next
+			emit(0x0009);		// nop
+		}
+		emit(0x4110);			// dt r1
+		emit(0x8903);			// bt end
+		emit(0xD202);			// mov.l @(loop_addr), r2
+		emit(0x422B);			// jmp @r2
+		emit(0x0009);			// nop
+		emit(0x0009);
+		// end:
+		emit(0xAFFE);			// bra end
+		emit(0x0009);			// nop
+		// loop_addr: must be 4-byte aligned
+		ASSERT_EQ(0u, addr & 2) << std::hex << addr;
+		addrspace::write32(addr, loopAddress);
+	}
+
+	int savedCodeCacheSize = 0;
+};
+
+TEST_F(CodeCacheTest, Eviction)
+{
+	loadProgram();
+	run(Get_Sh4Interpreter, 20'000'000);
+	ASSERT_EQ(Blocks * Passes, r[0]);
+	ASSERT_EQ(0u, r[1]);
+
+	config::DynarecCodeCacheSize = 4;
+	r[0] = r[1] = 0;
+	run(Get_Sh4Recompiler, 20'000'000);
+	ASSERT_EQ(Blocks * Passes, r[0]);
+	ASSERT_EQ(0u, r[1]);
+
+	const CodeCacheStats& stats = rdv_CodeCacheStats();
+	// The cache is only cleared by the reset
+	ASSERT_EQ(1u, stats.flushes);
+	ASSERT_NE(0u, stats.evictions);
+	ASSERT_LT(Blocks, stats.compiledBlocks);
+}
+
+#endif
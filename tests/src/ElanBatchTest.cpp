@@ -0,0 +1,93 @@
+#include "gtest/gtest.h"
+#include "types.h"
+#include "hw/pvr/elan_batch.h"
+
+#include <random>
+
+class ElanBatchTest : public ::testing::Test
+{
+protected:
+	struct Position
+	{
+		float x, y, z;
+	};
+
+	// Scalar reference implementation
+	static void boundingBox(const std::vector<Position>& vertices, glm::vec3& min, glm::vec3& max)
+	{
+		min = { 1e38f, 1e38f, 1e38f };
+		max = { -1e38f, -1e38f, -1e38f };
+		for (const Position& v : vertices)
+		{
+			glm::vec3 pos{ v.x, v.y, v.z };
+			min = glm::min(min, pos);
+			max = glm::max(max, pos);
+		}
+	}
+
+	static float nearDistance(const Position& v, const glm::mat4& mat, float nearPlane)
+	{
+		float z = v.x * mat[0][2] + v.y * mat[1][2] + v.z * mat[2][2] + mat[3][2];
+		return -z - nearPlane;
+	}
+
+	std::vector<Position> randomVertices(u32 count, bool withNaN)
+	{
+		std::uniform_real_distribution<float> dist(-1000.f, 1000.f);
+		std::vector<Position> vertices(count);
+		for (Position& v : vertices)
+		{
+			v = { dist(gen), dist(gen), dist(gen) };
+			if (withNaN && gen() % 8 == 0)
+				v.y = std::numeric_limits<float>::quiet_NaN();
+		}
+		return vertices;
+	}
+
+	glm::mat4 randomMatrix()
+	{
+		std::uniform_real_distribution<float> dist(-2.f, 2.f);
+		glm::mat4 mat;
+		for (int i = 0; i < 4; i++)
+			for (int j = 0; j < 4; j++)
+				mat[i][j] = dist(gen);
+		return mat;
+	}
+
+	std::mt19937 gen { 24680 };
+	elan::VertexBatch batch;
+};
+
+TEST_F(ElanBatchTest, BoundingBox)
+{
+	// All counts modulo 4, and a smaller list after a bigger one
+	for (u32 count : { 1, 2, 3, 4, 5, 6, 7, 8, 100, 13, 0 })
+	{
+		for (bool withNaN : { false, true })
+		{
+			std::vector<Position> vertices = randomVertices(count, withNaN);
+			batch.gather(vertices.data(), count);
+			ASSERT_EQ(count, batch.size());
+			glm::vec3 min, max;
+			batch.boundingBox(min, max);
+			glm::vec3 refMin, refMax;
+			boundingBox(vertices, refMin, refMax);
+			ASSERT_EQ(refMin, min) << "count " << count;
+			ASSERT_EQ(refMax, max) << "count " << count;
+		}
+	}
+}
+
+TEST_F(ElanBatchTest, NearDistances)
+{
+	for (u32 count : { 1, 3, 4, 6, 64, 17 })
+	{
+		std::vector<Position> vertices = randomVertices(count, false);
+		glm::mat4 mat = randomMatrix();
+		constexpr float nearPlane = 0.01f;
+		batch.gather(vertices.data(), count);
+		batch.computeNearDistances(mat, nearPlane);
+		for (u32 i = 0; i < count; i++)
+			ASSERT_FLOAT_EQ(nearDistance(vertices[i], mat, nearPlane), batch.nearDistance(i)) << "count " << count << " vertex " << i;
+	}
+}
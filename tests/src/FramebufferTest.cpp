@@ -0,0 +1,187 @@
+#include "gtest/gtest.h"
+#include "types.h"
+#include "hw/mem/addrspace.h"
+#include "emulator.h"
+#include "hw/pvr/pvr_mem.h"
+#include "hw/pvr/Renderer_if.h"
+#include "rend/TexCache.h"
+#include "cfg/option.h"
+
+#include <random>
+
+class FramebufferTest : public ::testing::Test
+{
+protected:
+	void SetUp() override
+	{
+		if (!addrspace::reserve())
+			die("addrspace::reserve failed");
+		emu.init();
+		dc_reset(true);
+		savedEmulateFramebuffer = config::EmulateFramebuffer;
+	}
+
+	void TearDown() override
+	{
+		config::EmulateFramebuffer = savedEmulateFramebuffer;
+	}
+
+	std::vector<u8> randomPixels(u32 count)
+	{
+		std::vector<u8> pixels(count * 4);
+		for (u8& b : pixels)
+			b = (u8)gen();
+		return pixels;
+	}
+
+	// Scalar reference conversion of an RGBA pixel
+	static u32 convert(const u8 *p, FB_W_CTRL_type ctrl, bool round)
+	{
+		auto reduce = [round](u8 c, int bits) -> u32 {
+			u32 v = c >> (8 - bits);
+			if (round && v != (1u << bits) - 1)
+				v += (c >> (7 - bits)) & 1;
+			return v;
+		};
+		switch (ctrl.fb_packmode)
+		{
+		case 0:
+			return (reduce(p[0], 5) << 10) | (reduce(p[1], 5) << 5) | reduce(p[2], 5) | ((ctrl.fb_kval & 0x80) << 8);
+		case 1:
+			return (reduce(p[0], 5) << 11) | (reduce(p[1], 6) << 5) | reduce(p[2], 5);
+		case 2:
+			return (reduce(p[0], 4) << 8) | (reduce(p[1], 4) << 4) | reduce(p[2], 4) | (reduce(p[3], 4) << 12);
+		case 3:
+			return (reduce(p[0], 5) << 10) | (reduce(p[1], 5) << 5) | reduce(p[2], 5)
+					| (p[3] >= ctrl.fb_alpha_threshold ? 0x8000 : 0);
+		case 5:
+			return (p[0] << 16) | (p[1] << 8) | p[2] | (ctrl.fb_kval << 24);
+		case 6:
+			return (p[0] << 16) | (p[1] << 8) | p[2] | (p[3] << 24);
+		default:
+			return 0;
+		}
+	}
+
+	std::mt19937 gen { 8642 };
+	bool savedEmulateFramebuffer = false;
+};
+
+TEST_F(FramebufferTest, TextureToVRam)
+{
+	constexpr u32 Width = 45;
+	constexpr u32 Height = 3;
+	constexpr u32 LineStride = Width * 2 + 6;
+	config::EmulateFramebuffer = true;
+	const std::vector<u8> pixels = randomPixels(Width * Height);
+
+	for (u32 packmode = 0; packmode < 4; packmode++)
+	{
+		for (bool dither : { false, true })
+		{
+			FB_W_CTRL_type ctrl{};
+			ctrl.fb_packmode = packmode;
+			ctrl.fb_dither = dither;
+			ctrl.fb_kval = 0x80;
+			ctrl.fb_alpha_threshold = 0x40;
+			std::vector<u16> tex(LineStride / 2 * Height);
+			WriteTextureToVRam(Width, Height, pixels.data(), tex.data(), ctrl, LineStride);
+
+			for (u32 y = 0; y < Height; y++)
+				for (u32 x = 0; x < Width; x++)
+					ASSERT_EQ(convert(&pixels[(y * Width + x) * 4], ctrl, !dither), tex[y * LineStride / 2 + x])
+						<< "packmode " << packmode << " dither " << dither << " x " << x << " y " << y;
+		}
+	}
+}
+
+TEST_F(FramebufferTest, WriteFramebuffer)
+{
+	constexpr u32 Width = 50;
+	constexpr u32 Height = 6;
+	// Lines cross the vram bank boundary
+	constexpr u32 Address = 0x400000 - Width * 4 * 3 - 6;
+	const std::vector<u8> pixels = randomPixels(Width * Height);
+	FB_X_CLIP_type xclip{};
+	xclip.min = 3;
+	xclip.max = 44;
+	FB_Y_CLIP_type yclip{};
+	yclip.min = 1;
+	yclip.max = 4;
+
+	for (u32 packmode : { 0, 1, 2, 3, 5, 6 })
+	{
+		const u32 bpp = packmode >= 5 ? 4 : 2;
+		for (u32 addr = Address; addr < Address + Width * Height * bpp; addr += 2)
+			pvr_write32p<u16>(addr, 0x5555);
+		FB_W_CTRL_type ctrl{};
+		ctrl.fb_packmode = packmode;
+		ctrl.fb_kval = 0xc0;
+		ctrl.fb_alpha_threshold = 0x80;
+		WriteFramebuffer(Width, Height, pixels.data(), Address, ctrl, 0, xclip, yclip);
+
+		for (u32 y = 0; y < Height; y++)
+			for (u32 x = 0; x < Width; x++)
+			{
+				const u32 addr = Address + (y * Width + x) * bpp;
+				u32 value = pvr_read32p<u16>(addr);
+				if (bpp == 4)
+					value |= pvr_read32p<u16>(addr + 2) << 16;
+				const bool clipped = x < xclip.min || x > xclip.max || y < yclip.min || y > yclip.max;
+				const u32 reference = clipped ? (bpp == 4 ? 0x55555555 : 0x5555) : convert(&pixels[(y * Width + x) * 4], ctrl, false);
+				ASSERT_EQ(reference, value) << "packmode " << packmode << " x " << x << " y " << y;
+			}
+	}
+}
+
+TEST_F(FramebufferTest, ReadFramebuffer)
+{
+	constexpr u32 Address = 0x400000 - 0x400;
+	for (u32 addr = Address; addr < Address + 0x1000; addr += 2)
+		pvr_write32p<u16>(addr, (u16)gen());
+
+	FramebufferInfo info{};
+	info.fb_r_sof1 = Address;
+	info.fb_r_size.fb_x_size = 18;		// 38 16-bit words per line
+	info.fb_r_size.fb_y_size = 4;
+	info.fb_r_size.fb_modulus = 5;		// 8 words between lines
+	info.fb_r_ctrl.fb_concat = 5;
+
+	for (u32 depth : { fbde_0555, fbde_565, fbde_C888 })
+	{
+		info.fb_r_ctrl.fb_depth = depth;
+		PixelBuffer<u32> pb;
+		int width, height;
+		ReadFramebuffer(info, pb, width, height);
+
+		const u32 bpp = depth == fbde_C888 ? 4 : 2;
+		ASSERT_EQ(38 * 2 / bpp, (u32)width);
+		ASSERT_EQ(5, height);
+		const u32 concat = info.fb_r_ctrl.fb_concat;
+		u32 addr = Address;
+		for (int y = 0; y < height; y++)
+		{
+			for (int x = 0; x < width; x++, addr += bpp)
+			{
+				u32 reference;
+				if (depth == fbde_C888)
+				{
+					const u32 src = pvr_read32p<u32>(addr);
+					reference = RGBAPacker::pack(src >> 16, src >> 8, src, 0xff);
+				}
+				else
+				{
+					const u16 src = pvr_read32p<u16>(addr);
+					if (depth == fbde_0555)
+						reference = RGBAPacker::pack((((src >> 10) & 0x1F) << 3) | concat, (((src >> 5) & 0x1F) << 3) | concat,
+								((src & 0x1F) << 3) | concat, 0xff);
+					else
+						reference = RGBAPacker::pack((((src >> 11) & 0x1F) << 3) | concat, (((src >> 5) & 0x3F) << 2) | (concat & 3),
+								((src & 0x1F) << 3) | concat, 0xff);
+				}
+				ASSERT_EQ(reference, pb.data()[y * width + x]) << "depth " << depth << " x " << x << " y " << y;
+			}
+			addr += 16;
+		}
+	}
+}
@@ -22,6 +22,13 @@
 #include "emulator.h"
 #include "hw/sh4/modules/mmu.h"
 #include "hw/sh4/sh4_core.h"
+#include "hw/sh4/sh4_if.h"
+#include "hw/sh4/sh4_mem.h"
+#include "hw/sh4/sh4_sched.h"
+#include "sh4_cpu_test.h"
+
+#include <chrono>
+#include <cstdio>
 
 class MmuTest : public ::testing::Test {
 protected:
@@ -233,3 +240,102 @@ TEST_F(MmuTest, TestErrors)
 	ASSERT_EQ(MmuError::FIRSTWRITE, err);
 #endif
 }
+
+#if FEAT_SHREC != DYNAREC_NONE
+
+// Runs a loop doing stack accesses through a translated page
+class MmuCpuTest : public Sh4CpuTest
+{
+protected:
+	static constexpr u32 StackPage = 0x02000000;
+	static constexpr u32 LoopInstructions = 9;
+
+	void TearDown() override
+	{
+		Sh4CpuTest::TearDown();
+		CCN_MMUCR.AT = 0;
+		mmu_set_state();
+	}
+
+	// Runs the program for the given number of cycles and returns the elapsed time
+	double run(void (*getCpu)(sh4_if *), u32 iterations, int cycles)
+	{
+		static const u16 program[] {
+			0xD106,		// mov.l @(iterations), r1
+			0xDF07,		// mov.l @(stack), r15
+			0xE000,		// mov #0, r0
+			// loop:
+			0x2F16,		// mov.l r1, @-r15
+			0x2F06,		// mov.l r0, @-r15
+			0x52F1,		// mov.l @(4, r15), r2
+			0x302C,		// add r2, r0
+			0x63F6,		// mov.l @r15+, r3
+			0x64F6,		// mov.l @r15+, r4
+			0x353C,		// add r3, r5
+			0x4110,		// dt r1
+			0x8BF6,		// bf loop
+			// end:
+			0xAFFE,		// bra end
+			0x0009,		// nop
+		};
+		resetCpu(getCpu);
+		// Full mmu emulation is normally only enabled for Windows CE
+		CCN_MMUCR.AT = 1;
+		mmuOn = true;
+		MMU_reset();
+		UTLB[0].Address.VPN = StackPage >> 10;
+		UTLB[0].Data.SZ0 = 1;
+		UTLB[0].Data.V = 1;
+		UTLB[0].Data.PR = 3;
+		UTLB[0].Data.D = 1;
+		UTLB[0].Data.PPN = 0x0C030000 >> 10;
+		UTLB_Sync(0);
+
+		for (u32 i = 0; i < std::size(program); i++)
+			addrspace::write16(ProgramAddress + i * 2, program[i]);
+		addrspace::write32(ProgramAddress + sizeof(program), iterations);
+		addrspace::write32(ProgramAddress + sizeof(program) + 4, StackPage + 0x800);
+		auto start = std::chrono::steady_clock::now();
+		runCpu(cycles);
+		return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+	}
+};
+
+TEST_F(MmuCpuTest, DynarecMatchesInterpreter)
+{
+	constexpr u32 Iterations = 1000;
+	run(Get_Sh4Interpreter, Iterations, 10'000'000);
+	const std::vector<u32> reference(&r[0], &r[16]);
+	ASSERT_EQ(0u, reference[1]);
+	ASSERT_EQ(Iterations * (Iterations + 1) / 2, reference[0]);
+	ASSERT_EQ(StackPage + 0x800, reference[15]);
+
+	run(Get_Sh4Recompiler, Iterations, 10'000'000);
+	for (int i = 0; i < 16; i++)
+		ASSERT_EQ(reference[i], r[i]) << "r" << i;
+	ASSERT_EQ(1u, addrspace::read32(0x8C030800 - 4));
+}
+
+// Reports the speed of translated memory accesses. Run with --gtest_also_run_disabled_tests
+TEST_F(MmuCpuTest, DISABLED_Benchmark)
+{
+	constexpr u32 Iterations = 0x7fffffff;
+	constexpr int Cycles = 100'000'000;
+	const struct {
+		const char *name;
+		void (*getCpu)(sh4_if *);
+	} engines[] {
+		{ "interpreter", Get_Sh4Interpreter },
+		{ "dynarec", Get_Sh4Recompiler },
+	};
+	for (const auto& engine : engines)
+	{
+		const double time = run(engine.getCpu, Iterations, Cycles);
+		const u32 loops = Iterations - r[1];
+		ASSERT_NE(0u, loops);
+		const double mips = (double)loops * LoopInstructions / time / 1'000'000.0;
+		printf("mmu %-12s %8.1f MIPS (%.3f s)\n", engine.name, mips, time);
+	}
+}
+
+#endif
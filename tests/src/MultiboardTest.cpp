@@ -0,0 +1,105 @@
+#include "gtest/gtest.h"
+#include "types.h"
+#include "hw/naomi/multiboard.h"
+
+#if defined(NAOMI_MULTIBOARD) && !defined(_WIN32)
+#include <sys/mman.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#include <new>
+
+class MultiboardTest : public ::testing::Test
+{
+protected:
+	static constexpr int Syncs = 2000;
+
+	struct SharedState
+	{
+		IpcBarrier barrier;
+		std::atomic<bool> exit;
+		std::atomic<int> arrived[Syncs];
+		std::atomic<u64> totalWait;	// nanoseconds
+	};
+
+	void SetUp() override
+	{
+		void *p = mmap(nullptr, sizeof(SharedState), PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+		ASSERT_NE(MAP_FAILED, p);
+		state = new (p) SharedState();
+	}
+
+	void TearDown() override
+	{
+		state->~SharedState();
+		munmap(state, sizeof(SharedState));
+	}
+
+	// Returns the number of errors
+	int runBoard(int boardId, int boardCount)
+	{
+		int errors = 0;
+		for (int i = 0; i < Syncs; i++)
+		{
+			state->arrived[i]++;
+			auto start = std::chrono::steady_clock::now();
+			if (!state->barrier.wait(boardId, std::chrono::seconds(5), state->exit))
+				return errors + 1;
+			state->totalWait += std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+			// nobody may leave the barrier before everyone has arrived
+			if (state->arrived[i] != boardCount)
+				errors++;
+		}
+		return errors;
+	}
+
+	void runBoards(int boardCount)
+	{
+		state->barrier.reset(boardCount);
+		std::vector<pid_t> slaves;
+		for (int i = 1; i < boardCount; i++)
+		{
+			pid_t pid = fork();
+			ASSERT_NE(-1, pid);
+			if (pid == 0)
+				_exit(runBoard(i, boardCount));
+			slaves.push_back(pid);
+		}
+		ASSERT_EQ(0, runBoard(0, boardCount));
+		for (pid_t pid : slaves)
+		{
+			int status;
+			ASSERT_EQ(pid, waitpid(pid, &status, 0));
+			ASSERT_TRUE(WIFEXITED(status));
+			ASSERT_EQ(0, WEXITSTATUS(status));
+		}
+	}
+
+	SharedState *state = nullptr;
+};
+
+TEST_F(MultiboardTest, TwoBoards)
+{
+	runBoards(2);
+}
+
+TEST_F(MultiboardTest, FourBoards)
+{
+	runBoards(4);
+}
+
+// Reports the average time spent in the barrier. Run with --gtest_also_run_disabled_tests
+TEST_F(MultiboardTest, DISABLED_SyncLatency)
+{
+	constexpr int Boards = 4;
+	runBoards(Boards);
+	printf("%d boards: average sync latency %.1f us\n", Boards, state->totalWait / 1000.0 / Syncs / Boards);
+}
+
+TEST_F(MultiboardTest, SlaveExit)
+{
+	state->barrier.reset(2);
+	state->exit = true;
+	ASSERT_FALSE(state->barrier.wait(1, std::chrono::seconds(5), state->exit));
+}
+
+#endif
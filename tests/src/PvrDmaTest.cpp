@@ -0,0 +1,96 @@
+#include "gtest/gtest.h"
+#include "types.h"
+#include "emulator.h"
+#include "hw/mem/addrspace.h"
+#include "hw/holly/sb.h"
+#include "hw/pvr/pvr_mem.h"
+#include "hw/sh4/sh4_mem.h"
+#include "hw/sh4/sh4_mmr.h"
+#include "hw/sh4/modules/dmac.h"
+
+#include <chrono>
+#include <cstdio>
+#include <random>
+
+class PvrDmaTest : public ::testing::Test
+{
+protected:
+	void SetUp() override
+	{
+		if (!addrspace::reserve())
+			die("addrspace::reserve failed");
+		emu.init();
+		mem_map_default();
+		dc_reset(true);
+	}
+
+	void fillRam(u32 addr, u32 size)
+	{
+		for (u32 i = 0; i < size; i += 4)
+			*(u32 *)&mem_b[(addr + i) & RAM_MASK] = (u32)gen();
+	}
+
+	// Channel 2 DMA to the texture path
+	void startCh2(u32 src, u32 dst, u32 len)
+	{
+		DMAC_DMAOR.full = 0x8201;
+		DMAC_SAR(2) = src;
+		SB_C2DSTAT = dst;
+		SB_C2DLEN = len;
+		DMAC_Ch2St();
+	}
+
+	std::mt19937 gen { 4242 };
+};
+
+TEST_F(PvrDmaTest, Texture64)
+{
+	SB_LMMODE0 = 0;
+	// Source wraps around the end of system ram
+	const u32 Src = 0x0C000000 + RAM_SIZE - 0x1000;
+	constexpr u32 Size = 0x3000;
+	constexpr u32 Offset = 0x123440;
+	fillRam(Src, Size);
+	startCh2(Src, 0x11000000 + Offset, Size);
+
+	for (u32 i = 0; i < Size; i += 4)
+		ASSERT_EQ(*(u32 *)&mem_b[(Src + i) & RAM_MASK], *(u32 *)&vram[Offset + i]) << "offset " << i;
+	ASSERT_EQ(1u, DMAC_CHCR(2).TE);
+	ASSERT_EQ(0u, SB_C2DLEN);
+}
+
+TEST_F(PvrDmaTest, Texture32)
+{
+	SB_LMMODE0 = 1;
+	constexpr u32 Src = 0x0C100000;
+	constexpr u32 Size = 0x2000;
+	// Crosses the vram bank boundary
+	constexpr u32 Offset = 0x400000 - 0x1000;
+	fillRam(Src, Size);
+	startCh2(Src, 0x11000000 + Offset, Size);
+
+	for (u32 i = 0; i < Size; i += 4)
+		ASSERT_EQ(*(u32 *)&mem_b[(Src + i) & RAM_MASK], pvr_read32p<u32>(Offset + i)) << "offset " << i;
+}
+
+// Reports the throughput of texture DMA transfers. Run with --gtest_also_run_disabled_tests
+TEST_F(PvrDmaTest, DISABLED_Throughput)
+{
+	// Larger than the host caches, like texture streaming
+	constexpr u32 Src = 0x0C100000;
+	constexpr u32 Size = 0x100000;
+	constexpr u32 Buffers = 8;
+	constexpr int Iterations = 100;
+	fillRam(Src, Size * Buffers);
+	using the_clock = std::chrono::steady_clock;
+
+	for (u32 lmmode : { 0, 1 })
+	{
+		SB_LMMODE0 = lmmode;
+		auto start = the_clock::now();
+		for (int i = 0; i < Iterations; i++)
+			startCh2(Src + (i % Buffers) * Size, 0x11000000 + (i % Buffers) * Size, Size);
+		const double time = std::chrono::duration<double>(the_clock::now() - start).count();
+		printf("Texture DMA %d-bit path: %.0f MB/s\n", lmmode == 0 ? 64 : 32, (double)Size * Iterations / 1024.0 / 1024.0 / time);
+	}
+}
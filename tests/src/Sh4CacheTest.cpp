@@ -0,0 +1,160 @@
+#include "sh4_cpu_test.h"
+#include "hw/sh4/sh4_core.h"
+#include "hw/sh4/sh4_mmr.h"
+#include "cfg/option.h"
+
+#if FEAT_SHREC != DYNAREC_NONE
+
+class Sh4CacheTest : public Sh4CpuTest
+{
+protected:
+	static constexpr u32 DataAddress = 0x8C020000;
+	// Operand cache enabled, copy-back in P1, instruction cache enabled
+	static constexpr u32 DefaultCCR = 0x105;
+	static constexpr u32 OIX = 0x80;
+
+	void SetUp() override
+	{
+		Sh4CpuTest::SetUp();
+		savedAccurateCache = config::DynarecAccurateCache;
+		config::DynarecAccurateCache = true;
+	}
+
+	void TearDown() override
+	{
+		Sh4CpuTest::TearDown();
+		config::DynarecAccurateCache = savedAccurateCache;
+		CCN_CCR.reg_data = 0;
+		SetMemoryHandlers();
+	}
+
+	// Sets up the caches then writes to a copy-back area and reads it back
+	// through its uncached P2 alias, before and after invalidating the cache line.
+	// r5 holds the sum of the values read.
+	void loadProgram(u32 ccr, u32 iterations)
+	{
+		static const u16 program[] {
+			0xD109,		// mov.l @(ccr_addr), r1
+			0xD00A,		// mov.l @(ccr), r0
+			0x2102,		// mov.l r0, @r1
+			0xA000,		// bra start
+			0x0009,		// nop
+			// start:
+			0xD209,		// mov.l @(iterations), r2
+			0xD309,		// mov.l @(data), r3
+			0xD40A,		// mov.l @(uncached data), r4
+			0xE500,		// mov #0, r5
+			// loop:
+			0x2322,		// mov.l r2, @r3
+			0x6642,		// mov.l @r4, r6
+			0x356C,		// add r6, r5
+			0x0393,		// ocbi @r3
+			0x6732,		// mov.l @r3, r7
+			0x357C,		// add r7, r5
+			0x2422,		// mov.l r2, @r4
+			0x4210,		// dt r2
+			0x8BF6,		// bf loop
+			// end:
+			0xAFFE,		// bra end
+			0x0009,		// nop
+		};
+		for (u32 i = 0; i < std::size(program); i++)
+			addrspace::write16(ProgramAddress + i * 2, program[i]);
+		const u32 pool[] { 0xE0000000 | CCN_CCR_addr, ccr, iterations, DataAddress, DataAddress | 0x20000000 };
+		for (u32 i = 0; i < std::size(pool); i++)
+			addrspace::write32(ProgramAddress + sizeof(program) + i * 4, pool[i]);
+		addrspace::write32(DataAddress, 0);
+	}
+
+	void compareWithInterpreter(u32 ccr, u32 expectedSum)
+	{
+		constexpr u32 Iterations = 1000;
+		loadProgram(ccr, Iterations);
+		run(Get_Sh4Interpreter, 10'000'000);
+		const std::vector<u32> reference(&r[0], &r[16]);
+		ASSERT_EQ(0u, reference[2]);
+		ASSERT_EQ(expectedSum, reference[5]);
+
+		const struct {
+			const char *name;
+			void (*getCpu)(sh4_if *);
+		} engines[] {
+			{ "cached interpreter", Get_Sh4CachedInterpreter },
+			{ "dynarec", Get_Sh4Recompiler },
+		};
+		for (const auto& engine : engines)
+		{
+			loadProgram(ccr, Iterations);
+			run(engine.getCpu, 10'000'000);
+			for (int i = 0; i < 16; i++)
+				ASSERT_EQ(reference[i], r[i]) << engine.name << " r" << i;
+		}
+	}
+
+	// Sets up the caches then reads and writes a longword at a misaligned address.
+	// The value read is in r4.
+	void loadMisalignedProgram(u32 ccr)
+	{
+		static const u16 program[] {
+			0xD105,		// mov.l @(ccr_addr), r1
+			0xD006,		// mov.l @(ccr), r0
+			0x2102,		// mov.l r0, @r1
+			0xA000,		// bra start
+			0x0009,		// nop
+			// start:
+			0xD305,		// mov.l @(data), r3
+			0xE55A,		// mov #0x5a, r5
+			0x6432,		// mov.l @r3, r4
+			0x2352,		// mov.l r5, @r3
+			// end:
+			0xAFFE,		// bra end
+			0x0009,		// nop
+		};
+		for (u32 i = 0; i < std::size(program); i++)
+			addrspace::write16(ProgramAddress + i * 2, program[i]);
+		const u32 pool[] { 0xE0000000 | CCN_CCR_addr, ccr, DataAddress + 2 };
+		for (u32 i = 0; i < std::size(pool); i++)
+			addrspace::write32(ProgramAddress + ((sizeof(program) + 3) & ~3) + i * 4, pool[i]);
+		addrspace::write32(DataAddress, 0x11223344);
+		addrspace::write32(DataAddress + 4, 0x55667788);
+	}
+
+	bool savedAccurateCache = false;
+};
+
+// The cache isn't emulated with the bios settings
+TEST_F(Sh4CacheTest, DirectAccess)
+{
+	constexpr u32 n = 1000;
+	compareWithInterpreter(DefaultCCR, n * (n + 1));
+}
+
+// Writes stay in the cache until invalidated with ocbi
+TEST_F(Sh4CacheTest, CacheModel)
+{
+	constexpr u32 n = 1000;
+	compareWithInterpreter(DefaultCCR | OIX, n * (n + 1) - 2);
+}
+
+// The dynarec ignores address errors and accesses the memory as the interpreter does without the cache model
+TEST_F(Sh4CacheTest, MisalignedAccess)
+{
+	loadMisalignedProgram(DefaultCCR);
+	run(Get_Sh4Interpreter, 1'000'000);
+	const u32 value = r[4];
+	const u32 data[] { addrspace::read32(DataAddress), addrspace::read32(DataAddress + 4) };
+	ASSERT_EQ(0x77881122u, value);
+	ASSERT_EQ(0x005a3344u, data[0]);
+	ASSERT_EQ(0x55660000u, data[1]);
+
+	for (u32 ccr : { DefaultCCR, DefaultCCR | OIX })
+	{
+		loadMisalignedProgram(ccr);
+		run(Get_Sh4Recompiler, 1'000'000);
+		ASSERT_EQ(value, r[4]) << "CCR " << std::hex << ccr;
+		ASSERT_EQ(data[0], addrspace::read32(DataAddress)) << "CCR " << std::hex << ccr;
+		ASSERT_EQ(data[1], addrspace::read32(DataAddress + 4)) << "CCR " << std::hex << ccr;
+	}
+}
+
+#endif
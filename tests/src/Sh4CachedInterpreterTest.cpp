@@ -0,0 +1,114 @@
+#include "sh4_cpu_test.h"
+
+#include <chrono>
+#include <cstdio>
+
+class Sh4CachedInterpreterTest : public Sh4CpuTest
+{
+protected:
+	static constexpr u32 DataAddress = 0x8C020000;
+	static constexpr u32 LoopInstructions = 18;
+
+	// A loop with alu, memory, fpu and branch instructions, and a subroutine call
+	void loadProgram(u32 iterations)
+	{
+		static const u16 program[] {
+			0xE000,		// mov #0, r0
+			0xD10B,		// mov.l @(iterations), r1
+			0xD20B,		// mov.l @(data), r2
+			// loop:
+			0x301C,		// add r1, r0
+			0x6303,		// mov r0, r3
+			0x4308,		// shll2 r3
+			0x231A,		// xor r1, r3
+			0x2232,		// mov.l r3, @r2
+			0x6422,		// mov.l @r2, r4
+			0x354C,		// add r4, r5
+			0x415A,		// lds r1, fpul
+			0xF12D,		// float fpul, fr1
+			0xF010,		// fadd fr1, fr0
+			0xB005,		// bsr sub
+			0x0009,		// nop
+			0x4110,		// dt r1
+			0x8FF1,		// bf/s loop
+			0x7701,		// add #1, r7
+			// end:
+			0xAFFE,		// bra end
+			0x0009,		// nop
+			// sub:
+			0x7603,		// add #3, r6
+			0x000B,		// rts
+			0x6863,		// mov r6, r8
+			0x0009,
+		};
+		for (u32 i = 0; i < std::size(program); i++)
+			addrspace::write16(ProgramAddress + i * 2, program[i]);
+		addrspace::write32(ProgramAddress + sizeof(program), iterations);
+		addrspace::write32(ProgramAddress + sizeof(program) + 4, DataAddress);
+	}
+
+	// Runs the program for the given number of cycles and returns the elapsed time
+	double timedRun(void (*getCpu)(sh4_if *), int cycles)
+	{
+		resetCpu(getCpu);
+		auto start = std::chrono::steady_clock::now();
+		runCpu(cycles);
+		return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+	}
+};
+
+TEST_F(Sh4CachedInterpreterTest, MatchesInterpreter)
+{
+	constexpr u32 Iterations = 1000;
+	loadProgram(Iterations);
+	run(Get_Sh4Interpreter, 10'000'000);
+	const Sh4Context reference = Sh4cntx;
+	const u32 data = addrspace::read32(DataAddress);
+	ASSERT_EQ(0u, reference.r[1]);
+	ASSERT_EQ(Iterations, reference.r[7]);
+	ASSERT_EQ(Iterations * (Iterations + 1) / 2, reference.r[0]);
+
+	loadProgram(Iterations);
+	addrspace::write32(DataAddress, 0);
+	run(Get_Sh4CachedInterpreter, 10'000'000);
+	for (int i = 0; i < 16; i++)
+		ASSERT_EQ(reference.r[i], Sh4cntx.r[i]) << "r" << i;
+	ASSERT_EQ(reference.pr, Sh4cntx.pr);
+	ASSERT_EQ(reference.sr.T, Sh4cntx.sr.T);
+	ASSERT_EQ(reference.fpul, Sh4cntx.fpul);
+	ASSERT_EQ(reference.xffr[16], Sh4cntx.xffr[16]);
+	ASSERT_EQ(reference.xffr[17], Sh4cntx.xffr[17]);
+	ASSERT_EQ(data, addrspace::read32(DataAddress));
+
+	// Overwritten blocks are decoded again
+	loadProgram(Iterations / 2);
+	run(Get_Sh4CachedInterpreter, 10'000'000);
+	ASSERT_EQ(Iterations / 2, Sh4cntx.r[7]);
+}
+
+#if FEAT_SHREC != DYNAREC_NONE
+// Runs the same loop with each cpu engine and reports the speed. Run with --gtest_also_run_disabled_tests
+TEST_F(Sh4CachedInterpreterTest, DISABLED_Benchmark)
+{
+	constexpr u32 Iterations = 0x7fffffff;
+	constexpr int Cycles = 100'000'000;
+	const struct {
+		const char *name;
+		void (*getCpu)(sh4_if *);
+	} engines[] {
+		{ "interpreter", Get_Sh4Interpreter },
+		{ "cached interpreter", Get_Sh4CachedInterpreter },
+		{ "dynarec", Get_Sh4Recompiler },
+	};
+	for (const auto& engine : engines)
+	{
+		loadProgram(Iterations);
+		const double time = timedRun(engine.getCpu, Cycles);
+		const u32 loops = Sh4cntx.r[7];
+		ASSERT_NE(0u, loops);
+		const double mips = (double)loops * LoopInstructions / time / 1'000'000.0;
+		printf("%-20s %8.1f MIPS (%.3f s)\n", engine.name, mips, time);
+	}
+}
+
+#endif
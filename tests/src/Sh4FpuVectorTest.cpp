@@ -0,0 +1,112 @@
+#include "sh4_cpu_test.h"
+#include "hw/sh4/sh4_core.h"
+#include "cfg/option.h"
+
+#include <cmath>
+#include <random>
+
+#if FEAT_SHREC != DYNAREC_NONE
+
+class Sh4FpuVectorTest : public Sh4CpuTest
+{
+protected:
+	void SetUp() override
+	{
+		Sh4CpuTest::SetUp();
+		savedFastVectorOps = config::DynarecFastVectorOps;
+		loadProgram();
+	}
+
+	void TearDown() override
+	{
+		Sh4CpuTest::TearDown();
+		config::DynarecFastVectorOps = savedFastVectorOps;
+	}
+
+	void loadProgram()
+	{
+		static const u16 program[] {
+			0x426A,		// lds r2, fpscr
+			0x415A,		// lds r1, fpul
+			// the results aren't used as inputs
+			0xFBED,		// fipr fv12, fv8
+			0xF1ED,		// fipr fv4, fv0
+			0xF5FD,		// ftrv xmtrx, fv4
+			0xFCFD,		// fsca fpul, dr12
+			// end:
+			0xAFFE,		// bra end
+			0x0009,		// nop
+		};
+		for (u32 i = 0; i < std::size(program); i++)
+			addrspace::write16(ProgramAddress + i * 2, program[i]);
+	}
+
+	struct Inputs
+	{
+		f32 regs[32];
+		u32 angle;
+		u32 fpscrValue;
+	};
+
+	Inputs randomInputs()
+	{
+		Inputs inputs;
+		std::uniform_real_distribution<float> mantissa(-1.f, 1.f);
+		std::uniform_int_distribution<int> exponent(-20, 20);
+		for (f32& f : inputs.regs)
+			f = std::ldexp(mantissa(gen), exponent(gen));
+		inputs.angle = gen();
+		// round to nearest or round to zero
+		inputs.fpscrValue = gen() & 1;
+		return inputs;
+	}
+
+	// Runs the program and returns the floating point registers
+	std::vector<f32> run(void (*getCpu)(sh4_if *), const Inputs& inputs)
+	{
+		resetCpu(getCpu);
+		memcpy(Sh4cntx.xffr, inputs.regs, sizeof(inputs.regs));
+		r[1] = inputs.angle;
+		r[2] = inputs.fpscrValue;
+		runCpu(1000);
+		return std::vector<f32>(&fr[0], &fr[16]);
+	}
+
+	bool savedFastVectorOps = false;
+	std::mt19937 gen { 1337 };
+};
+
+TEST_F(Sh4FpuVectorTest, MatchesInterpreter)
+{
+	config::DynarecFastVectorOps = false;
+	for (int i = 0; i < 200; i++)
+	{
+		const Inputs inputs = randomInputs();
+		const std::vector<f32> reference = run(Get_Sh4Interpreter, inputs);
+		const std::vector<f32> results = run(Get_Sh4Recompiler, inputs);
+		for (int j = 0; j < 16; j++)
+			ASSERT_EQ(0, memcmp(&reference[j], &results[j], sizeof(f32)))
+				<< "iteration " << i << " fr" << j << ": " << reference[j] << " != " << results[j];
+	}
+}
+
+// Single precision results are close to the interpreter's
+TEST_F(Sh4FpuVectorTest, FastVectorOps)
+{
+	config::DynarecFastVectorOps = true;
+	for (int i = 0; i < 200; i++)
+	{
+		const Inputs inputs = randomInputs();
+		const std::vector<f32> reference = run(Get_Sh4Interpreter, inputs);
+		const std::vector<f32> results = run(Get_Sh4Recompiler, inputs);
+		// The largest product bounds the rounding errors of the sum
+		float magnitude = 0.f;
+		for (int j = 0; j < 32; j++)
+			magnitude = std::max(magnitude, std::abs(inputs.regs[j]));
+		const float tolerance = magnitude * magnitude * 4 * 1e-6f;
+		for (int j = 0; j < 16; j++)
+			ASSERT_NEAR(reference[j], results[j], tolerance) << "iteration " << i << " fr" << j;
+	}
+}
+
+#endif
@@ -0,0 +1,146 @@
+#include "sh4_cpu_test.h"
+#include "hw/sh4/dyna/blockmanager.h"
+#include "hw/sh4/dyna/shil.h"
+
+#include <array>
+
+#if FEAT_SHREC != DYNAREC_NONE
+
+class SsaOptimizerTest : public Sh4CpuTest
+{
+protected:
+	static constexpr u32 DataAddress = 0x8C020000;
+	static constexpr u32 StackAddress = 0x8C020100;
+	static constexpr u32 LoopAddress = ProgramAddress + 8;
+
+	// Loads two floats with fmov.s @rm+, pushes and pops them,
+	// then stores them back with fmov.s @-rn. Adds the second one to the first one each time.
+	// The data and the stack are moved by the given offset.
+	void loadProgram(u32 iterations, u32 offset = 0)
+	{
+		static const u16 program[] {
+			0xD108,		// mov.l @(iterations), r1
+			0xD209,		// mov.l @(data), r2
+			0xDF09,		// mov.l @(stack), r15
+			0x6323,		// mov r2, r3
+			// loop:
+			0xF039,		// fmov.s @r3+, fr0
+			0xF139,		// fmov.s @r3+, fr1
+			0xF010,		// fadd fr1, fr0
+			0xFF1B,		// fmov.s fr1, @-r15
+			0xFF0B,		// fmov.s fr0, @-r15
+			0xF2F9,		// fmov.s @r15+, fr2
+			0xF3F9,		// fmov.s @r15+, fr3
+			0xF33B,		// fmov.s fr3, @-r3
+			0xF32B,		// fmov.s fr2, @-r3
+			0x4110,		// dt r1
+			0x8BF4,		// bf loop
+			// end:
+			0xAFFE,		// bra end
+			0x0009,		// nop
+			0x0009,
+		};
+		for (u32 i = 0; i < std::size(program); i++)
+			addrspace::write16(ProgramAddress + i * 2, program[i]);
+		const u32 pool[] { iterations, DataAddress + offset, StackAddress + offset };
+		for (u32 i = 0; i < std::size(pool); i++)
+			addrspace::write32(ProgramAddress + sizeof(program) + i * 4, pool[i]);
+		addrspace::write32(DataAddress + offset, 0);			// 0.f
+		addrspace::write32(DataAddress + offset + 4, 0x3f800000);	// 1.f
+	}
+
+	// Stores fr0 and fr1 at r3 and r3 + 4
+	void loadStoreProgram()
+	{
+		static const u16 program[] {
+			0xF30A,		// fmov.s fr0, @r3
+			0x7304,		// add #4, r3
+			0xF31A,		// fmov.s fr1, @r3
+			// end:
+			0xAFFE,		// bra end
+			0x0009,		// nop
+		};
+		for (u32 i = 0; i < std::size(program); i++)
+			addrspace::write16(ProgramAddress + i * 2, program[i]);
+	}
+
+	// Returns the number of 64-bit memory accesses in the block compiled at the given address
+	int pairedMemOps(u32 address)
+	{
+		RuntimeBlockInfoPtr block = bm_GetBlock(address);
+		if (block == nullptr)
+			return -1;
+		int count = 0;
+		for (const shil_opcode& op : block->oplist)
+			if ((op.op == shop_readm || op.op == shop_writem) && op.size == 8)
+				count++;
+		return count;
+	}
+
+	// Runs the store program and returns the content of the store queues
+	std::array<u32, 16> runStoreQueueWrite(void (*getCpu)(sh4_if *))
+	{
+		resetCpu(getCpu);
+		memset(p_sh4rcb->sq_buffer, 0, sizeof(p_sh4rcb->sq_buffer));
+		Sh4cntx.r[3] = 0xE000003C;
+		Sh4cntx.xffr[16] = 1.f;
+		Sh4cntx.xffr[17] = 2.f;
+		runCpu(1000);
+		std::array<u32, 16> sq;
+		memcpy(sq.data(), p_sh4rcb->sq_buffer, sizeof(sq));
+		return sq;
+	}
+
+	void compareWithInterpreter(u32 iterations, u32 offset)
+	{
+		loadProgram(iterations, offset);
+		run(Get_Sh4Interpreter, 10'000'000);
+		const Sh4Context reference = Sh4cntx;
+		const u32 data[] { addrspace::read32(DataAddress + offset), addrspace::read32(DataAddress + offset + 4) };
+		ASSERT_EQ(0u, reference.r[1]);
+		ASSERT_EQ((float)iterations, reference.xffr[16]);
+		ASSERT_EQ(1.f, reference.xffr[17]);
+
+		loadProgram(iterations, offset);
+		run(Get_Sh4Recompiler, 10'000'000);
+		for (int i = 0; i < 16; i++)
+			ASSERT_EQ(reference.r[i], Sh4cntx.r[i]) << "r" << i;
+		for (int i = 0; i < 4; i++)
+			ASSERT_EQ(reference.xffr[16 + i], Sh4cntx.xffr[16 + i]) << "fr" << i;
+		ASSERT_EQ(data[0], addrspace::read32(DataAddress + offset));
+		ASSERT_EQ(data[1], addrspace::read32(DataAddress + offset + 4));
+		ASSERT_EQ(StackAddress + offset, reference.r[15]);
+		ASSERT_EQ(0x3f800000u, addrspace::read32(StackAddress + offset - 4));
+	}
+};
+
+TEST_F(SsaOptimizerTest, FpuMemOps)
+{
+	compareWithInterpreter(1000, 0);
+	// The loads, the pushes and the pops are paired.
+	// The stores to r3 aren't since their order must be kept.
+	ASSERT_EQ(3, pairedMemOps(LoopAddress));
+}
+
+// Paired accesses at addresses that are only 4-byte aligned
+TEST_F(SsaOptimizerTest, UnalignedFpuMemOps)
+{
+	compareWithInterpreter(1000, 4);
+	ASSERT_EQ(3, pairedMemOps(LoopAddress));
+}
+
+// The second half of an unaligned 64-bit store queue write wraps around to the first queue
+TEST_F(SsaOptimizerTest, UnalignedStoreQueueWrite)
+{
+	loadStoreProgram();
+	const std::array<u32, 16> reference = runStoreQueueWrite(Get_Sh4Interpreter);
+	ASSERT_EQ(0x3f800000u, reference[15]);	// 1.f
+	ASSERT_EQ(0x40000000u, reference[0]);	// 2.f
+
+	const std::array<u32, 16> sq = runStoreQueueWrite(Get_Sh4Recompiler);
+	ASSERT_EQ(1, pairedMemOps(ProgramAddress));
+	for (int i = 0; i < 16; i++)
+		ASSERT_EQ(reference[i], sq[i]) << "sq word " << i;
+}
+
+#endif
@@ -0,0 +1,104 @@
+#include "gtest/gtest.h"
+#include "types.h"
+#include "hw/pvr/ta_ctx.h"
+#include "cfg/option.h"
+
+#include <atomic>
+#include <chrono>
+#include <thread>
+
+class TaContextTest : public ::testing::Test
+{
+protected:
+	void TearDown() override
+	{
+		tactx_Term();
+	}
+};
+
+TEST_F(TaContextTest, HighWaterMark)
+{
+	const TAContextStats initial = getTAContextStats();
+	TA_context *ctx = tactx_Alloc();
+	ASSERT_EQ(initial.contexts + 1, getTAContextStats().contexts);
+	ASSERT_EQ(initial.memory + ctx->memoryUsage(), getTAContextStats().memory);
+
+	// A heavy frame grows the buffers
+	const size_t vertexCount = ctx->rend.verts.capacity() * 3;
+	ctx->rend.verts.resize(vertexCount);
+	ctx->rend.idx.resize(vertexCount);
+	ctx->Reset();
+	ASSERT_EQ(initial.growths + 1, getTAContextStats().growths);
+	ASSERT_EQ(initial.memory + ctx->memoryUsage(), getTAContextStats().memory);
+
+	// New contexts are big enough for it
+	TA_context *ctx2 = tactx_Alloc();
+	ASSERT_LE(vertexCount, ctx2->rend.verts.capacity());
+	ASSERT_LE(vertexCount, ctx2->rend.idx.capacity());
+	ctx2->rend.verts.resize(vertexCount);
+	ctx2->Reset();
+	ASSERT_EQ(initial.growths + 1, getTAContextStats().growths);
+
+	delete ctx;
+	delete ctx2;
+	ASSERT_EQ(initial.contexts, getTAContextStats().contexts);
+	ASSERT_EQ(initial.memory, getTAContextStats().memory);
+}
+
+// Render to texture frames don't grow the screen contexts
+TEST_F(TaContextTest, RenderToTextureHighWaterMark)
+{
+	TA_context *ctx = tactx_Alloc();
+	const size_t vertexCount = ctx->rend.verts.capacity() * 3;
+	ctx->rend.isRTT = true;
+	ctx->rend.verts.resize(vertexCount);
+	ctx->Reset();
+
+	TA_context *ctx2 = tactx_Alloc();
+	ASSERT_GT(vertexCount, ctx2->rend.verts.capacity());
+	// until it's used for render to texture
+	ctx2->rend.isRTT = true;
+	ctx2->Reset();
+	ASSERT_LE(vertexCount, ctx2->rend.verts.capacity());
+
+	delete ctx;
+	delete ctx2;
+}
+
+// Contexts are queued up to the queue depth, but the emulator waits for the queued frames
+// to be read from vram before it continues after a render
+TEST_F(TaContextTest, RenderQueueDepth)
+{
+	const bool threaded = config::ThreadedRendering;
+	const int depth = config::RenderQueueDepth;
+	const int policy = config::RenderQueuePolicy;
+	config::ThreadedRendering = true;
+	config::RenderQueueDepth = 3;
+	config::RenderQueuePolicy = 1;	// max throughput
+
+	ASSERT_TRUE(QueueRender(tactx_Alloc()));
+	ASSERT_TRUE(QueueRender(tactx_Alloc()));
+	ASSERT_TRUE(QueueRender(tactx_Alloc()));
+
+	std::atomic<int> released { 0 };
+	std::thread renderThread([&released]() {
+		for (int i = 0; i < 3; i++)
+		{
+			std::this_thread::sleep_for(std::chrono::milliseconds(10));
+			TA_context *ctx = DequeueRender();
+			released++;
+			ReleaseRenderVram();
+			FinishRender(ctx);
+		}
+	});
+	WaitRenderVram();
+	ASSERT_EQ(3, released);
+	renderThread.join();
+	// returns immediately
+	WaitRenderVram();
+
+	ClearRenderQueue();
+	config::ThreadedRendering = threaded;
+	config::RenderQueueDepth = depth;
+	config::RenderQueuePolicy = policy;
+}
@@ -0,0 +1,182 @@
+#include "gtest/gtest.h"
+#include "types.h"
+#include "hw/pvr/ta.h"
+#include "hw/pvr/ta_ctx.h"
+#include "hw/mem/addrspace.h"
+
+#include <chrono>
+#include <cstdio>
+#include <random>
+
+extern u8 ta_fsm[2049];
+extern u32 ta_fsm_cl;
+
+class TaFifoTest : public ::testing::Test
+{
+protected:
+	void SetUp() override
+	{
+		// The end of list interrupts need the SH4 context
+		if (!addrspace::reserve())
+			die("addrspace::reserve failed");
+		ctx.Alloc();
+		ta_ctx = &ctx;
+		ta_tad = ctx.tad;
+	}
+
+	void TearDown() override
+	{
+		ta_ctx = nullptr;
+		ta_tad.Reset(nullptr);
+	}
+
+	void addBlock(PCW pcw)
+	{
+		SQBuffer& block = stream.emplace_back();
+		for (u32 i = 0; i < sizeof(block.data); i++)
+			block.data[i] = (u8)gen();
+		memcpy(block.data, &pcw, sizeof(pcw));
+	}
+
+	// Similar to the TA data sent by a game: a few lists of polygon strips,
+	// with 32 and 64-byte parameters and vertices.
+	void makeStream(u32 polysPerList)
+	{
+		static const u8 objCtrls[] { 0x00, 0x08, 0x0c, 0x18, 0x1c, 0x28, 0x2c, 0x38, 0x48, 0x6c };
+		static const u32 listTypes[] { ListType_Opaque, ListType_Opaque_Modifier_Volume, ListType_Translucent, ListType_Punch_Through };
+		stream.clear();
+		for (u32 listType : listTypes)
+		{
+			for (u32 p = 0; p < polysPerList; p++)
+			{
+				PCW pcw{};
+				pcw.ListType = listType;
+				if (gen() % 16 == 0 && listType != ListType_Opaque_Modifier_Volume)
+				{
+					pcw.ParaType = ParamType_Sprite;
+					addBlock(pcw);
+					pcw.ParaType = ParamType_Vertex_Parameter;
+					pcw.EndOfStrip = 1;
+					addBlock(pcw);
+					addBlock(pcw);
+					continue;
+				}
+				pcw.ParaType = ParamType_Polygon_or_Modifier_Volume;
+				pcw.obj_ctrl = objCtrls[gen() % std::size(objCtrls)];
+				addBlock(pcw);
+				const u32 polyId = TaTypeLut::instance().table[pcw.obj_ctrl];
+				if (listType != ListType_Opaque_Modifier_Volume && (polyId >> 30) == SZ64)
+					addBlock(pcw);
+				const u32 vertexType = (u8)polyId;
+				const bool vertex64 = listType == ListType_Opaque_Modifier_Volume
+						|| vertexType == 5 || vertexType == 6 || (vertexType >= 11 && vertexType <= 14);
+				const u32 vertexCount = listType == ListType_Opaque_Modifier_Volume ? 1 : 3 + gen() % 12;
+				for (u32 v = 0; v < vertexCount; v++)
+				{
+					PCW vpcw{};
+					vpcw.ParaType = ParamType_Vertex_Parameter;
+					vpcw.EndOfStrip = v == vertexCount - 1;
+					addBlock(vpcw);
+					if (vertex64)
+						addBlock(vpcw);
+				}
+			}
+			PCW eol{};
+			eol.ParaType = ParamType_End_Of_List;
+			addBlock(eol);
+		}
+	}
+
+	void listInit()
+	{
+		ta_tad.Clear();
+		ta_vtx_SoftReset();
+		ta_fsm_cl = 7;
+	}
+
+	// Send the stream one store queue at a time
+	void sendBlocks()
+	{
+		for (const SQBuffer& block : stream)
+			ta_vtx_data32(&block);
+	}
+
+	// Send the stream in DMA transfers of various sizes
+	void sendDma()
+	{
+		u32 offset = 0;
+		while (offset < stream.size())
+		{
+			u32 size = std::min<u32>(1 + gen() % 2048, stream.size() - offset);
+			ta_vtx_data(&stream[offset], size);
+			offset += size;
+		}
+	}
+
+	TA_context ctx;
+	std::mt19937 gen { 31337 };
+	std::vector<SQBuffer> stream;
+};
+
+TEST_F(TaFifoTest, DmaMatchesStoreQueue)
+{
+	makeStream(500);
+	const u32 size = stream.size() * sizeof(SQBuffer);
+
+	listInit();
+	sendBlocks();
+	ASSERT_EQ(size, ta_tad.thd_data - ta_tad.thd_root);
+	const u8 state = ta_fsm[2048];
+	const u32 listType = ta_fsm_cl;
+	const std::vector<u8> reference(ta_tad.thd_root, ta_tad.thd_data);
+
+	listInit();
+	sendDma();
+	ASSERT_EQ(size, ta_tad.thd_data - ta_tad.thd_root);
+	ASSERT_EQ(state, ta_fsm[2048]);
+	ASSERT_EQ(listType, ta_fsm_cl);
+	ASSERT_EQ(0, memcmp(reference.data(), ta_tad.thd_root, size));
+}
+
+TEST_F(TaFifoTest, Overflow)
+{
+	makeStream(8);
+	listInit();
+	// Fill the buffer except for a few blocks
+	const u32 room = 5;
+	ta_tad.thd_data = ta_tad.thd_root + TA_DATA_SIZE - room * sizeof(SQBuffer);
+	ta_vtx_data(stream.data(), stream.size());
+	ASSERT_EQ(ta_tad.thd_root + TA_DATA_SIZE, ta_tad.thd_data);
+	ASSERT_EQ(0, memcmp(stream.data(), ta_tad.thd_root + TA_DATA_SIZE - room * sizeof(SQBuffer), room * sizeof(SQBuffer)));
+}
+
+// Replay a TA stream through both paths and report the throughput. Run with --gtest_also_run_disabled_tests
+TEST_F(TaFifoTest, DISABLED_Throughput)
+{
+	makeStream(5000);
+	const u32 size = stream.size() * sizeof(SQBuffer);
+	ASSERT_LE(size, TA_DATA_SIZE);
+	constexpr int Iterations = 20;
+	using the_clock = std::chrono::steady_clock;
+
+	auto start = the_clock::now();
+	for (int i = 0; i < Iterations; i++)
+	{
+		listInit();
+		sendBlocks();
+	}
+	const double sqTime = std::chrono::duration<double>(the_clock::now() - start).count();
+
+	start = the_clock::now();
+	for (int i = 0; i < Iterations; i++)
+	{
+		listInit();
+		sendDma();
+	}
+	const double dmaTime = std::chrono::duration<double>(the_clock::now() - start).count();
+	ASSERT_EQ(size, ta_tad.thd_data - ta_tad.thd_root);
+
+	const double megabytes = (double)size * Iterations / 1024.0 / 1024.0;
+	printf("TA stream %.1f MB: store queue %.0f MB/s, DMA %.0f MB/s\n", (double)size / 1024.0 / 1024.0,
+			megabytes / sqTime, megabytes / dmaTime);
+}
@@ -0,0 +1,297 @@
+#include "gtest/gtest.h"
+#include "types.h"
+#include "cfg/option.h"
+#include "hw/pvr/ta.h"
+#include "hw/pvr/ta_ctx.h"
+
+#include <algorithm>
+#include <random>
+
+class TaVertexDecodeTest : public ::testing::Test
+{
+protected:
+	void SetUp() override
+	{
+		ctx.Alloc();
+		ta_ctx = &ctx;
+		savedRenderer = config::RendererType;
+	}
+
+	void TearDown() override
+	{
+		config::RendererType = savedRenderer;
+		ta_ctx = nullptr;
+	}
+
+	static u32 floatBits(float f)
+	{
+		u32 v;
+		memcpy(&v, &f, sizeof(v));
+		return v;
+	}
+
+	static float bitsFloat(u32 v)
+	{
+		float f;
+		memcpy(&f, &v, sizeof(f));
+		return f;
+	}
+
+	// Reference float to byte conversion: only the upper 16 bits are used, NaN is 255
+	static u8 satu8(u32 bits)
+	{
+		float f = bitsFloat(bits & 0xffff0000);
+		return f == f ? (u8)(std::min(1.f, std::max(0.f, f)) * 255.f) : 255;
+	}
+
+	void setColor(u8 *to, u8 a, u8 r, u8 g, u8 b) const
+	{
+		to[dx ? 2 : 0] = r;
+		to[1] = g;
+		to[dx ? 0 : 2] = b;
+		to[3] = a;
+	}
+
+	void packedColor(u8 *to, u32 argb) const {
+		setColor(to, argb >> 24, argb >> 16, argb >> 8, argb);
+	}
+
+	void floatColor(u8 *to, const u32 *argb) const {
+		setColor(to, satu8(argb[0]), satu8(argb[1]), satu8(argb[2]), satu8(argb[3]));
+	}
+
+	static void intensityColor(u8 *to, const u8 *face, u32 intensity)
+	{
+		u32 i = satu8(intensity);
+		for (int c = 0; c < 3; c++)
+			to[c] = face[c] * i / 256;
+		to[3] = face[3];
+	}
+
+	static void uv16(float& u, float& v, u32 bits)
+	{
+		u = bitsFloat(bits & 0xffff0000);
+		v = bitsFloat(bits << 16);
+	}
+
+	// Random word: either random bits or a float around the [0, 1] range
+	u32 randomWord()
+	{
+		static const float specials[] { 0.f, -0.f, 1.f, -1.f, 0.5f, 2.f, 1e-30f, -1e30f,
+			std::numeric_limits<float>::infinity(), -std::numeric_limits<float>::infinity(),
+			std::numeric_limits<float>::quiet_NaN() };
+		switch (gen() % 4)
+		{
+		case 0:
+			return (u32)gen();
+		case 1:
+			return floatBits(specials[gen() % std::size(specials)]);
+		default:
+			return floatBits(std::uniform_real_distribution<float>(-0.25f, 1.25f)(gen));
+		}
+	}
+
+	void addBlock(const u32 *words)
+	{
+		stream.insert(stream.end(), words, words + 8);
+	}
+
+	// Polygon parameter followed by a strip of random vertices.
+	// Each vertex is decoded by the reference implementation.
+	void addPolygon(u8 objCtrl, u32 vertexCount)
+	{
+		PCW pcw{};
+		pcw.obj_ctrl = objCtrl;
+		pcw.ParaType = ParamType_Polygon_or_Modifier_Volume;
+		pcw.ListType = ListType_Opaque;
+		const u32 uid = TaTypeLut::instance().table[objCtrl];
+		ASSERT_NE(TaTypeLut::INVALID_TYPE, uid);
+		const u32 polyType = (u8)(uid >> 8);
+		const u32 vertexType = (u8)uid;
+		const bool vertex64 = vertexType == 5 || vertexType == 6 || vertexType >= 11;
+
+		u32 param[16] {};
+		param[0] = pcw.full;
+		for (int i = 8; i < 16; i++)
+			param[i] = randomWord();
+		switch (polyType)
+		{
+		case 1:
+			for (int i = 4; i < 8; i++)
+				param[i] = randomWord();
+			floatColor(faceBase, &param[4]);
+			break;
+		case 2:
+			floatColor(faceBase, &param[8]);
+			floatColor(faceOffs, &param[12]);
+			break;
+		case 4:
+			floatColor(faceBase, &param[8]);
+			floatColor(faceBase1, &param[12]);
+			break;
+		}
+		addBlock(&param[0]);
+		if (polyType == 2 || polyType == 4)
+			addBlock(&param[8]);
+
+		for (u32 n = 0; n < vertexCount; n++)
+		{
+			u32 w[16];
+			PCW vpcw{};
+			vpcw.ParaType = ParamType_Vertex_Parameter;
+			vpcw.EndOfStrip = n == vertexCount - 1;
+			w[0] = vpcw.full;
+			for (int i = 1; i < 16; i++)
+				w[i] = randomWord();
+			addBlock(&w[0]);
+			if (vertex64)
+				addBlock(&w[8]);
+
+			Vertex& v = expected.emplace_back();
+			VertexTwoVolumes& v1 = expected1.emplace_back();
+			memcpy(&v.x, &w[1], 12);
+			switch (vertexType)
+			{
+			case 0:
+				packedColor(v.col, w[6]);
+				break;
+			case 1:
+				floatColor(v.col, &w[4]);
+				break;
+			case 2:
+				intensityColor(v.col, faceBase, w[6]);
+				break;
+			case 3:
+			case 4:
+			case 7:
+			case 8:
+				if (vertexType == 3 || vertexType == 7) {
+					v.u = bitsFloat(w[4]);
+					v.v = bitsFloat(w[5]);
+				}
+				else {
+					uv16(v.u, v.v, w[4]);
+				}
+				if (vertexType <= 4) {
+					packedColor(v.col, w[6]);
+					packedColor(v.spc, w[7]);
+				}
+				else {
+					intensityColor(v.col, faceBase, w[6]);
+					intensityColor(v.spc, faceOffs, w[7]);
+				}
+				break;
+			case 5:
+			case 6:
+				if (vertexType == 5) {
+					v.u = bitsFloat(w[4]);
+					v.v = bitsFloat(w[5]);
+				}
+				else {
+					uv16(v.u, v.v, w[4]);
+				}
+				floatColor(v.col, &w[8]);
+				floatColor(v.spc, &w[12]);
+				break;
+			case 9:
+				packedColor(v.col, w[4]);
+				packedColor(v1.col1, w[5]);
+				break;
+			case 10:
+				intensityColor(v.col, faceBase, w[4]);
+				intensityColor(v1.col1, faceBase1, w[5]);
+				break;
+			default:	// 11 - 14
+				if (vertexType == 11 || vertexType == 13)
+				{
+					v.u = bitsFloat(w[4]);
+					v.v = bitsFloat(w[5]);
+					v1.u1 = bitsFloat(w[8]);
+					v1.v1 = bitsFloat(w[9]);
+				}
+				else
+				{
+					uv16(v.u, v.v, w[4]);
+					uv16(v1.u1, v1.v1, w[8]);
+				}
+				if (vertexType <= 12)
+				{
+					packedColor(v.col, w[6]);
+					packedColor(v.spc, w[7]);
+					packedColor(v1.col1, w[10]);
+					packedColor(v1.spc1, w[11]);
+				}
+				else
+				{
+					intensityColor(v.col, faceBase, w[6]);
+					intensityColor(v.spc, faceOffs, w[7]);
+					intensityColor(v1.col1, faceBase1, w[10]);
+					intensityColor(v1.spc1, faceOffs1, w[11]);
+				}
+				break;
+			}
+		}
+	}
+
+	void decodeAndCompare(RenderType rendererType)
+	{
+		config::RendererType = rendererType;
+		dx = isDirectX(rendererType);
+		ctx.rend.Clear();
+		ta_parse_reset();
+		stream.clear();
+		expected.clear();
+		expected1.clear();
+		memset(faceBase, 0xff, sizeof(faceBase));
+		memset(faceOffs, 0xff, sizeof(faceOffs));
+		memset(faceBase1, 0xff, sizeof(faceBase1));
+		memset(faceOffs1, 0xff, sizeof(faceOffs1));
+
+		// every polygon/vertex type. Color type 3 uses the last face colors
+		static const u8 objCtrls[] {
+			0x00, 0x10, 0x20, 0x30,
+			0x08, 0x09, 0x0c, 0x0d, 0x18, 0x19, 0x28, 0x29, 0x2c, 0x2d, 0x38, 0x39,
+			0x40, 0x60, 0x70,
+			0x48, 0x49, 0x68, 0x69, 0x78, 0x79,
+		};
+		for (int pass = 0; pass < 4; pass++)
+			for (u8 objCtrl : objCtrls)
+				addPolygon(objCtrl | (gen() & 2), 1 + gen() % 5);
+
+		// skip the background polygon vertices
+		const rend_context& rend = ctx.rend;
+		const size_t first = rend.verts.size();
+		u32 size = stream.size() * sizeof(u32);
+		ASSERT_EQ(size, ta_add_ta_data(stream.data(), size));
+
+		ASSERT_EQ(first + expected.size(), rend.verts.size());
+		for (size_t i = 0; i < expected.size(); i++)
+			ASSERT_EQ(0, memcmp(&expected[i], &rend.verts[first + i], sizeof(Vertex))) << "vertex " << i;
+		ASSERT_LT(first, rend.vertsTwoVolumes.size());
+		ASSERT_LE(rend.vertsTwoVolumes.size(), first + expected1.size());
+		for (size_t i = 0; first + i < rend.vertsTwoVolumes.size(); i++)
+			ASSERT_EQ(0, memcmp(&expected1[i], &rend.vertsTwoVolumes[first + i], sizeof(VertexTwoVolumes))) << "vertex " << i;
+	}
+
+	TA_context ctx;
+	RenderType savedRenderer;
+	bool dx = false;
+	std::mt19937 gen { 5150 };
+	std::vector<u32> stream;
+	std::vector<Vertex> expected;
+	std::vector<VertexTwoVolumes> expected1;
+	u8 faceBase[4];
+	u8 faceOffs[4];
+	u8 faceBase1[4];
+	u8 faceOffs1[4];
+};
+
+TEST_F(TaVertexDecodeTest, OpenGL)
+{
+	decodeAndCompare(RenderType::OpenGL);
+}
+
+TEST_F(TaVertexDecodeTest, DirectX)
+{
+	decodeAndCompare(RenderType::DirectX11);
+}
@@ -0,0 +1,112 @@
+#include "gtest/gtest.h"
+#include "types.h"
+#include "hw/pvr/ta_ctx.h"
+
+#include <algorithm>
+#include <random>
+
+class TriangleSortTest : public ::testing::Test
+{
+protected:
+	struct Triangle
+	{
+		u32 vid[3];
+		float z;
+	};
+
+	// Add a translucent pass of random triangle strips with many equal z values
+	void addPass(u32 polyCount, std::mt19937& gen)
+	{
+		static const float zValues[] { 0.f, -0.f, 1.f, 0.5f, -2.f, 1e-20f, 100.f, -1e10f, 3.f, 0.25f };
+		std::uniform_int_distribution<u32> stripLength(1, 8);
+		std::uniform_int_distribution<u32> zIndex(0, std::size(zValues) - 1);
+		for (u32 i = 0; i < polyCount; i++)
+		{
+			PolyParam& pp = ctx.global_param_tr.emplace_back();
+			pp.init();
+			pp.first = ctx.verts.size();
+			pp.count = stripLength(gen);
+			for (u32 j = 0; j < pp.count; j++)
+			{
+				Vertex& vtx = ctx.verts.emplace_back();
+				vtx.x = (float)j;
+				vtx.y = (float)i;
+				vtx.z = zValues[zIndex(gen)];
+			}
+		}
+		RenderPass& pass = ctx.render_passes.emplace_back();
+		pass = {};
+		pass.autosort = true;
+		pass.tr_count = ctx.global_param_tr.size();
+	}
+
+	// Reference ordering: all triangles of a pass sorted with std::stable_sort
+	std::vector<u32> referenceIndex()
+	{
+		std::vector<u32> index;
+		u32 first = 0;
+		for (const RenderPass& pass : ctx.render_passes)
+		{
+			std::vector<Triangle> triangles;
+			for (u32 i = first; i < pass.tr_count; i++)
+			{
+				const PolyParam& pp = ctx.global_param_tr[i];
+				for (u32 j = 2; j < pp.count; j++)
+				{
+					// odd triangles have their first two vertices swapped
+					Triangle& t = triangles.emplace_back();
+					t.vid[0] = pp.first + (j & 1 ? j - 1 : j - 2);
+					t.vid[1] = pp.first + (j & 1 ? j - 2 : j - 1);
+					t.vid[2] = pp.first + j;
+					t.z = std::min({ ctx.verts[t.vid[0]].z, ctx.verts[t.vid[1]].z, ctx.verts[t.vid[2]].z });
+				}
+			}
+			std::stable_sort(triangles.begin(), triangles.end(), [](const Triangle& a, const Triangle& b) {
+				return a.z < b.z;
+			});
+			for (const Triangle& t : triangles)
+				index.insert(index.end(), t.vid, t.vid + 3);
+			first = pass.tr_count;
+		}
+		return index;
+	}
+
+	rend_context ctx;
+};
+
+TEST_F(TriangleSortTest, StableOrder)
+{
+	std::mt19937 gen(1234);
+	// big passes are sorted on worker threads
+	addPass(500, gen);
+	addPass(3, gen);
+	addPass(1000, gen);
+
+	sortTriangles(ctx);
+
+	ASSERT_EQ(referenceIndex(), ctx.idx);
+	u32 previousCount = 0;
+	for (const RenderPass& pass : ctx.render_passes)
+	{
+		ASSERT_LT(previousCount, pass.sorted_tr_count);
+		previousCount = pass.sorted_tr_count;
+	}
+	ASSERT_EQ(ctx.sortedTriangles.size(), previousCount);
+	u32 indexCount = 0;
+	for (const SortedTriangle& st : ctx.sortedTriangles)
+	{
+		ASSERT_EQ(indexCount, st.first);
+		indexCount += st.count;
+	}
+	ASSERT_EQ(ctx.idx.size(), indexCount);
+}
+
+TEST_F(TriangleSortTest, EmptyPass)
+{
+	RenderPass& pass = ctx.render_passes.emplace_back();
+	pass = {};
+	pass.autosort = true;
+	sortTriangles(ctx);
+	ASSERT_TRUE(ctx.idx.empty());
+	ASSERT_EQ(0u, ctx.render_passes[0].sorted_tr_count);
+}
@@ -0,0 +1,140 @@
+#include "gtest/gtest.h"
+#include "types.h"
+#include "emulator.h"
+#include "hw/mem/addrspace.h"
+#include "cfg/option.h"
+
+#if defined(__linux__) && !defined(__ANDROID__)
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/resource.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include <chrono>
+#include <cstdio>
+#include <random>
+
+class VirtmemTest : public ::testing::Test
+{
+protected:
+	void SetUp() override
+	{
+		if (!addrspace::reserve())
+			die("addrspace::reserve failed");
+		emu.init();
+		savedHugePages = config::HugePages;
+		savedPrefault = config::PrefaultMemory;
+	}
+
+	void TearDown() override
+	{
+		config::HugePages = savedHugePages;
+		config::PrefaultMemory = savedPrefault;
+		addrspace::initMappings();
+	}
+
+	// Maps the guest memory with the given hints and returns the time it took
+	double initMappings(bool hugePages, bool prefault)
+	{
+		config::HugePages = hugePages;
+		config::PrefaultMemory = prefault;
+		auto start = std::chrono::steady_clock::now();
+		addrspace::initMappings();
+		return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+	}
+
+	static long minorFaults()
+	{
+		rusage usage;
+		getrusage(RUSAGE_SELF, &usage);
+		return usage.ru_minflt;
+	}
+
+	// Reads a word in each page of the system ram mirrors
+	static u32 touchRamMirrors()
+	{
+		u32 sum = 0;
+		for (u32 addr = 0x0C000000; addr < 0x10000000; addr += PAGE_SIZE)
+			sum += *(volatile u32 *)&addrspace::ram_base[addr];
+		return sum;
+	}
+
+	bool savedHugePages = false;
+	bool savedPrefault = false;
+};
+
+TEST_F(VirtmemTest, Prefault)
+{
+	if (!addrspace::virtmemEnabled())
+		GTEST_SKIP() << "virtual memory not available";
+	initMappings(false, false);
+	long faults = minorFaults();
+	touchRamMirrors();
+	const long lazyFaults = minorFaults() - faults;
+
+	initMappings(false, true);
+	faults = minorFaults();
+	touchRamMirrors();
+	const long prefaultedFaults = minorFaults() - faults;
+	// The first mirror is touched when the memory is cleared, and the kernel maps
+	// several pages per fault, but the other mirrors still fault
+	ASSERT_GE(lazyFaults, 3 * (long)(RAM_SIZE / 1_MB)) << prefaultedFaults;
+	ASSERT_LT(prefaultedFaults, lazyFaults / 8) << lazyFaults;
+}
+
+// Reports the mapping time and the dTLB misses of random accesses to the guest memory
+// with each combination of hints. Run with --gtest_also_run_disabled_tests
+TEST_F(VirtmemTest, DISABLED_Benchmark)
+{
+	if (!addrspace::virtmemEnabled())
+		GTEST_SKIP() << "virtual memory not available";
+	perf_event_attr attr{};
+	attr.type = PERF_TYPE_HW_CACHE;
+	attr.size = sizeof(attr);
+	attr.config = PERF_COUNT_HW_CACHE_DTLB | (PERF_COUNT_HW_CACHE_OP_READ << 8) | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16);
+	attr.disabled = 1;
+	attr.exclude_kernel = 1;
+	attr.exclude_hv = 1;
+	const int fd = syscall(__NR_perf_event_open, &attr, 0, -1, -1, 0);
+
+	constexpr int Accesses = 4'000'000;
+	for (bool hugePages : { false, true })
+		for (bool prefault : { false, true })
+		{
+			const double mapTime = initMappings(hugePages, prefault);
+			std::mt19937 gen(1234);
+			u32 sum = 0;
+			if (fd >= 0)
+			{
+				ioctl(fd, PERF_EVENT_IOC_RESET, 0);
+				ioctl(fd, PERF_EVENT_IOC_ENABLE, 0);
+			}
+			auto start = std::chrono::steady_clock::now();
+			for (int i = 0; i < Accesses; i++)
+			{
+				// main ram, its mirrors and vram
+				const u32 r = gen();
+				const u32 addr = (r & 1) ? 0x04000000 | (r & VRAM_MASK & ~3) : 0x0C000000 | ((r >> 2) & 0x03FFFFFC);
+				sum += *(volatile u32 *)&addrspace::ram_base[addr];
+			}
+			const double accessTime = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+			u64 misses = 0;
+			if (fd >= 0)
+			{
+				ioctl(fd, PERF_EVENT_IOC_DISABLE, 0);
+				if (read(fd, &misses, sizeof(misses)) != sizeof(misses))
+					misses = 0;
+			}
+			ASSERT_EQ(0u, sum);
+			char missText[32] = "n/a";
+			if (fd >= 0)
+				snprintf(missText, sizeof(missText), "%llu", (unsigned long long)misses);
+			printf("huge pages %d prefault %d: map %.2f ms, %d random reads %.2f ms, dTLB misses %s\n",
+					hugePages, prefault, mapTime * 1000.0, Accesses, accessTime * 1000.0, missText);
+		}
+	if (fd >= 0)
+		close(fd);
+}
+
+#endif
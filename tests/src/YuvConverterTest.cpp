@@ -0,0 +1,95 @@
+#include "gtest/gtest.h"
+#include "types.h"
+#include "hw/mem/addrspace.h"
+#include "emulator.h"
+#include "hw/pvr/pvr_mem.h"
+#include "hw/pvr/pvr_regs.h"
+
+#include <random>
+
+class YuvConverterTest : public ::testing::Test
+{
+protected:
+	void SetUp() override
+	{
+		if (!addrspace::reserve())
+			die("addrspace::reserve failed");
+		emu.init();
+		dc_reset(true);
+	}
+
+	// Reference conversion of a 384-byte macro block at (mbx, mby) to UYVY
+	static void convert(const u8 *in, u32 mbx, u32 mby, u32 width, std::vector<u8>& out)
+	{
+		for (u32 y = 0; y < 16; y++)
+			for (u32 x = 0; x < 16; x++)
+			{
+				u32 chroma = (y / 2) * 8 + x / 2;
+				u32 yblock = (y >= 8 ? 2 : 0) + (x >= 8 ? 1 : 0);
+				u8 *p = &out[((mby * 16 + y) * width + mbx * 16 + x) * 2];
+				p[0] = x & 1 ? in[64 + chroma] : in[chroma];
+				p[1] = in[128 + yblock * 64 + (y & 7) * 8 + (x & 7)];
+			}
+	}
+};
+
+TEST_F(YuvConverterTest, Golden)
+{
+	constexpr u32 MbWidth = 4;
+	constexpr u32 MbHeight = 3;
+	constexpr u32 Width = MbWidth * 16;
+	constexpr u32 Base = 0x100000;
+
+	TA_YUV_TEX_BASE = Base;
+	TA_YUV_TEX_CTRL.full = 0;
+	TA_YUV_TEX_CTRL.yuv_u_size = MbWidth - 1;
+	TA_YUV_TEX_CTRL.yuv_v_size = MbHeight - 1;
+	YUV_init();
+
+	std::mt19937 gen(4321);
+	std::vector<SQBuffer> data(MbWidth * MbHeight * 384 / sizeof(SQBuffer));
+	u8 *bytes = (u8 *)data.data();
+	for (size_t i = 0; i < data.size() * sizeof(SQBuffer); i++)
+		bytes[i] = (u8)gen();
+
+	std::vector<u8> golden(Width * MbHeight * 16 * 2);
+	for (u32 mb = 0; mb < MbWidth * MbHeight; mb++)
+		convert(bytes + mb * 384, mb % MbWidth, mb / MbWidth, Width, golden);
+
+	// Send the data in uneven chunks to exercise partial macro blocks
+	const u32 chunks[] = { 1, 11, 12, 5, 7 };
+	u32 sent = 0;
+	for (int i = 0; sent < data.size(); i++)
+	{
+		u32 count = std::min<u32>(chunks[i % std::size(chunks)], data.size() - sent);
+		TAWrite(0x800000, &data[sent], count);
+		sent += count;
+	}
+	ASSERT_EQ(0, memcmp(golden.data(), &vram[Base], golden.size()));
+	// The converter is reset after the last macro block
+	ASSERT_EQ(0u, TA_YUV_TEX_CNT);
+}
+
+// The portable row conversion isn't used on hosts with SIMD so test it directly
+TEST_F(YuvConverterTest, ScalarGolden)
+{
+	constexpr u32 MbWidth = 3;
+	constexpr u32 MbHeight = 2;
+	constexpr u32 Width = MbWidth * 16;
+
+	std::mt19937 gen(1234);
+	std::vector<u8> in(MbWidth * MbHeight * 384);
+	for (u8& b : in)
+		b = (u8)gen();
+
+	std::vector<u8> golden(Width * MbHeight * 16 * 2);
+	std::vector<u8> out(golden.size());
+	for (u32 mb = 0; mb < MbWidth * MbHeight; mb++)
+	{
+		const u32 mbx = mb % MbWidth;
+		const u32 mby = mb / MbWidth;
+		convert(&in[mb * 384], mbx, mby, Width, golden);
+		YUV_Block384Scalar(&in[mb * 384], &out[(mby * 16 * Width + mbx * 16) * 2], Width * 2);
+	}
+	ASSERT_EQ(golden, out);
+}
@@ -0,0 +1,71 @@
+#pragma once
+#include "gtest/gtest.h"
+#include "types.h"
+#include "emulator.h"
+#include "hw/mem/addrspace.h"
+#include "hw/sh4/sh4_if.h"
+#include "hw/sh4/sh4_mem.h"
+#include "hw/sh4/sh4_sched.h"
+#include "oslib/oslib.h"
+
+// Runs sh4 code with any cpu engine until a number of cycles has elapsed
+class Sh4CpuTest : public ::testing::Test
+{
+protected:
+	static constexpr u32 ProgramAddress = 0x8C010000;
+
+	static void SetUpTestSuite()
+	{
+		// Needed by the dynarec to invalidate blocks when their page is written to.
+		// Shared by all the test suites: installing it again would chain it to itself.
+		static bool faultHandlerInstalled;
+		if (!faultHandlerInstalled)
+			os_InstallFaultHandler();
+		faultHandlerInstalled = true;
+	}
+
+	void SetUp() override
+	{
+		if (!addrspace::reserve())
+			die("addrspace::reserve failed");
+		emu.init();
+		mem_map_default();
+		dc_reset(true);
+		schedId = sh4_sched_register(0, &stopCpu, &cpu);
+	}
+
+	void TearDown() override
+	{
+		sh4_sched_unregister(schedId);
+	}
+
+	static int stopCpu(int tag, int cycles, int jitter, void *arg)
+	{
+		((sh4_if *)arg)->Stop();
+		return 0;
+	}
+
+	// Selects and resets the cpu engine
+	void resetCpu(void (*getCpu)(sh4_if *))
+	{
+		getCpu(&cpu);
+		cpu.Reset(true);
+	}
+
+	// Runs the cpu from the given address until the cycles have elapsed
+	void runCpu(int cycles, u32 pc = ProgramAddress)
+	{
+		Sh4cntx.pc = pc;
+		sh4_sched_request(schedId, cycles);
+		cpu.Run();
+	}
+
+	void run(void (*getCpu)(sh4_if *), int cycles)
+	{
+		resetCpu(getCpu);
+		runCpu(cycles);
+	}
+
+	sh4_if cpu;
+	int schedId = -1;
+};